@@ -0,0 +1,91 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Benchmark the per-source cost of ScaledApertureFlux with exact Sinc
+coefficients and with coefficients interpolated from the quantized-radius
+cache.
+
+Run as ``python benchmarks/bench_ScaledApertureFlux.py [--sources N]``.
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+import lsst.geom
+import lsst.meas.base
+import lsst.meas.base.tests
+
+
+def makeData(nSources, psfSigma, seed):
+    """Make an exposure and catalog with sources on a regular grid.
+    """
+    nSide = int(np.ceil(np.sqrt(nSources)))
+    spacing = 60
+    bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(spacing*(nSide + 1),
+                                                                       spacing*(nSide + 1)))
+    dataset = lsst.meas.base.tests.TestDataset(bbox, psfSigma=psfSigma)
+    rng = np.random.RandomState(seed)
+    for i in range(nSources):
+        x = spacing*(1 + i % nSide) + rng.uniform(-0.5, 0.5)
+        y = spacing*(1 + i // nSide) + rng.uniform(-0.5, 0.5)
+        dataset.addSource(1E5, lsst.geom.Point2D(x, y))
+    schema = lsst.meas.base.tests.TestDataset.makeMinimalSchema()
+    return dataset, schema
+
+
+def timeMeasure(dataset, schema, radiusStep, seed):
+    """Measure every source, returning the fluxes and the time per source.
+    """
+    ctrl = lsst.meas.base.ScaledApertureFluxControl()
+    ctrl.radiusStep = radiusStep
+    algorithm = lsst.meas.base.ScaledApertureFluxAlgorithm(ctrl, "base_ScaledApertureFlux", schema)
+    exposure, catalog = dataset.realize(10.0, schema, randomSeed=seed)
+    start = time.perf_counter()
+    algorithm.cacheCoefficients(exposure)
+    warm = time.perf_counter() - start
+    start = time.perf_counter()
+    for record in catalog:
+        algorithm.measure(record, exposure)
+    elapsed = time.perf_counter() - start
+    return catalog["base_ScaledApertureFlux_instFlux"], warm, elapsed/len(catalog)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--sources", type=int, default=200, help="Number of sources to measure.")
+    parser.add_argument("--psfSigma", type=float, default=2.0, help="Gaussian PSF sigma (pixels).")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed.")
+    args = parser.parse_args()
+
+    dataset, schema = makeData(args.sources, args.psfSigma, args.seed)
+    exact, _, exactCost = timeMeasure(dataset, schema, 0.0, args.seed)
+    print(f"exact coefficients:      {1E3*exactCost:8.3f} ms/source")
+    for radiusStep in (0.05, 0.2):
+        fluxes, warm, cost = timeMeasure(dataset, schema, radiusStep, args.seed)
+        bias = np.nanmax(np.abs(fluxes/exact - 1.0))
+        print(f"radiusStep={radiusStep:<5}:        {1E3*cost:8.3f} ms/source "
+              f"(x{exactCost/cost:.1f}; {1E3*warm:.1f} ms to pre-warm; max |flux ratio - 1| = {bias:.2e})")
+
+
+if __name__ == "__main__":
+    main()
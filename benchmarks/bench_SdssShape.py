@@ -0,0 +1,115 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Benchmark SdssShape adaptive moments and fixed-moments fluxes for each
+instantiated pixel type, with and without a variance plane, for sources
+small enough that pixels are sub-sampled and for resolved ones.
+
+Run as ``python benchmarks/bench_SdssShape.py [--calls N]``.
+"""
+
+import argparse
+import time
+
+import numpy as np
+
+import lsst.afw.geom
+import lsst.afw.image
+import lsst.geom
+from lsst.meas.base import SdssShapeAlgorithm, SdssShapeControl
+
+DTYPES = {"int": np.int32, "float": np.float32, "double": np.float64}
+"""Pixel types for which SdssShape is instantiated, and their numpy types."""
+
+
+def makeStamp(sigma, size, flux, noise, seed):
+    """Make an image of a circular Gaussian source with Gaussian noise.
+
+    Returns
+    -------
+    array : `numpy.ndarray`
+        Pixel values.
+    center : `lsst.geom.Point2D`
+        Position of the source.
+    """
+    rng = np.random.RandomState(seed)
+    center = lsst.geom.Point2D(0.5*size + rng.uniform(-0.5, 0.5), 0.5*size + rng.uniform(-0.5, 0.5))
+    y, x = np.mgrid[:size, :size]
+    r2 = (x - center.getX())**2 + (y - center.getY())**2
+    array = flux/(2*np.pi*sigma**2)*np.exp(-0.5*r2/sigma**2) + rng.normal(0.0, noise, (size, size))
+    return array, center
+
+
+def makeImages(array, noise):
+    """Make an Image and a MaskedImage of each pixel type from an array.
+    """
+    images = {}
+    for name, dtype in DTYPES.items():
+        image = lsst.afw.image.Image(np.round(array).astype(dtype) if dtype is np.int32
+                                     else array.astype(dtype))
+        maskedImage = lsst.afw.image.MaskedImage(image)
+        maskedImage.variance.array[:, :] = noise**2
+        images[f"Image<{name}>"] = image
+        images[f"MaskedImage<{name}>"] = maskedImage
+    return images
+
+
+def timeCalls(func, nCalls):
+    """Return the mean time per call of a function, in seconds.
+    """
+    func()
+    start = time.perf_counter()
+    for _ in range(nCalls):
+        func()
+    return (time.perf_counter() - start)/nCalls
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--calls", type=int, default=2000, help="Number of calls to time for each case.")
+    parser.add_argument("--size", type=int, default=41, help="Width and height of the stamp (pixels).")
+    parser.add_argument("--sigmas", type=float, nargs="+", default=[0.4, 2.0, 5.0],
+                        help="Gaussian sigmas of the sources (pixels); below 0.5, pixels are sub-sampled.")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed.")
+    args = parser.parse_args()
+
+    flux = 1E5
+    noise = 5.0
+    ctrl = SdssShapeControl()
+    print(f"{'image type':<22}{'sigma':>6}{'adaptive (us)':>16}{'fixed (us)':>14}{'xx':>10}")
+    for sigma in args.sigmas:
+        array, center = makeStamp(sigma, args.size, flux, noise, args.seed)
+        shape = lsst.afw.geom.Quadrupole(sigma**2, sigma**2, 0.0)
+        for name, image in makeImages(array, noise).items():
+            def measureAdaptive():
+                return SdssShapeAlgorithm.computeAdaptiveMoments(image, center, False, ctrl)
+
+            def measureFixed():
+                return SdssShapeAlgorithm.computeFixedMomentsFlux(image, shape, center)
+
+            result = measureAdaptive()
+            adaptive = timeCalls(measureAdaptive, args.calls)
+            fixed = timeCalls(measureFixed, args.calls)
+            print(f"{name:<22}{sigma:>6.2f}{1E6*adaptive:>16.2f}{1E6*fixed:>14.2f}{result.xx:>10.3f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,229 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Benchmark DiaObjectCalculationTask on synthetic DiaObject and DiaSource
+tables.
+
+The tables mimic alert production: the number of epochs per DiaObject has a
+long-tailed (geometric) distribution, each DiaSource is observed in one of
+several bands, and a fraction of the fluxes and flux errors are NaN.  The
+full task is timed over several repeats, together with the time spent in
+each plugin; the peak memory traced during a separate run, and the process
+high-water mark, are also reported.
+
+Run as ``python benchmarks/bench_diaCalculation.py [--objects N] [--json FILE]``.
+"""
+
+import argparse
+import functools
+import json
+import time
+import tracemalloc
+
+import numpy as np
+import pandas as pd
+
+import lsst.meas.base
+from lsst.meas.base import DiaObjectCalculationPlugin, DiaObjectCalculationTask, getMaxResidentBytes
+
+
+def makeCatalogs(nObjects, meanEpochs, bands, nanFraction, seed):
+    """Make DiaObject and DiaSource tables indexed as
+    `DiaObjectCalculationTask.run` requires.
+
+    Parameters
+    ----------
+    nObjects : `int`
+        Number of DiaObjects.
+    meanEpochs : `float`
+        Mean number of DiaSources per DiaObject (at least one each).
+    bands : `str`
+        Bands the DiaSources are observed in, one character per band.
+    nanFraction : `float`
+        Fraction of fluxes, and independently of flux errors, set to NaN.
+    seed : `int`
+        Random seed.
+
+    Returns
+    -------
+    diaObjects : `pandas.DataFrame`
+        DiaObjects, indexed on ``diaObjectId``.
+    diaSources : `pandas.DataFrame`
+        DiaSources, indexed on ``(diaObjectId, band, diaSourceId)``.
+    """
+    rng = np.random.default_rng(seed)
+    nEpochs = rng.geometric(1.0/meanEpochs, size=nObjects)
+    nSources = nEpochs.sum()
+    diaObjectIds = np.arange(1, nObjects + 1, dtype=np.int64)
+    sourceObjectIds = np.repeat(diaObjectIds, nEpochs)
+
+    # Objects are scattered over a one-degree field, and each has a mean flux
+    # drawn from a power law and a sinusoidal light curve.
+    ra = rng.uniform(10.0, 11.0, nObjects)
+    dec = rng.uniform(-5.5, -4.5, nObjects)
+    meanFlux = 1E3*(1.0 - rng.uniform(size=nObjects))**(-1.0/1.5)
+    amplitude = meanFlux*rng.uniform(0.0, 0.5, nObjects)
+    period = rng.uniform(0.1, 100.0, nObjects)
+    times = rng.uniform(60000.0, 60000.0 + 3*365.25, nSources)
+    objectIndex = np.repeat(np.arange(nObjects), nEpochs)
+    trueFlux = meanFlux[objectIndex] + amplitude[objectIndex]*np.sin(2*np.pi*times/period[objectIndex])
+    fluxErr = 0.02*meanFlux[objectIndex] + 10.0
+    psfFlux = trueFlux + fluxErr*rng.standard_normal(nSources)
+    scienceFlux = psfFlux + 5E3
+    scienceFluxErr = np.hypot(fluxErr, np.sqrt(5E3))
+    for column in (psfFlux, fluxErr, scienceFlux):
+        column[rng.uniform(size=nSources) < nanFraction] = np.nan
+
+    bandWeights = np.linspace(1.0, 2.0, len(bands))
+    diaSources = pd.DataFrame({
+        "diaObjectId": sourceObjectIds,
+        "band": rng.choice(list(bands), size=nSources, p=bandWeights/bandWeights.sum()),
+        "diaSourceId": np.arange(1, nSources + 1, dtype=np.int64),
+        "ra": ra[objectIndex] + rng.normal(0.0, 2E-5, nSources),
+        "dec": dec[objectIndex] + rng.normal(0.0, 2E-5, nSources),
+        "midpointMjdTai": times,
+        "psfFlux": psfFlux,
+        "psfFluxErr": fluxErr,
+        "scienceFlux": scienceFlux,
+        "scienceFluxErr": scienceFluxErr,
+        "flags": (rng.uniform(size=nSources) < 0.01).astype(np.uint64),
+    })
+    diaSources.sort_values(["diaObjectId", "band", "diaSourceId"], inplace=True)
+    diaSources.set_index(["diaObjectId", "band", "diaSourceId"], inplace=True, drop=False)
+
+    diaObjects = pd.DataFrame({
+        "diaObjectId": diaObjectIds,
+        "ra": ra,
+        "dec": dec,
+        "nDiaSources": np.zeros(nObjects, dtype=np.int64),
+        "flags": np.zeros(nObjects, dtype=np.uint64),
+    })
+    diaObjects.set_index("diaObjectId", inplace=True, drop=False)
+    return diaObjects, diaSources
+
+
+def makeTask(plugins):
+    """Make a task running the given plugins, each of which records the time
+    spent in it.
+
+    Returns
+    -------
+    task : `DiaObjectCalculationTask`
+        The task.
+    pluginTimes : `dict` [`str`, `float`]
+        Seconds spent in each plugin, accumulated over calls to the task.
+    """
+    config = DiaObjectCalculationTask.ConfigClass()
+    config.plugins = plugins
+    task = DiaObjectCalculationTask(config=config)
+    pluginTimes = {name: 0.0 for name in task.plugins}
+
+    def timed(name, calculate):
+        @functools.wraps(calculate)
+        def wrapper(*args, **kwargs):
+            start = time.perf_counter()
+            try:
+                return calculate(*args, **kwargs)
+            finally:
+                pluginTimes[name] += time.perf_counter() - start
+        return wrapper
+
+    for name, plugin in task.plugins.items():
+        plugin.calculate = timed(name, plugin.calculate)
+    return task, pluginTimes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument("--objects", type=int, default=5000, help="Number of DiaObjects.")
+    parser.add_argument("--epochs", type=float, default=20.0, help="Mean number of DiaSources per DiaObject.")
+    parser.add_argument("--bands", default="ugrizy", help="Bands, one character each.")
+    parser.add_argument("--nanFraction", type=float, default=0.05,
+                        help="Fraction of fluxes and flux errors that are NaN.")
+    parser.add_argument("--plugins", nargs="+", default=None,
+                        help="Plugins to run; default is all registered DiaObject plugins.")
+    parser.add_argument("--columnar", action="store_true",
+                        help="Time runColumnar, on unindexed tables, instead of run.")
+    parser.add_argument("--repeat", type=int, default=3, help="Number of timed runs; the best is reported.")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed.")
+    parser.add_argument("--json", default=None, help="File to write the results to, for comparing runs.")
+    args = parser.parse_args()
+
+    plugins = args.plugins
+    if plugins is None:
+        plugins = sorted(DiaObjectCalculationPlugin.registry.keys())
+    bands = list(args.bands)
+    diaObjects, diaSources = makeCatalogs(args.objects, args.epochs, args.bands, args.nanFraction, args.seed)
+    print(f"{len(diaObjects)} DiaObjects, {len(diaSources)} DiaSources in {len(bands)} bands; "
+          f"{len(plugins)} plugins")
+
+    task, pluginTimes = makeTask(plugins)
+    updatedIds = diaObjects["diaObjectId"].to_numpy()
+    if args.columnar:
+        diaObjects = diaObjects.reset_index(drop=True)
+        diaSources = diaSources.reset_index(drop=True)
+        run = task.runColumnar
+    else:
+        run = task.run
+    best = None
+    for _ in range(args.repeat):
+        for name in pluginTimes:
+            pluginTimes[name] = 0.0
+        objects = diaObjects.copy()
+        start = time.perf_counter()
+        run(objects, diaSources, updatedIds, bands)
+        elapsed = time.perf_counter() - start
+        if best is None or elapsed < best[0]:
+            best = (elapsed, dict(pluginTimes))
+    elapsed, bestPluginTimes = best
+
+    # Trace memory in a separate run, as tracing slows allocation.
+    tracemalloc.start()
+    run(diaObjects.copy(), diaSources, updatedIds, bands)
+    _, peakTraced = tracemalloc.get_traced_memory()
+    tracemalloc.stop()
+
+    print(f"{'plugin':<36}{'seconds':>10}{'share':>8}{'objects/s':>14}")
+    for name, seconds in sorted(bestPluginTimes.items(), key=lambda item: -item[1]):
+        rate = len(diaObjects)/seconds if seconds > 0 else np.inf
+        print(f"{name:<36}{seconds:>10.4f}{seconds/elapsed:>8.1%}{rate:>14.0f}")
+    print(f"{'full task':<36}{elapsed:>10.4f}{1.0:>8.1%}{len(diaObjects)/elapsed:>14.0f}")
+    print(f"peak traced memory during run: {peakTraced/2**20:.1f} MiB; "
+          f"process high-water mark: {getMaxResidentBytes()/2**20:.1f} MiB")
+
+    if args.json:
+        results = {
+            "version": getattr(lsst.meas.base, "__version__", None),
+            "arguments": vars(args),
+            "nDiaObjects": len(diaObjects),
+            "nDiaSources": len(diaSources),
+            "taskSeconds": elapsed,
+            "objectsPerSecond": len(diaObjects)/elapsed,
+            "pluginSeconds": bestPluginTimes,
+            "peakTracedBytes": peakTraced,
+            "maxResidentBytes": getMaxResidentBytes(),
+        }
+        with open(args.json, "w") as stream:
+            json.dump(results, stream, indent=2)
+
+
+if __name__ == "__main__":
+    main()
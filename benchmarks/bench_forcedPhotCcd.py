@@ -0,0 +1,284 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Benchmark the stages of ForcedPhotCcdTask for each reference catalog
+storage class, with synthetic reference catalogs read from local files.
+
+Reference objects are scattered uniformly over a grid of square "patches"
+centred on a synthetic exposure, and each patch is written both as Parquet
+(for the ``DataFrame`` and ``ArrowAstropy`` storage classes) and as a FITS
+``SourceCatalog``.  In-memory stand-ins for butler handles read the files
+(with column selection, as the butler does for Parquet) each time they are
+used, so that reading is included in the reference filtering time.  The
+stages timed separately are:
+
+``prep``
+    Reading and merging the reference catalogs and selecting the objects
+    that overlap the exposure.
+``generateMeasCat``
+    Creating the measurement catalog.
+``attachFootprints``
+    Attaching PSF-shaped footprints.
+``run``
+    Measurement, aperture correction and catalog calculation.
+
+Run as ``python benchmarks/bench_forcedPhotCcd.py [--rows N] [--patches N]``.
+"""
+
+import argparse
+import json
+import math
+import os
+import tempfile
+import time
+
+import astropy.table
+import numpy as np
+import pyarrow.parquet
+
+import lsst.afw.image
+import lsst.afw.table
+import lsst.geom
+from lsst.afw.math import ChebyshevBoundedField
+from lsst.meas.base import ForcedPhotCcdTask, getMaxResidentBytes
+from lsst.meas.base.tests import TestDataset
+
+STORAGE_CLASSES = ("SourceCatalog", "DataFrame", "ArrowAstropy")
+"""Reference catalog storage classes that can be benchmarked."""
+
+EXTRA_COLUMNS = 20
+"""Number of additional float columns in each Parquet reference catalog,
+which are not read."""
+
+
+class FileHandle:
+    """A stand-in for `lsst.daf.butler.DeferredDatasetHandle` that reads a
+    reference catalog from a local file on every `get`.
+
+    Parameters
+    ----------
+    path : `str`
+        File to read.
+    storageClass : `str`
+        Storage class to read the file as.
+    dataId : `dict`
+        Data ID reported for the dataset.
+    idColumn : `str`
+        Column that is the index of a ``DataFrame``.
+    """
+
+    def __init__(self, path, storageClass, dataId, idColumn):
+        self.path = path
+        self.storageClass = storageClass
+        self.dataId = dataId
+        self.idColumn = idColumn
+
+    def get(self, parameters=None):
+        columns = parameters.get("columns") if parameters else None
+        if self.storageClass == "SourceCatalog":
+            return lsst.afw.table.SourceCatalog.readFits(self.path)
+        table = pyarrow.parquet.read_table(self.path, columns=columns)
+        if self.storageClass == "DataFrame":
+            # The ID is the index of DataFrame reference catalogs.
+            return table.to_pandas().set_index(self.idColumn)
+        return astropy.table.Table({name: table.column(name).to_numpy() for name in table.column_names})
+
+
+def makeExposure(size, psfSigma, seed):
+    """Make an exposure of noise with a PSF, WCS, calibration and aperture
+    corrections.
+    """
+    bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(size, size))
+    dataset = TestDataset(bbox, psfSigma=psfSigma,
+                          crval=lsst.geom.SpherePoint(45.0, -30.0, lsst.geom.degrees))
+    exposure, _ = dataset.realize(10.0, dataset.makeMinimalSchema(), randomSeed=seed)
+    apCorrMap = lsst.afw.image.ApCorrMap()
+    apCorrMap["base_PsfFlux_instFlux"] = ChebyshevBoundedField(bbox, np.array([[1.0]]))
+    apCorrMap["base_PsfFlux_instFluxErr"] = ChebyshevBoundedField(bbox, np.array([[0.0]]))
+    exposure.info.setApCorrMap(apCorrMap)
+    return exposure
+
+
+def writeReferenceCatalogs(directory, exposure, nPatches, rowsPerPatch, patchScale, seed):
+    """Write synthetic reference catalogs, one per patch, in Parquet and FITS.
+
+    Parameters
+    ----------
+    directory : `str`
+        Directory to write to.
+    exposure : `lsst.afw.image.Exposure`
+        Exposure the patches are centred on.
+    nPatches : `int`
+        Number of patches; they are arranged in a square grid, rounded up.
+    rowsPerPatch : `int`
+        Number of reference objects in each patch.
+    patchScale : `float`
+        Width of a patch, in units of the exposure width.
+    seed : `int`
+        Random seed.
+
+    Returns
+    -------
+    paths : `list` [`tuple` [`str`, `str`]]
+        Parquet and FITS file of each patch.
+    """
+    rng = np.random.default_rng(seed)
+    wcs = exposure.getWcs()
+    center = wcs.pixelToSky(lsst.geom.Box2D(exposure.getBBox()).getCenter())
+    width = patchScale*exposure.getWidth()*wcs.getPixelScale().asDegrees()
+    nSide = math.ceil(math.sqrt(nPatches))
+    schema = TestDataset.makeMinimalSchema()
+    paths = []
+    for patch in range(nPatches):
+        # Offsets on the tangent plane, so patches are square on the sky.
+        u = width*(patch % nSide - 0.5*(nSide - 1) + rng.uniform(-0.5, 0.5, rowsPerPatch))
+        v = width*(patch // nSide - 0.5*(nSide - 1) + rng.uniform(-0.5, 0.5, rowsPerPatch))
+        dec = center.getDec().asDegrees() + v
+        ra = center.getRa().asDegrees() + u/np.cos(np.deg2rad(dec))
+        ids = patch*rowsPerPatch + np.arange(1, rowsPerPatch + 1, dtype=np.int64)
+
+        columns = {"diaObjectId": ids, "ra": ra, "dec": dec}
+        for i in range(EXTRA_COLUMNS):
+            columns[f"extra{i:02d}"] = rng.normal(size=rowsPerPatch)
+        parquetPath = os.path.join(directory, f"refCat_{patch}.parq")
+        pyarrow.parquet.write_table(pyarrow.table(columns), parquetPath)
+
+        catalog = lsst.afw.table.SourceCatalog(schema)
+        catalog.resize(rowsPerPatch)
+        catalog["id"] = ids
+        catalog["coord_ra"] = np.deg2rad(ra)
+        catalog["coord_dec"] = np.deg2rad(dec)
+        x, y = wcs.skyToPixelArray(ra, dec, degrees=True)
+        catalog["truth_x"] = x
+        catalog["truth_y"] = y
+        fitsPath = os.path.join(directory, f"refCat_{patch}.fits")
+        catalog.writeFits(fitsPath)
+        paths.append((parquetPath, fitsPath))
+    return paths
+
+
+def makeTask(storageClass, batchThreads):
+    """Make a forced photometry task for a reference catalog storage class.
+    """
+    config = ForcedPhotCcdTask.ConfigClass()
+    if storageClass == "SourceCatalog":
+        refSchema = TestDataset.makeMinimalSchema()
+        # The synthetic catalogs have no footprints to transform, and no
+        # deblender outputs to copy.
+        config.footprintSource = "psf"
+        config.measurement.copyColumns.pop("deblend_nChild", None)
+    else:
+        refSchema = None
+        config.configureParquetRefCat(storageClass)
+    if batchThreads is not None:
+        config.configureBatchPsfFlux(nThreads=batchThreads)
+    return ForcedPhotCcdTask(refSchema=refSchema, config=config)
+
+
+def benchmark(storageClass, exposure, paths, batchThreads, skipMeasurement):
+    """Time each stage of forced photometry for one storage class.
+
+    Returns
+    -------
+    times : `dict` [`str`, `float`]
+        Seconds taken by each stage.
+    nRefs : `int`
+        Number of reference objects overlapping the exposure.
+    """
+    task = makeTask(storageClass, batchThreads)
+    handles = [FileHandle(fitsPath if storageClass == "SourceCatalog" else parquetPath, storageClass,
+                          {"patch": patch}, task.config.refCatIdColumn)
+               for patch, (parquetPath, fitsPath) in enumerate(paths)]
+    prepFunc = {
+        "SourceCatalog": task._prepSourceCatalogRefCat,
+        "DataFrame": task._prepDataFrameRefCat,
+        "ArrowAstropy": task._prepArrowAstropyRefCat,
+    }[storageClass]
+    refWcs = exposure.getWcs()
+    times = {}
+
+    start = time.perf_counter()
+    refCat = prepFunc(handles, exposure.getBBox(), exposure.getWcs())
+    times["prep"] = time.perf_counter() - start
+
+    start = time.perf_counter()
+    measCat = task.measurement.generateMeasCat(exposure, refCat, refWcs)
+    times["generateMeasCat"] = time.perf_counter() - start
+
+    start = time.perf_counter()
+    task.attachFootprints(measCat, refCat, exposure, refWcs)
+    times["attachFootprints"] = time.perf_counter() - start
+
+    if not skipMeasurement:
+        start = time.perf_counter()
+        task.run(measCat, exposure, refCat, refWcs)
+        times["run"] = time.perf_counter() - start
+    return times, len(refCat)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+    parser.add_argument("--rows", type=int, default=250000, help="Reference objects per patch.")
+    parser.add_argument("--patches", type=int, default=4, help="Number of patches.")
+    parser.add_argument("--patchScale", type=float, default=4.0,
+                        help="Width of a patch in units of the exposure width.")
+    parser.add_argument("--size", type=int, default=2048, help="Width and height of the exposure (pixels).")
+    parser.add_argument("--psfSigma", type=float, default=2.0, help="Gaussian PSF sigma (pixels).")
+    parser.add_argument("--storageClasses", nargs="+", default=list(STORAGE_CLASSES),
+                        choices=STORAGE_CLASSES, help="Storage classes to benchmark.")
+    parser.add_argument("--batchPsfFlux", type=int, default=None, metavar="THREADS",
+                        help="Measure PSF fluxes in batch mode with this many threads.")
+    parser.add_argument("--skipMeasurement", action="store_true", help="Do not time measurement.")
+    parser.add_argument("--directory", default=None,
+                        help="Directory to write the reference catalogs to; default is a temporary one.")
+    parser.add_argument("--seed", type=int, default=1, help="Random seed.")
+    parser.add_argument("--json", default=None, help="File to write the results to, for comparing runs.")
+    args = parser.parse_args()
+
+    exposure = makeExposure(args.size, args.psfSigma, args.seed)
+    with tempfile.TemporaryDirectory() as tempDirectory:
+        directory = args.directory if args.directory is not None else tempDirectory
+        os.makedirs(directory, exist_ok=True)
+        start = time.perf_counter()
+        paths = writeReferenceCatalogs(directory, exposure, args.patches, args.rows, args.patchScale,
+                                       args.seed)
+        print(f"Wrote {args.patches} patches of {args.rows} reference objects in "
+              f"{time.perf_counter() - start:.1f} s")
+
+        stages = ["prep", "generateMeasCat", "attachFootprints"] + ([] if args.skipMeasurement else ["run"])
+        print(f"{'storage class':<16}{'refs':>8}" + "".join(f"{stage:>18}" for stage in stages)
+              + f"{'total':>10}")
+        results = {}
+        for storageClass in args.storageClasses:
+            times, nRefs = benchmark(storageClass, exposure, paths, args.batchPsfFlux, args.skipMeasurement)
+            results[storageClass] = {"nRefs": nRefs, "seconds": times}
+            print(f"{storageClass:<16}{nRefs:>8}" + "".join(f"{times[stage]:>18.3f}" for stage in stages)
+                  + f"{sum(times.values()):>10.3f}")
+    print(f"process high-water mark: {getMaxResidentBytes()/2**20:.1f} MiB")
+
+    if args.json:
+        with open(args.json, "w") as stream:
+            json.dump({"arguments": vars(args), "results": results,
+                       "maxResidentBytes": getMaxResidentBytes()}, stream, indent=2)
+
+
+if __name__ == "__main__":
+    main()
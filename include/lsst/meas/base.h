@@ -30,6 +30,7 @@
 #include "lsst/meas/base/ShapeUtilities.h"
 #include "lsst/meas/base/FlagHandler.h"
 #include "lsst/meas/base/InputUtilities.h"
+#include "lsst/meas/base/ParallelUtilities.h"
 #include "lsst/meas/base/Algorithm.h"
 #include "lsst/meas/base/PsfFlux.h"
 #include "lsst/meas/base/SdssCentroid.h"
@@ -42,6 +43,11 @@
 #include "lsst/meas/base/ScaledApertureFlux.h"
 #include "lsst/meas/base/CircularApertureFlux.h"
 #include "lsst/meas/base/Blendedness.h"
+#include "lsst/meas/base/GridInterpolatedPsf.h"
+#include "lsst/meas/base/FootprintUtilities.h"
+#include "lsst/meas/base/FootprintIndex.h"
+#include "lsst/meas/base/HtmUtilities.h"
+#include "lsst/meas/base/SegmentStatistics.h"
 
 // These are necessary to build Swig modules that %import meas/base/baseLib.i,
 // so it's neighborly to include them here so downstream code can just
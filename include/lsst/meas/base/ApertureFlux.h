@@ -113,6 +113,21 @@ public:
                                   Control const& ctrl = Control());
     //@}
 
+    /**  Compute the instFlux and uncertainty within an aperture using precomputed Sinc coefficients
+     *
+     *   As computeSincFlux(), but with coefficients supplied by the caller (e.g. from
+     *   SincCoeffs::getInterpolated) instead of looked up for the ellipse.
+     *
+     *   @param[in]   image                 MaskedImage to be measured.
+     *   @param[in]   ellipse               Ellipse that defines the outer boundary of the aperture.
+     *   @param[in]   coeffs                Sinc coefficients of the aperture, centered on (0, 0).
+     *   @param[in]   ctrl                  Control object.
+     */
+    template <typename T>
+    static Result computeSincFlux(afw::image::MaskedImage<T> const& image,
+                                  afw::geom::ellipses::Ellipse const& ellipse,
+                                  afw::image::Image<T> const& coeffs, Control const& ctrl = Control());
+
     //@{
     /**  Compute the instFlux (and optionally, uncertanties) within an aperture using naive photometry
      *
@@ -117,12 +117,33 @@ public:
     void measureParentPixels(afw::image::MaskedImage<float> const& image,
                              afw::table::SourceRecord& child) const;
 
+    /**
+     *  Measure the parent-pixel quantities of every record in a catalog, as measureParentPixels would.
+     *
+     *  Records are grouped into families by their parent ID, and each family's tile (the union of the
+     *  Gaussian weight regions of its members) is scanned once, accumulating the weighted sums of all
+     *  members together; each pixel's noise-bias correction is then computed once rather than once per
+     *  overlapping source.  Families are distributed over nThreads threads.
+     *
+     *  @param[in]     image     Image with all sources present (not noise-replaced).
+     *  @param[in,out] catalog   Records to measure; their child-pixel quantities must already be set.
+     *  @param[in]     nThreads  Number of threads to use; zero or negative for one per hardware thread.
+     */
+    void measureCatalogParentPixels(afw::image::MaskedImage<float> const& image,
+                                    afw::table::SourceCatalog const& catalog, int nThreads = 1) const;
+
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const {}
 
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const {}
 
 private:
+    // Check that a record's centroid and shape are usable, setting flags if not.
+    bool _checkMomentInputs(afw::table::SourceRecord& child) const;
+
+    // Set the child/parent flux ratios from the measured fluxes.
+    void _setParentRatios(afw::table::SourceRecord& child) const;
+
     void _measureMoments(afw::image::MaskedImage<float> const& image, afw::table::SourceRecord& child,
                          afw::table::Key<double> const& instFluxRawKey,
                          afw::table::Key<double> const& instFluxAbsKey, ShapeResultKey const& _shapeRawKey,
@@ -0,0 +1,162 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MEAS_BASE_FootprintIndex_h_INCLUDED
+#define LSST_MEAS_BASE_FootprintIndex_h_INCLUDED
+
+#include <cstdint>
+#include <vector>
+
+#include "ndarray.h"
+#include "lsst/geom/Box.h"
+#include "lsst/afw/table/Source.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  A static spatial index of the bounding boxes of a catalog's Footprints, for finding which
+ *  sources overlap a region.
+ *
+ *  The index is a bounding-box R-tree built once, bottom-up, by Sort-Tile-Recursive packing: boxes
+ *  are sorted into vertical slabs by the x coordinates of their centers, each slab is sorted by y,
+ *  and consecutive runs of boxes become the leaves; the same is done to the leaves to form the next
+ *  level, and so on up to a single root.  Every node except the last on each level is full, so a
+ *  query visits O(log n) nodes plus those that actually overlap the query region.
+ *
+ *  Indexed items are identified by their position in the catalog (or box list) the index was built
+ *  from.  Records with no Footprint, and empty boxes, are not indexed and never returned.  Overlap
+ *  tests are of bounding boxes only, and are inclusive, as for geom::Box2I::overlaps.
+ */
+class FootprintIndex {
+public:
+    /// Default maximum number of children of each node.
+    static constexpr int DEFAULT_NODE_CAPACITY = 16;
+
+    /**
+     *  Index the Footprint bounding boxes of a catalog.
+     *
+     *  @param[in] catalog       Catalog of sources; need not be contiguous.
+     *  @param[in] nodeCapacity  Maximum number of children of each node; at least 2.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if nodeCapacity is less than 2.
+     */
+    explicit FootprintIndex(afw::table::SourceCatalog const& catalog,
+                            int nodeCapacity = DEFAULT_NODE_CAPACITY);
+
+    /**
+     *  Index a list of boxes.
+     *
+     *  @param[in] boxes         Boxes to index, identified by their positions in the list.
+     *  @param[in] nodeCapacity  Maximum number of children of each node; at least 2.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if nodeCapacity is less than 2.
+     */
+    explicit FootprintIndex(std::vector<geom::Box2I> const& boxes,
+                            int nodeCapacity = DEFAULT_NODE_CAPACITY);
+
+    FootprintIndex(FootprintIndex const&) = default;
+    FootprintIndex(FootprintIndex&&) = default;
+    FootprintIndex& operator=(FootprintIndex const&) = default;
+    FootprintIndex& operator=(FootprintIndex&&) = default;
+    ~FootprintIndex() = default;
+
+    /// Return the number of boxes indexed (excluding records with no Footprint and empty boxes).
+    std::size_t size() const { return _entries.size(); }
+
+    /// Return the number of records or boxes the index was built from.
+    std::size_t getInputSize() const { return _bboxes.size(); }
+
+    /// Return the bounding box of item i, which is empty if it is not indexed.
+    geom::Box2I getBBox(std::size_t i) const;
+
+    /// Return the bounding box of all indexed items.
+    geom::Box2I getBBox() const;
+
+    /// Return the number of levels in the tree (zero if nothing is indexed).
+    int getDepth() const { return static_cast<int>(_levels.size()); }
+
+    /**
+     *  Find the items whose bounding boxes overlap a region.
+     *
+     *  @param[in] region  Region to search, in parent pixel coordinates.
+     *
+     *  @return Positions of the overlapping items, in ascending order.
+     */
+    ndarray::Array<std::int64_t, 1, 1> query(geom::Box2I const& region) const;
+
+    /**
+     *  Find the other items whose bounding boxes overlap that of an item.
+     *
+     *  @param[in] i  Position of the item.
+     *
+     *  @return Positions of the overlapping items other than i, in ascending order; empty if i is not
+     *          indexed.
+     *
+     *  @throws pex::exceptions::OutOfRangeError if i is not less than getInputSize().
+     */
+    ndarray::Array<std::int64_t, 1, 1> queryNeighbors(std::size_t i) const;
+
+    /**
+     *  Partition the indexed items into groups connected by overlaps.
+     *
+     *  Two items are in the same group if there is a chain of items from one to the other in which
+     *  each overlaps the next, so items (or deblend families, if the index was built from parents)
+     *  in different groups can be processed independently.
+     *
+     *  @return Group label of each item, numbered from zero in order of each group's first item;
+     *          -1 for items that are not indexed.
+     */
+    ndarray::Array<std::int64_t, 1, 1> computeOverlapGroups() const;
+
+private:
+    struct Node {
+        geom::Box2I bbox;
+        std::size_t begin;  // first child, in _entries for leaves or in the level below otherwise
+        std::size_t end;
+    };
+
+    struct Entry {
+        geom::Box2I bbox;
+        std::size_t index;
+    };
+
+    // Pack the entries and build the levels of the tree.
+    void _build(std::size_t nodeCapacity);
+
+    // Call func(index) for each entry whose box overlaps region.
+    template <typename Function>
+    void _visit(geom::Box2I const& region, Function&& func) const;
+
+    std::vector<geom::Box2I> _bboxes;        // by input position; empty if not indexed
+    std::vector<Entry> _entries;             // in packed leaf order
+    std::vector<std::vector<Node>> _levels;  // leaves first, root level last
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_FootprintIndex_h_INCLUDED
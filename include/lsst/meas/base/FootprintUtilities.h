@@ -0,0 +1,51 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_FootprintUtilities_h_INCLUDED
+#define LSST_MEAS_BASE_FootprintUtilities_h_INCLUDED
+
+#include <cstdint>
+
+#include "ndarray.h"
+#include "lsst/afw/table/Source.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Return the number of pixels in the Footprint of every record in a catalog.
+ *
+ *  @param[in] catalog  Catalog of sources; need not be contiguous.
+ *
+ *  @return Array of Footprint areas, in catalog order; zero for records with no Footprint.
+ */
+ndarray::Array<std::int32_t, 1, 1> computeFootprintAreas(afw::table::SourceCatalog const& catalog);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_FootprintUtilities_h_INCLUDED
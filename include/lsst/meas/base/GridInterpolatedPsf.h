@@ -0,0 +1,160 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MEAS_BASE_GridInterpolatedPsf_h_INCLUDED
+#define LSST_MEAS_BASE_GridInterpolatedPsf_h_INCLUDED
+
+#include <memory>
+#include <vector>
+
+#include "lsst/pex/config.h"
+#include "lsst/geom/Box.h"
+#include "lsst/afw/detection/Psf.h"
+#include "lsst/afw/geom/ellipses/Quadrupole.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+class GridInterpolatedPsfControl {
+public:
+    LSST_CONTROL_FIELD(gridSpacing, int,
+                       "Approximate spacing (in pixels) between grid nodes at which the PSF is evaluated");
+
+    LSST_CONTROL_FIELD(nCheckPoints, int,
+                       "Number of random positions at which the interpolated PSF is compared to the "
+                       "exact PSF; must be at least 1");
+
+    LSST_CONTROL_FIELD(seed, int, "Seed for the random number generator that picks the check points");
+
+    LSST_CONTROL_FIELD(maxRelativeError, double,
+                       "Largest acceptable interpolation error, relative to the peak of the kernel image "
+                       "(or to the determinant radius for shapes); the exact PSF is used if this is "
+                       "exceeded");
+
+    GridInterpolatedPsfControl() : gridSpacing(256), nCheckPoints(16), seed(1), maxRelativeError(1E-3) {}
+};
+
+/**
+ *  A Psf that approximates another Psf by bilinear interpolation between kernel images and second
+ *  moments evaluated on a regular grid of positions.
+ *
+ *  The grid is built once, at construction, over the given bounding box (typically that of the
+ *  exposure being measured).  The interpolation is then checked against exact evaluations of the
+ *  wrapped Psf at random positions within the box, and the largest errors seen are available via
+ *  getMaxKernelError() and getMaxShapeError().  Callers should compare these to
+ *  GridInterpolatedPsfControl::maxRelativeError (see isAccurate()) before substituting this Psf for
+ *  the original.
+ *
+ *  Aperture fluxes, and evaluations at a specific (non-indeterminate) color, are always delegated to
+ *  the wrapped Psf.
+ */
+class GridInterpolatedPsf : public afw::detection::Psf {
+public:
+    typedef GridInterpolatedPsfControl Control;
+
+    /**
+     *  Evaluate the given Psf on a grid covering bbox, and check the interpolation error.
+     *
+     *  @param[in] psf    The exact Psf to approximate.
+     *  @param[in] bbox   Region (in parent pixel coordinates) over which the approximation is valid;
+     *                    positions outside it are clamped to the nearest grid edge.
+     *  @param[in] ctrl   Control object setting the grid spacing and verification parameters.
+     *
+     *  @throws pex::exceptions::InvalidParameterError if bbox is empty, or ctrl.gridSpacing or
+     *          ctrl.nCheckPoints is not positive.
+     */
+    GridInterpolatedPsf(std::shared_ptr<afw::detection::Psf const> psf, geom::Box2I const& bbox,
+                        Control const& ctrl = Control());
+
+    GridInterpolatedPsf(GridInterpolatedPsf const&) = default;
+    GridInterpolatedPsf(GridInterpolatedPsf&&) = default;
+    GridInterpolatedPsf& operator=(GridInterpolatedPsf const&) = delete;
+    GridInterpolatedPsf& operator=(GridInterpolatedPsf&&) = delete;
+    ~GridInterpolatedPsf() override = default;
+
+    std::shared_ptr<afw::detection::Psf> clone() const override;
+
+    std::shared_ptr<afw::detection::Psf> resized(int width, int height) const override;
+
+    geom::Point2D getAveragePosition() const override { return _psf->getAveragePosition(); }
+
+    /// Return the Psf being approximated.
+    std::shared_ptr<afw::detection::Psf const> getExactPsf() const { return _psf; }
+
+    /// Return the region over which the grid was built.
+    geom::Box2I getGridBBox() const { return _bbox; }
+
+    /// Return the number of grid nodes along x and y.
+    int getNx() const { return _nx; }
+    int getNy() const { return _ny; }
+
+    /// Largest kernel-image error at the check points, relative to the peak of the exact kernel image.
+    double getMaxKernelError() const { return _maxKernelError; }
+
+    /// Largest relative error in the determinant radius of the PSF moments at the check points.
+    double getMaxShapeError() const { return _maxShapeError; }
+
+    /// Return whether both error bounds are within ctrl.maxRelativeError.
+    bool isAccurate() const {
+        return _maxKernelError <= _ctrl.maxRelativeError && _maxShapeError <= _ctrl.maxRelativeError;
+    }
+
+private:
+    struct Weights {
+        std::size_t index[4];
+        double weight[4];
+    };
+
+    Weights _computeWeights(geom::Point2D const& position) const;
+
+    std::shared_ptr<Image> doComputeKernelImage(geom::Point2D const& position,
+                                                afw::image::Color const& color) const override;
+
+    double doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                 afw::image::Color const& color) const override;
+
+    afw::geom::ellipses::Quadrupole doComputeShape(geom::Point2D const& position,
+                                                   afw::image::Color const& color) const override;
+
+    geom::Box2I doComputeBBox(geom::Point2D const& position, afw::image::Color const& color) const override;
+
+    std::shared_ptr<afw::detection::Psf const> _psf;
+    geom::Box2I _bbox;
+    Control _ctrl;
+    int _nx;
+    int _ny;
+    double _dx;
+    double _dy;
+    std::vector<std::shared_ptr<Image const>> _kernelImages;  // row-major, x varies fastest
+    std::vector<afw::geom::ellipses::Quadrupole> _shapes;
+    double _maxKernelError;
+    double _maxShapeError;
+};
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_GridInterpolatedPsf_h_INCLUDED
@@ -0,0 +1,62 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MEAS_BASE_HtmUtilities_h_INCLUDED
+#define LSST_MEAS_BASE_HtmUtilities_h_INCLUDED
+
+#include <cstdint>
+
+#include "ndarray.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Compute the HTM pixel index of each of a set of sky positions.
+ *
+ *  This is equivalent to calling sphgeom::HtmPixelization(level).index() on the unit vector of each
+ *  position, but converts and indexes all positions in a single call, distributing the work over
+ *  nThreads threads.
+ *
+ *  @param[in] ra        Right ascensions, in degrees.
+ *  @param[in] dec       Declinations, in degrees; must have the same size as ra.
+ *  @param[in] level     HTM subdivision level, in [0, sphgeom::HtmPixelization::MAX_LEVEL].
+ *  @param[in] nThreads  Number of threads to use; zero or negative for one per hardware thread.
+ *
+ *  @return Array of HTM indices.  Positions with a non-finite coordinate or a declination outside
+ *          [-90, 90] are given an index of 0, which is never a valid HTM index.
+ *
+ *  @throws pex::exceptions::LengthError if ra and dec have different sizes.
+ *  @throws pex::exceptions::InvalidParameterError if level is out of range.
+ */
+ndarray::Array<std::int64_t, 1, 1> computeHtmIndices(ndarray::Array<double const, 1> const& ra,
+                                                     ndarray::Array<double const, 1> const& dec, int level,
+                                                     int nThreads = 1);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_HtmUtilities_h_INCLUDED
@@ -0,0 +1,63 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MEAS_BASE_ParallelUtilities_h_INCLUDED
+#define LSST_MEAS_BASE_ParallelUtilities_h_INCLUDED
+
+#include <cstddef>
+#include <functional>
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Return the number of worker threads to use for a requested thread count.
+ *
+ *  Values less than or equal to zero select the number of hardware threads (or one, if that cannot be
+ *  determined).
+ */
+int resolveThreadCount(int nThreads);
+
+/**
+ *  Call func(i) for every i in [0, n), distributing the calls over a pool of threads.
+ *
+ *  Work is handed out dynamically one index at a time, so func may have strongly varying costs.  The
+ *  calling thread participates in the work, and no threads are started at all when n or nThreads is
+ *  one.  func must be safe to call concurrently for different indices.
+ *
+ *  If any call throws, no new indices are started, and the first exception is rethrown on the calling
+ *  thread after all workers have finished.
+ *
+ *  @param[in] n         Number of indices to process.
+ *  @param[in] nThreads  Number of threads to use (see resolveThreadCount()).
+ *  @param[in] func      Function to call for each index.
+ */
+void parallelFor(std::size_t n, int nThreads, std::function<void(std::size_t)> const& func);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_ParallelUtilities_h_INCLUDED
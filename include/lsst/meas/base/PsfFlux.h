@@ -24,7 +24,12 @@
 #ifndef LSST_MEAS_BASE_PsfFlux_h_INCLUDED
 #define LSST_MEAS_BASE_PsfFlux_h_INCLUDED
 
+#include <memory>
+
+#include "ndarray.h"
+
 #include "lsst/pex/config.h"
+#include "lsst/afw/detection/Psf.h"
 #include "lsst/meas/base/Algorithm.h"
 #include "lsst/meas/base/FluxUtilities.h"
 #include "lsst/meas/base/FlagHandler.h"
@@ -49,13 +54,25 @@ class PsfFluxControl {
 public:
     LSST_CONTROL_FIELD(badMaskPlanes, std::vector<std::string>,
                        "Mask planes that indicate pixels that should be excluded from the fit");
+    LSST_CONTROL_FIELD(subpixelPhases, int,
+                       "Number of sub-pixel phases per pixel at which shifted PSF images are tabulated "
+                       "(e.g. 8 for 1/8-pixel steps); 0 computes the PSF image at each exact position");
+    LSST_CONTROL_FIELD(interpolatePhases, bool,
+                       "Bilinearly blend the tabulated PSF images at the neighboring phases, instead of "
+                       "using the nearest phase directly?  Ignored if subpixelPhases is 0.");
+    LSST_CONTROL_FIELD(phaseCellSize, int,
+                       "Size (in pixels) of the square cells within which the PSF is assumed constant "
+                       "when using tabulated sub-pixel phases");
+    LSST_CONTROL_FIELD(doMeasureN, bool,
+                       "Jointly fit the Psf models of all sources passed to measureN, instead of fitting "
+                       "each one independently?");
 
     /**
      *  @brief Default constructor
      *
      *  All control classes should define a default constructor that sets all fields to their default values.
      */
-    PsfFluxControl() {}
+    PsfFluxControl() : subpixelPhases(0), interpolatePhases(true), phaseCellSize(256), doMeasureN(false) {}
 };
 
 /**
@@ -65,6 +82,10 @@ public:
  *  at a given position) to the data.  For point sources, this provides the optimal instFlux measurement
  *  in the limit where the Psf model is correct.  We do not use per-pixel weights in the fit, as this
  *  results in bright stars being fit with a different effective profile than faint stairs.
+ *
+ *  In multi-object mode (measureN with ctrl.doMeasureN), the Psf models of all sources in the catalog
+ *  (usually the children of a single parent) are fit simultaneously, so overlapping neighbors are
+ *  accounted for by the fit.
  */
 class PsfFluxAlgorithm : public SimpleAlgorithm {
 public:
@@ -84,10 +105,71 @@ public:
     virtual void measure(afw::table::SourceRecord& measRecord,
                          afw::image::Exposure<float> const& exposure) const;
 
+    /**
+     *  Jointly fit the Psf models of all sources in measCat.
+     *
+     *  Each source's model is restricted to its own fit region (the Psf model bounding box, clipped to
+     *  the exposure and with badMaskPlanes pixels removed), and the unweighted linear least-squares
+     *  problem for all fluxes is solved with a sparse normal matrix that couples only sources whose
+     *  fit regions overlap.  Uncertainties are the diagonal of the full flux covariance matrix, and
+     *  chi2 is computed from the residuals of the joint model in each source's fit region.
+     *
+     *  SingleFrameMeasurementTask calls measureN on each family with the parent inserted into the
+     *  noise-replaced image, so all of the children are present when they are fit jointly.
+     *
+     *  If ctrl.doMeasureN is false, each source is fit independently, exactly as measure() would.
+     */
+    virtual void measureN(afw::table::SourceCatalog const& measCat,
+                          afw::image::Exposure<float> const& exposure) const;
+
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const;
 
+    /**
+     *  Compute the PSF model image used to fit a source at the given position.
+     *
+     *  This is psf.computeImage(position) unless ctrl.subpixelPhases is nonzero, in which case the
+     *  image is built from a table of PSF images computed at quantized sub-pixel offsets from a
+     *  reference pixel in each phaseCellSize x phaseCellSize cell, and shifted by an integer number
+     *  of pixels to the requested position.  Tables are built lazily and discarded when a different
+     *  Psf is passed.  The returned image never shares pixels with the table, so it may be modified.
+     */
+    std::shared_ptr<afw::detection::Psf::Image> computePsfImage(
+            std::shared_ptr<afw::detection::Psf const> const& psf, geom::Point2D const& position) const;
+
+    /**
+     *  Fit the Psf model independently at each of the given positions, filling the outputs of the
+     *  corresponding records in measCat.
+     *
+     *  This is equivalent to calling measure() on each record with its centroid set to (x[i], y[i]),
+     *  but does not use the centroid slot or Footprints, and is intended for forced photometry on
+     *  images (such as difference images) where positions are known in advance and neighbors need not
+     *  be replaced with noise.  Sources are processed in order of the phaseCellSize x phaseCellSize
+     *  cell that contains them, so spatially-varying Psfs (and the sub-pixel phase tables, if enabled)
+     *  are evaluated with good locality.  Psf images are evaluated serially, as Psf implementations are
+     *  not generally thread-safe, while the fits themselves are distributed over nThreads threads.
+     *
+     *  Sources with non-finite positions have the general failure flag set.  MeasurementErrors (and
+     *  other non-fatal errors) raised while fitting a source set its flags as fail() would.
+     *
+     *  @param[in,out] measCat   Catalog whose records receive the outputs of this algorithm.
+     *  @param[in]     exposure  Image to measure.
+     *  @param[in]     x         Column positions, one per record, in the parent coordinates of exposure.
+     *  @param[in]     y         Row positions, one per record.
+     *  @param[in]     nThreads  Number of threads to use; zero or negative for one per hardware thread.
+     */
+    void measureCatalog(afw::table::SourceCatalog const& measCat,
+                        afw::image::Exposure<float> const& exposure, ndarray::Array<double const, 1> const& x,
+                        ndarray::Array<double const, 1> const& y, int nThreads = 0) const;
+
 private:
+    class PhaseTable;
+
+    // Fit the given Psf model image to the exposure and record the results.
+    void _fitPsfModel(afw::table::SourceRecord& measRecord, afw::detection::Psf::Image const& psfImage,
+                      afw::image::Exposure<float> const& exposure, afw::image::MaskPixel badBits) const;
+
     Control _ctrl;
+    std::shared_ptr<PhaseTable> _phaseTable;
     FluxResultKey _instFluxResultKey;
     afw::table::Key<float> _areaKey;   // effective area of PSF
     afw::table::Key<float> _chi2Key;   // chi2 of the fitted PSF
@@ -24,7 +24,11 @@
 #ifndef LSST_MEAS_BASE_ScaledApertureFlux_h_INCLUDED
 #define LSST_MEAS_BASE_ScaledApertureFlux_h_INCLUDED
 
+#include <memory>
+#include <mutex>
+
 #include "lsst/afw/table.h"
+#include "lsst/afw/detection/Psf.h"
 #include "lsst/afw/image/Exposure.h"
 #include "lsst/meas/base/Algorithm.h"
 #include "lsst/meas/base/ApertureFlux.h"
@@ -43,13 +47,18 @@ public:
             shiftKernel, std::string,
             "Warping kernel used to shift Sinc photometry coefficients to different center positions");
     LSST_CONTROL_FIELD(scale, double, "Scaling factor of PSF FWHM for aperture radius.");
+    LSST_CONTROL_FIELD(radiusStep, double,
+                       "Spacing (pixels) of the aperture radii for which Sinc coefficients are cached; "
+                       "coefficients for other radii are interpolated linearly between the neighbouring "
+                       "cached radii.  Zero (the default) to compute exact coefficients for every "
+                       "source.");
 
     // The default scaling factor is chosen such that scaled aperture
     // magnitudes are expected to be equal to Kron magnitudes, based on
     // measurements performed by Stephen Gwyn on WIRCam. See:
     // http://www.cadc-ccda.hia-iha.nrc-cnrc.gc.ca/en/wirwolf/docs/proc.html#photcal
     // http://www.cfht.hawaii.edu/fr/news/UM2013/presentations/Session10-SGwyn.pdf
-    ScaledApertureFluxControl() : shiftKernel("lanczos5"), scale(3.14) {}
+    ScaledApertureFluxControl() : shiftKernel("lanczos5"), scale(3.14), radiusStep(0.0) {}
 };
 
 /**
@@ -58,6 +67,12 @@ public:
  *  This algorithm performs a sinc aperture instFlux measurement where they size
  *  of the aperture is determined by multiplying the FWHM of the PSF by the
  *  scaling factor specified in the algorithm configuration.
+ *
+ *  If radiusStep is positive, the Sinc coefficients are interpolated from a cache
+ *  over quantized radii (see SincCoeffs::getInterpolated).  The measurement tasks
+ *  fill that cache for the range of PSF sizes across the exposure by calling
+ *  cacheCoefficients once before measuring; otherwise coefficients for each quantized
+ *  radius are computed when first needed.
  */
 class ScaledApertureFluxAlgorithm : public SimpleAlgorithm {
 public:
@@ -79,11 +94,27 @@ public:
 
     virtual void fail(afw::table::SourceRecord& measRecord, MeasurementError* error = nullptr) const override;
 
+    /**
+     *  Cache the Sinc coefficients for the range of aperture radii needed to measure an exposure.
+     *
+     *  The PSF is evaluated on a 3x3 grid spanning the exposure, and the coefficients for all quantized
+     *  radii between the smallest and largest aperture radius found are computed.  Does nothing if
+     *  radiusStep is zero, if the exposure has no PSF, or if this PSF has already been cached.
+     *  This is intended to be called once per exposure, not per source.
+     *
+     *  @param[in]     exposure    Image to be measured.
+     */
+    void cacheCoefficients(afw::image::Exposure<float> const& exposure) const;
+
 private:
+    double _computeApertureRadius(afw::detection::Psf const& psf, geom::Point2D const& position) const;
+
     Control _ctrl;
     FluxResultKey _instFluxResultKey;
     FlagHandler _flagHandler;
     SafeCentroidExtractor _centroidExtractor;
+    mutable std::mutex _cacheMutex;                              // Protects _cachedPsf
+    mutable std::weak_ptr<afw::detection::Psf const> _cachedPsf;  // PSF coefficients were last cached for
 };
 
 class ScaledApertureFluxTransform : public FluxTransform {
@@ -0,0 +1,80 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef LSST_MEAS_BASE_SegmentStatistics_h_INCLUDED
+#define LSST_MEAS_BASE_SegmentStatistics_h_INCLUDED
+
+#include <cstdint>
+
+#include "ndarray.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+/**
+ *  Compute percentiles of each of a set of contiguous segments of an array.
+ *
+ *  Segment i consists of the elements values[offsets[i]:offsets[i + 1]].  NaN values are ignored, and
+ *  percentiles between two values are linearly interpolated, matching numpy.nanpercentile with its
+ *  default method.  Each segment is processed with a partial selection (std::nth_element) on a
+ *  per-thread scratch buffer, successively narrowed for increasing percentiles, rather than a sort.
+ *
+ *  @param[in] values       Values of all segments.
+ *  @param[in] offsets      Start of each segment in values, followed by the end of the last one; must be
+ *                          non-decreasing and lie within [0, values.size()].
+ *  @param[in] percentiles  Percentiles to compute, in [0, 100].
+ *  @param[in] nThreads     Number of threads to use; zero or negative for one per hardware thread.
+ *
+ *  @return Array of shape (offsets.size() - 1, percentiles.size()).  Rows for segments with no
+ *          non-NaN values are NaN.
+ *
+ *  @throws pex::exceptions::InvalidParameterError if offsets or percentiles are invalid.
+ */
+ndarray::Array<double, 2, 2> computeSegmentPercentiles(ndarray::Array<double const, 1> const& values,
+                                                       ndarray::Array<std::int64_t const, 1> const& offsets,
+                                                       ndarray::Array<double const, 1> const& percentiles,
+                                                       int nThreads = 1);
+
+/**
+ *  Compute the median absolute deviation from the median of each of a set of contiguous segments of an
+ *  array.
+ *
+ *  NaN values are ignored.  The result is not scaled to a Gaussian sigma, matching
+ *  astropy.stats.median_absolute_deviation.  Arguments are as for computeSegmentPercentiles().
+ *
+ *  @return Array of offsets.size() - 1 deviations; NaN for segments with no non-NaN values.
+ *
+ *  @throws pex::exceptions::InvalidParameterError if offsets are invalid.
+ */
+ndarray::Array<double, 1, 1> computeSegmentMads(ndarray::Array<double const, 1> const& values,
+                                                ndarray::Array<std::int64_t const, 1> const& offsets,
+                                                int nThreads = 1);
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
+
+#endif  // !LSST_MEAS_BASE_SegmentStatistics_h_INCLUDED
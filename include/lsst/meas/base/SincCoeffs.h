@@ -24,7 +24,11 @@
 #ifndef LSST_MEAS_BASE_SincCoeffs_h_INCLUDED
 #define LSST_MEAS_BASE_SincCoeffs_h_INCLUDED
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
+#include <mutex>
+#include <vector>
 
 #include "lsst/afw/image/Image.h"
 #include "lsst/afw/geom/ellipses/Axes.h"
@@ -39,13 +43,38 @@ namespace base {
  * Caching is only performed for circular apertures (because elliptical
  * apertures are assumed to be generated dynamically, and hence not expected
  * to recur).  Caching must be explicitly requested for a particular circular
- * aperture (using the 'cache' method).
+ * aperture (using the 'cache' method), except for apertures whose radius varies
+ * continuously from source to source, which may use coefficients interpolated
+ * between radii on a grid (using the 'getInterpolated' method).
+ *
+ * The cache is unbounded unless a capacity is set with 'setCacheCapacity', in which case the least
+ * recently used entries are evicted to keep within it.  Evicted apertures are recalculated when next
+ * requested, but only entries for the radii used by 'getInterpolated' are cached again automatically.
  */
 template <typename PixelT>
 class SincCoeffs {
 public:
     typedef afw::image::Image<PixelT> CoeffT;
 
+    /// Statistics of the use of the cache since they were last reset
+    struct CacheStatistics {
+        std::size_t hits = 0;       ///< Requests satisfied from the cache
+        std::size_t misses = 0;     ///< Requests for which coefficients were calculated
+        std::size_t evictions = 0;  ///< Entries evicted to keep the cache within its capacity
+        double computeTime = 0.0;   ///< Seconds spent calculating coefficients for misses
+        std::size_t entries = 0;    ///< Number of apertures currently cached
+        std::size_t bytes = 0;      ///< Bytes of coefficients currently cached
+    };
+
+    /// Description of a cached aperture
+    struct CacheEntry {
+        float radius;        ///< Outer radius of the aperture
+        float innerFactor;   ///< Ratio of the inner to the outer radius
+        std::size_t bytes;   ///< Bytes of coefficients
+        std::size_t hits;    ///< Requests satisfied by this entry
+        double computeTime;  ///< Seconds spent calculating the coefficients
+    };
+
     /**
      * Cache the coefficients for a particular aperture
      *
@@ -61,6 +90,55 @@ public:
     static std::shared_ptr<CoeffT const>
             get(afw::geom::ellipses::Axes const& outerEllipse, float const innerRadiusFactor = 0.0);
 
+    /**
+     * Get the coefficients for a circular aperture, interpolated between quantized radii
+     *
+     * Coefficients are cached for radii that are integer multiples of radiusStep, and are generated
+     * when first needed; the coefficients for any other radius are the linear interpolation between
+     * those of the two neighbouring cached radii.  As the measured instFlux is linear in the
+     * coefficients, this is equivalent to interpolating the curve of growth, so the bias relative to
+     * exact coefficients is at most radiusStep^2/8 times its curvature.
+     *
+     * @param[in] radius      Radius of the aperture.
+     * @param[in] radiusStep  Spacing of the cached radii; must be positive.
+     */
+    static std::shared_ptr<CoeffT const> getInterpolated(float radius, float radiusStep);
+
+    /**
+     * Cache the coefficients needed by getInterpolated for all radii in a range
+     *
+     * @param[in] rMin        Smallest radius that will be requested.
+     * @param[in] rMax        Largest radius that will be requested.
+     * @param[in] radiusStep  Spacing of the cached radii; must be positive.
+     */
+    static void cacheInterpolated(float rMin, float rMax, float radiusStep);
+
+    /// Return the number of bytes of pixel data held in the cache
+    static std::size_t getCacheBytes();
+
+    /// Return the cache statistics
+    static CacheStatistics getCacheStatistics();
+
+    /// Return a description of each cached aperture, in order of radius
+    static std::vector<CacheEntry> getCacheEntries();
+
+    /// Reset the hit, miss, eviction and compute time counts, including those of each entry
+    static void resetCacheStatistics();
+
+    /**
+     * Set the maximum number of bytes of coefficients to cache
+     *
+     * @param[in] capacity  Maximum number of bytes; zero for no limit.  The most recently used entry is
+     *                      kept even if it alone exceeds the capacity.
+     */
+    static void setCacheCapacity(std::size_t capacity);
+
+    /// Return the maximum number of bytes of coefficients to cache; zero for no limit
+    static std::size_t getCacheCapacity();
+
+    /// Remove all entries from the cache
+    static void clearCache();
+
     /// Calculate the coefficients for an aperture
     static std::shared_ptr<CoeffT>
             calculate(afw::geom::ellipses::Axes const& outerEllipse, double const innerFactor = 0.0);
@@ -78,23 +156,55 @@ private:
         bool isEqual(T x, T y) const { return ::fabs(x - y) < std::numeric_limits<T>::epsilon(); }
     };
 
-    typedef std::map<float, std::shared_ptr<CoeffT>, FuzzyCompare<float> > CoeffMap;
+    struct Entry {
+        std::shared_ptr<CoeffT> coeff;
+        std::size_t hits;
+        std::uint64_t lastUse;
+        double computeTime;
+    };
+
+    typedef std::map<float, Entry, FuzzyCompare<float> > CoeffMap;
     typedef std::map<float, CoeffMap, FuzzyCompare<float> > CoeffMapMap;
-    SincCoeffs() : _cache(){};
+    SincCoeffs() : _cache(), _stats(), _capacity(0), _clock(0){};
     SincCoeffs(SincCoeffs const&);      // unimplemented: singleton
     void operator=(SincCoeffs const&);  // unimplemented: singleton
 
     static SincCoeffs& getInstance();
 
     /*
-     * Search the cache for coefficients for an aperture
+     * Search the cache for coefficients for an aperture, counting a hit if they are found
      *
-     * If the coefficients are not cached, a null shared_ptr will be returned.
+     * If the coefficients are not cached, a null shared_ptr will be returned.  Must be called with
+     * _mutex held.
      */
     std::shared_ptr<CoeffT const>
-    _lookup(afw::geom::ellipses::Axes const& outerEllipse, double const innerRadiusFactor = 0.0) const;
+    _lookup(afw::geom::ellipses::Axes const& outerEllipse, double const innerRadiusFactor = 0.0);
+
+    /*
+     * Calculate the coefficients for an aperture, counting a miss
+     *
+     * Must be called without _mutex held.  The time taken, in seconds, is returned in computeTime.
+     */
+    std::shared_ptr<CoeffT> _calculate(afw::geom::ellipses::Axes const& outerEllipse,
+                                       double const innerFactor, double& computeTime);
+
+    /*
+     * Evict the least recently used entries until the cache is within its capacity
+     *
+     * Must be called with _mutex held.
+     */
+    void _evict();
+
+    /*
+     * Return the cached coefficients for a circular aperture, calculating and caching them if necessary
+     */
+    std::shared_ptr<CoeffT const> _lookupOrCache(float radius, double const innerFactor);
 
     CoeffMapMap _cache;  //< Cache of coefficients
+    CacheStatistics _stats;  //< Statistics of the use of _cache
+    std::size_t _capacity;  //< Maximum bytes in _cache; zero for no limit
+    std::uint64_t _clock;  //< Counter of uses of _cache, for recording the last use of each entry
+    mutable std::mutex _mutex;  //< Protects _cache, _stats, _capacity and _clock
 };
 
 }  // namespace base
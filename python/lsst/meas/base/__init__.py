@@ -35,14 +35,18 @@ from .catalogCalculation import *
 from .classification import *
 from .diaCalculation import *
 from .diaCalculationPlugins import *
+from .diaSegments import *
+from .familyScheduler import *
 from .footprintArea import *
 from .forcedMeasurement import *
 from .forcedPhotCcd import *
+from .memoryAccounting import *
 from .noiseReplacer import *
 from .pluginRegistry import *
 from .plugins import *
 from .pluginsBase import *
 from .sfm import *
+from .tracing import *
 from .transforms import *
 from .wrappers import *
 from .compensatedGaussian import *
@@ -41,7 +41,11 @@ void wrapCentroidUtilities(WrapperCollection&);
 void wrapCircularApertureFlux(WrapperCollection&);
 void wrapExceptions(WrapperCollection&);
 void wrapFlagHandler(WrapperCollection&);
+void wrapFootprintIndex(WrapperCollection&);
+void wrapFootprintUtilities(WrapperCollection&);
 void wrapGaussianFlux(WrapperCollection &);
+void wrapGridInterpolatedPsf(WrapperCollection&);
+void wrapHtmUtilities(WrapperCollection&);
 void wrapInputUtilities(WrapperCollection&);
 void wrapLocalBackground(WrapperCollection&);
 void wrapNaiveCentroid(WrapperCollection&);
@@ -49,6 +53,7 @@ void wrapPeakLikelihoodFlux(WrapperCollection&);
 void wrapPixelFLags(WrapperCollection&);
 void wrapPsfFlux(WrapperCollection&);
 void wrapScaledApertureFlux(WrapperCollection&);
+void wrapSegmentStatistics(WrapperCollection&);
 void wrapSddsCentroid(WrapperCollection&);
 void wrapShapeUtilities(WrapperCollection&);
 void wrapSincCoeffs(WrapperCollection&);
@@ -59,6 +64,7 @@ void wrapCalcCompensatedGaussian(WrapperCollection&);
 PYBIND11_MODULE(_measBaseLib, mod) {
     lsst::cpputils::python::WrapperCollection wrappers(mod, "lsst.meas.base");
 
+    wrappers.addInheritanceDependency("lsst.afw.detection");
     wrappers.addInheritanceDependency("lsst.afw.geom");
     wrappers.addInheritanceDependency("lsst.afw.image");
     wrappers.addInheritanceDependency("lsst.afw.table");
@@ -75,7 +81,11 @@ PYBIND11_MODULE(_measBaseLib, mod) {
     wrapBlendedness(wrappers);
     wrapCentroidUtilities(wrappers);
     wrapCircularApertureFlux(wrappers);
+    wrapFootprintIndex(wrappers);
+    wrapFootprintUtilities(wrappers);
     wrapGaussianFlux(wrappers);
+    wrapGridInterpolatedPsf(wrappers);
+    wrapHtmUtilities(wrappers);
     wrapInputUtilities(wrappers);
     wrapLocalBackground(wrappers);
     wrapNaiveCentroid(wrappers);
@@ -83,6 +93,7 @@ PYBIND11_MODULE(_measBaseLib, mod) {
     wrapPixelFLags(wrappers);
     wrapPsfFlux(wrappers);
     wrapScaledApertureFlux(wrappers);
+    wrapSegmentStatistics(wrappers);
     wrapSddsCentroid(wrappers);
     wrapShapeUtilities(wrappers);
     wrapSincCoeffs(wrappers);
@@ -51,12 +51,15 @@ void declareSimpleAlgorithm(lsst::cpputils::python::WrapperCollection &wrappers)
                       [](auto &mod, auto &cls) {
                           cls.def("measureForced", &SimpleAlgorithm::measureForced, "measRecord"_a, "exposure"_a,
                                   "refRecord"_a, "refWcs"_a);
+                          cls.def("measureNForced", &SimpleAlgorithm::measureNForced, "measCat"_a,
+                                  "exposure"_a, "refCat"_a, "refWcs"_a);
                       });
 }
 
 void declareSingleFrameAlgorithm(lsst::cpputils::python::WrapperCollection &wrappers) {
     wrappers.wrapType(PySingleFrameAlgorithm(wrappers.module, "SingleFrameAlgorithm"), [](auto &mod, auto &cls) {
         cls.def("measure", &SingleFrameAlgorithm::measure, "record"_a, "exposure"_a);
+        cls.def("measureN", &SingleFrameAlgorithm::measureN, "measCat"_a, "exposure"_a);
     });
 }
 
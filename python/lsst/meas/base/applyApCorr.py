@@ -27,6 +27,7 @@ import lsst.pex.exceptions
 import lsst.pipe.base
 from lsst.utils.logging import PeriodicLogger
 from .apCorrRegistry import getApCorrNameSet
+from .tracing import traceSpan
 
 # If True then scale instFlux error by apCorr; if False then use a more complex computation
 # that over-estimates instFlux error (often grossly so) because it double-counts photon noise.
@@ -263,14 +264,15 @@ class ApplyApCorrTask(lsst.pipe.base.Task):
                 oldFluxFlagState = catalog[apCorrInfo.fluxFlagKey]
                 catalog[apCorrInfo.fluxFlagKey] = True
 
-            apCorr = apCorrModel.evaluate(catalog["slot_Centroid_x"], catalog["slot_Centroid_y"])
-            if not UseNaiveFluxErr:
-                apCorrErr = apCorrErrModel.evaluate(
-                    catalog["slot_Centroid_x"],
-                    catalog["slot_Centroid_y"],
-                )
-            else:
-                apCorrErr = np.zeros(len(catalog))
+            with traceSpan(apCorrInfo.name, "apCorr", nSources=len(catalog)):
+                apCorr = apCorrModel.evaluate(catalog["slot_Centroid_x"], catalog["slot_Centroid_y"])
+                if not UseNaiveFluxErr:
+                    apCorrErr = apCorrErrModel.evaluate(
+                        catalog["slot_Centroid_x"],
+                        catalog["slot_Centroid_y"],
+                    )
+                else:
+                    apCorrErr = np.zeros(len(catalog))
 
             if apCorrInfo.doApCorrColumn:
                 catalog[apCorrInfo.apCorrKey] = apCorr
@@ -23,17 +23,23 @@
 measurement tasks.
 """
 import warnings
+from contextlib import contextmanager
+
+import numpy as np
 
 import lsst.pipe.base
 import lsst.pex.config
 
 from .pluginRegistry import PluginMap
-from ._measBaseLib import FatalAlgorithmError, MeasurementError
+from ._measBaseLib import (FatalAlgorithmError, MeasurementError, GridInterpolatedPsf,
+                           GridInterpolatedPsfControl)
 from lsst.afw.detection import InvalidPsfError
 from .pluginsBase import BasePluginConfig, BasePlugin
 from .noiseReplacer import NoiseReplacerConfig
+from .memoryAccounting import MemoryRecorder, getSincCoeffsStatistics
+from .tracing import traceSpan
 
-__all__ = ("BaseMeasurementPluginConfig", "BaseMeasurementPlugin",
+__all__ = ("BaseMeasurementPluginConfig", "BaseMeasurementPlugin", "GridInterpolatedPsfConfig",
            "BaseMeasurementConfig", "BaseMeasurementTask")
 
 # Exceptions that the measurement tasks should always propagate up to their
@@ -137,6 +143,14 @@ class SourceSlotConfig(lsst.pex.config.Config):
             aliases.set("slot_CalibFlux", self.calibFlux)
 
 
+@lsst.pex.config.wrap(GridInterpolatedPsfControl)
+class GridInterpolatedPsfConfig(lsst.pex.config.Config):
+    """Configuration for the grid-interpolated PSF approximation used when
+    ``doApproximatePsf`` is set.
+    """
+    pass
+
+
 class BaseMeasurementConfig(lsst.pex.config.Config):
     """Base configuration for all measurement driver tasks.
 
@@ -195,6 +209,26 @@ class BaseMeasurementConfig(lsst.pex.config.Config):
         dtype=str, default="undeblended_",
         doc="Prefix to give undeblended plugins"
     )
+    doApproximatePsf = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Measure with a grid-interpolated approximation to the exposure's PSF, if the approximation "
+            "passes its accuracy check?  Useful when the PSF model is expensive to evaluate."
+    )
+    approximatePsf = lsst.pex.config.ConfigField(
+        dtype=GridInterpolatedPsfConfig,
+        doc="Configuration for the PSF approximation used if doApproximatePsf is set"
+    )
+    doMeasureCatalog = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Run plugins that implement a catalog-level measureCatalog method once over all sources, "
+            "instead of once per source?  They are run after all per-source plugins, so each must have "
+            "a later execution order than every per-source plugin; requires doReplaceWithNoise=False."
+    )
+    doRecordMemory = lsst.pex.config.Field(
+        dtype=bool, default=False,
+        doc="Record the memory held by footprints, noise replacement and cached aperture coefficients, "
+            "and the process high-water mark, at stage boundaries in the task metadata?"
+    )
 
     def validate(self):
         super().validate()
@@ -225,6 +259,13 @@ class BaseMeasurementConfig(lsst.pex.config.Config):
                         f"Source instFlux algorithm '{slot}' is not being run, required from "
                         f"non-None slots in: {self.slots}."
                     )
+        if self.doMeasureCatalog and self.doReplaceWithNoise:
+            raise lsst.pex.config.FieldValidationError(
+                self.__class__.doMeasureCatalog,
+                self,
+                "catalog-level plugins measure the image without noise replacement, so "
+                "doReplaceWithNoise must be False."
+            )
 
 
 class BaseMeasurementTask(lsst.pipe.base.Task):
@@ -263,6 +304,26 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
     the output catalog. Will be filled by subclasses.
     """
 
+    memory = None
+    """Recorder of memory usage at stage boundaries, which records nothing
+    unless ``config.doRecordMemory`` is set (`MemoryRecorder`).
+    """
+
+    PSF_APPROX_KERNEL_ERROR = "PSF_APPROX_KERNEL_ERROR"
+    """Name by which the largest relative kernel-image error of the PSF
+    approximation is recorded in metadata (`float`).
+    """
+
+    PSF_APPROX_SHAPE_ERROR = "PSF_APPROX_SHAPE_ERROR"
+    """Name by which the largest relative PSF size error of the PSF
+    approximation is recorded in metadata (`float`).
+    """
+
+    PSF_APPROX_USED = "PSF_APPROX_USED"
+    """Name by which whether the PSF approximation was used is recorded in
+    metadata (`bool`).
+    """
+
     def __init__(self, algMetadata=None, **kwds):
         super(BaseMeasurementTask, self).__init__(**kwds)
         self.plugins = PluginMap()
@@ -270,6 +331,7 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         if algMetadata is None:
             algMetadata = lsst.daf.base.PropertyList()
         self.algMetadata = algMetadata
+        self.memory = MemoryRecorder(self.metadata if self.config.doRecordMemory else None)
 
     def initializePlugins(self, **kwds):
         """Initialize plugins (and slots) according to configuration.
@@ -340,6 +402,154 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
                 type="Flag",
                 doc="Invalid PSF at this location.",
             )
+        self._checkCatalogPluginOrder()
+
+    def _checkCatalogPluginOrder(self):
+        """Check that the plugins `callMeasureCatalog` runs come after every
+        per-source plugin in execution order.
+
+        Raises
+        ------
+        lsst.pex.config.FieldValidationError
+            Raised if a plugin that would be run by `callMeasureCatalog` has
+            an execution order no later than that of a per-source plugin,
+            whose outputs it would otherwise be measured after.
+        """
+        catalogPluginNames = self.getCatalogPluginNames()
+        if not catalogPluginNames:
+            return
+        perSourceOrders = [plugin.getExecutionOrder() for plugin in self.plugins.iter()
+                           if plugin.name not in catalogPluginNames]
+        if not perSourceOrders:
+            return
+        lastPerSourceOrder = max(perSourceOrders)
+        for plugin in self.plugins.iter():
+            if plugin.name in catalogPluginNames and plugin.getExecutionOrder() <= lastPerSourceOrder:
+                raise lsst.pex.config.FieldValidationError(
+                    self.config.__class__.doMeasureCatalog,
+                    self.config,
+                    f"plugin {plugin.name} (execution order {plugin.getExecutionOrder()}) would be run "
+                    f"after per-source plugins with execution orders up to {lastPerSourceOrder}."
+                )
+
+    @contextmanager
+    def approximatePsf(self, exposure, algMetadata=None):
+        """Temporarily replace the PSF of an exposure with a grid-interpolated
+        approximation, if so configured.
+
+        Parameters
+        ----------
+        exposure : `lsst.afw.image.ExposureF`
+            Exposure whose PSF is to be approximated.  The original PSF is
+            restored on exit.
+        algMetadata : `lsst.daf.base.PropertyList`, optional
+            If not `None`, the error bounds measured for the approximation
+            and whether it was used are recorded here.
+
+        Notes
+        -----
+        The approximation is only used if its interpolation errors, measured
+        at random check points against the exact PSF, are all within
+        ``config.approximatePsf.maxRelativeError``; otherwise the exact PSF
+        is left in place and a warning is logged.  This is a no-op if
+        ``config.doApproximatePsf`` is `False` or the exposure has no PSF.
+        """
+        exactPsf = exposure.getPsf()
+        if not self.config.doApproximatePsf or exactPsf is None:
+            yield
+            return
+        approxPsf = GridInterpolatedPsf(exactPsf, exposure.getBBox(),
+                                        self.config.approximatePsf.makeControl())
+        useApprox = approxPsf.isAccurate()
+        if algMetadata is not None:
+            algMetadata.addDouble(self.PSF_APPROX_KERNEL_ERROR, approxPsf.getMaxKernelError())
+            algMetadata.addDouble(self.PSF_APPROX_SHAPE_ERROR, approxPsf.getMaxShapeError())
+            algMetadata.addBool(self.PSF_APPROX_USED, useApprox)
+        if not useApprox:
+            self.log.warning("PSF approximation errors (kernel: %g, shape: %g) exceed %g; "
+                             "using the exact PSF.", approxPsf.getMaxKernelError(),
+                             approxPsf.getMaxShapeError(), self.config.approximatePsf.maxRelativeError)
+            yield
+            return
+        self.log.info("Measuring with a %dx%d grid approximation to the PSF "
+                      "(max errors: kernel %g, shape %g).",
+                      approxPsf.getNx(), approxPsf.getNy(), approxPsf.getMaxKernelError(),
+                      approxPsf.getMaxShapeError())
+        exposure.setPsf(approxPsf)
+        try:
+            yield
+        finally:
+            exposure.setPsf(exactPsf)
+
+    @contextmanager
+    def recordSincCoeffsStatistics(self):
+        """Record how effectively the Sinc aperture coefficient cache was
+        used within a ``with`` block.
+
+        Notes
+        -----
+        The numbers of cache hits, misses and evictions and the time spent
+        calculating coefficients within the block, and the number of entries
+        and bytes cached at its end, are recorded in the task metadata under
+        ``sincCoeffs.`` and logged at verbose level.  As the cache is shared
+        by the whole process, the counts include any use by other threads.
+        """
+        before = getSincCoeffsStatistics()
+        try:
+            yield
+        finally:
+            # Record what was done before any exception, too.
+            after = getSincCoeffsStatistics()
+            for name in ("hits", "misses", "evictions", "computeTime"):
+                after[name] -= before[name]
+            if after["hits"] != 0 or after["misses"] != 0:
+                for name, value in after.items():
+                    self.metadata[f"sincCoeffs.{name}"] = value
+                self.log.verbose("Sinc coefficient cache: %d hits, %d misses (%.3f s computing), "
+                                 "%d evictions; %d entries holding %d bytes", after["hits"],
+                                 after["misses"], after["computeTime"], after["evictions"],
+                                 after["entries"], after["bytes"])
+
+    def cacheCoefficients(self, exposure, beginOrder=None, endOrder=None):
+        """Call ``cacheCoefficients`` once for the exposure on all C++
+        plugins that implement it.
+
+        Parameters
+        ----------
+        exposure : `lsst.afw.image.ExposureF`
+            Image about to be measured.
+        beginOrder : `int`, optional
+            Beginning execution order (inclusive): plugins with
+            ``executionOrder`` < ``beginOrder`` are skipped. `None` for no
+            limit.
+        endOrder : `int`, optional
+            Ending execution order (exclusive): plugins with
+            ``executionOrder`` >= ``endOrder`` are skipped. `None` for no
+            limit.
+
+        Notes
+        -----
+        Plugins such as ``base_ScaledApertureFlux`` use this to precompute
+        per-exposure state (e.g. Sinc coefficients for the range of PSF sizes)
+        so that ``measure`` need not check for it on every source.  Failures
+        are logged and otherwise ignored, as the state is then computed when
+        first needed.
+        """
+        for plugin in self.plugins.iter():
+            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+                break
+            cacheCoefficients = getattr(getattr(plugin, "cpp", None), "cacheCoefficients", None)
+            if cacheCoefficients is None:
+                continue
+            try:
+                cacheCoefficients(exposure)
+            except FATAL_EXCEPTIONS:
+                raise
+            except Exception as error:
+                self.log.getChild(plugin.name).debug("Exception in %s.cacheCoefficients: %s",
+                                                     plugin.name, error)
 
     def callMeasure(self, measRecord, *args, **kwds):
         """Call ``measure`` on all plugins and consistently handle exceptions.
@@ -364,6 +574,10 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
                 ``executionOrder`` >= ``endOrder`` are not executed. `None`
                 for no limit.
 
+            skipPlugins : collection of `str`
+                Names of plugins to skip, because they are run over the whole
+                catalog instead (see `getCatalogPluginNames`).
+
             Others are forwarded to ``plugin.measure()``.
 
         Notes
@@ -378,11 +592,14 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         """
         beginOrder = kwds.pop("beginOrder", None)
         endOrder = kwds.pop("endOrder", None)
+        skipPlugins = kwds.pop("skipPlugins", ())
         for plugin in self.plugins.iter():
             if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
                 continue
             if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
                 break
+            if plugin.name in skipPlugins:
+                continue
             self.doMeasurement(plugin, measRecord, *args, **kwds)
 
     def doMeasurement(self, plugin, measRecord, *args, **kwds):
@@ -413,7 +630,8 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         derived classes, not users.
         """
         try:
-            plugin.measure(measRecord, *args, **kwds)
+            with traceSpan(plugin.name, "plugin"):
+                plugin.measure(measRecord, *args, **kwds)
         except FATAL_EXCEPTIONS:
             raise
         except MeasurementError as error:
@@ -504,7 +722,8 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
         derived classes, not users.
         """
         try:
-            plugin.measureN(measCat, *args, **kwds)
+            with traceSpan(plugin.name, "pluginN"):
+                plugin.measureN(measCat, *args, **kwds)
         except FATAL_EXCEPTIONS:
             raise
 
@@ -528,6 +747,143 @@ class BaseMeasurementTask(lsst.pipe.base.Task):
             for measRecord in measCat:
                 plugin.fail(measRecord)
 
+    def getCatalogPluginNames(self):
+        """Return the names of the plugins that `callMeasureCatalog` runs.
+
+        Returns
+        -------
+        names : `set` [`str`]
+            Names of the plugins that implement ``measureCatalog``, or an
+            empty set if ``config.doMeasureCatalog`` is `False`.
+        """
+        if not self.config.doMeasureCatalog:
+            return set()
+        return {plugin.name for plugin in self.plugins.iter() if getattr(plugin, "hasMeasureCatalog", False)}
+
+    def callMeasureCatalog(self, measCat, exposure, *args, beginOrder=None, endOrder=None):
+        """Call ``measureCatalog`` on all plugins that implement it and
+        consistently handle exceptions.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog of all sources being measured, where outputs should be
+            written.
+        exposure : `lsst.afw.image.Exposure`
+            Exposure on which the sources are being measured.
+        *args
+            Per-source arguments to ``plugin.measure()`` after the exposure,
+            each a sequence with one element per source; used only if a
+            plugin's ``measureCatalog`` cannot be used.
+        beginOrder : `int`, optional
+            Beginning execution order (inclusive): measurements with
+            ``executionOrder`` < ``beginOrder`` are not executed. `None` for
+            no limit.
+        endOrder : `int`, optional
+            Ending execution order (exclusive): measurements with
+            ``executionOrder`` >= ``endOrder`` are not executed. `None` for
+            no limit.
+
+        Notes
+        -----
+        The centers passed to the plugins are those of the centroid slot
+        (see `getCatalogCenters`), as for individual sources.  If they cannot
+        be computed, each plugin's ``measure`` is called on each source
+        instead, so failures are recorded per source as usual.
+
+        This method should be considered "protected": it is intended for use by
+        derived classes, not users.
+        """
+        if len(measCat) == 0:
+            return
+        catalogPluginNames = self.getCatalogPluginNames()
+        plugins = []
+        for plugin in self.plugins.iter():
+            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+                break
+            if plugin.name in catalogPluginNames:
+                plugins.append(plugin)
+        if not plugins:
+            return
+        try:
+            centers = self.getCatalogCenters(measCat)
+        except FATAL_EXCEPTIONS:
+            raise
+        except Exception as error:
+            self.log.debug("Cannot get the centers of %d records; measuring them individually: %s",
+                           len(measCat), error)
+            centers = None
+        for plugin in plugins:
+            self.doMeasurementCatalog(plugin, measCat, exposure, centers, *args)
+
+    def doMeasurementCatalog(self, plugin, measCat, exposure, centers, *args):
+        """Call ``measureCatalog`` on the specified plugin.
+
+        If it raises a non-fatal exception, or ``centers`` is `None`, the
+        plugin's ``measure`` is called on each source in turn instead, so
+        failures are recorded per source as usual.
+
+        Parameters
+        ----------
+        plugin : subclass of `BasePlugin`
+            Plugin that will be executed.
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog of all sources being measured, where outputs should be
+            written.
+        exposure : `lsst.afw.image.Exposure`
+            Exposure on which the sources are being measured.
+        centers : `numpy.ndarray` or `None`
+            Array of shape ``(len(measCat), 2)`` of the pixel coordinates of
+            each source, or `None` if they are not available.
+        *args
+            Per-source arguments to ``plugin.measure()`` after the exposure,
+            each a sequence with one element per source.
+
+        Notes
+        -----
+        This method should be considered "protected": it is intended for use by
+        derived classes, not users.
+        """
+        if centers is not None:
+            try:
+                with traceSpan(plugin.name, "pluginCatalog"):
+                    plugin.measureCatalog(measCat, exposure, centers)
+                return
+            except FATAL_EXCEPTIONS:
+                raise
+            except Exception as error:
+                self.log.getChild(plugin.name).debug(
+                    "Exception in %s.measureCatalog on %d records; measuring them individually: %s",
+                    plugin.name, len(measCat), error)
+        for i, measRecord in enumerate(measCat):
+            self.doMeasurement(plugin, measRecord, exposure, *(arg[i] for arg in args))
+
+    @staticmethod
+    def getCatalogCenters(catalog):
+        """Get the centroid slot positions of all sources in a catalog.
+
+        Parameters
+        ----------
+        catalog : `lsst.afw.table.SourceCatalog`
+            Catalog with a valid centroid slot.
+
+        Returns
+        -------
+        centers : `numpy.ndarray`
+            Array of shape ``(len(catalog), 2)`` of the ``(x, y)`` centroid
+            of each source.
+        """
+        centers = np.empty((len(catalog), 2), dtype=np.float64)
+        if catalog.isContiguous():
+            centers[:, 0] = catalog.getX()
+            centers[:, 1] = catalog.getY()
+        else:
+            for i, record in enumerate(catalog):
+                centers[i] = (record.getX(), record.getY())
+        return centers
+
     @staticmethod
     def getFootprintsFromCatalog(catalog):
         """Get a set of footprints from a catalog, keyed by id.
@@ -67,6 +67,8 @@ PyBlendenessAlgorithm declareBlendednessAlgorithm(lsst::cpputils::python::Wrappe
         cls.def_static("computeAbsBias", &BlendednessAlgorithm::computeAbsBias, "mu"_a, "variance"_a);
         cls.def("measureChildPixels", &BlendednessAlgorithm::measureChildPixels, "image"_a, "child"_a);
         cls.def("measureParentPixels", &BlendednessAlgorithm::measureParentPixels, "image"_a, "child"_a);
+        cls.def("measureCatalogParentPixels", &BlendednessAlgorithm::measureCatalogParentPixels, "image"_a,
+                "catalog"_a, "nThreads"_a = 1, py::call_guard<py::gil_scoped_release>());
         cls.def("measure", &BlendednessAlgorithm::measure, "measRecord"_a, "exposure"_a);
         cls.def("fail", &BlendednessAlgorithm::measure, "measRecord"_a, "error"_a = nullptr);
     });
@@ -29,6 +29,7 @@ from lsst.utils.timer import timeMethod
 from .pluginsBase import BasePlugin, BasePluginConfig
 from .pluginRegistry import PluginRegistry, PluginMap
 from ._measBaseLib import FatalAlgorithmError, MeasurementError
+from .tracing import traceSpan
 
 # Exceptions that the measurement tasks should always propagate up to their
 # callers
@@ -252,10 +253,11 @@ class CatalogCalculationTask(lsst.pipe.base.Task):
         for runlevel in sorted(self.executionDict):
             # Run all of the plugins which take a whole catalog first
             for plug in self.executionDict[runlevel].multi:
-                with CCContext(plug, catalog, self.log):
+                with traceSpan(plug.name, "catalogCalculation"), CCContext(plug, catalog, self.log):
                     plug.calculate(catalog)
             # Run all the plugins which take single catalog entries
-            for measRecord in catalog:
-                for plug in self.executionDict[runlevel].single:
-                    with CCContext(plug, measRecord, self.log):
-                        plug.calculate(measRecord)
+            with traceSpan("single-record plugins", "catalogCalculation", runlevel=runlevel):
+                for measRecord in catalog:
+                    for plug in self.executionDict[runlevel].single:
+                        with CCContext(plug, measRecord, self.log):
+                            plug.calculate(measRecord)
@@ -24,6 +24,7 @@
 
 import numpy as np
 
+import lsst.afw.table
 import lsst.pex.config
 from .catalogCalculation import CatalogCalculationPluginConfig, CatalogCalculationPlugin
 from .pluginRegistry import register
@@ -61,10 +62,15 @@ class CatalogCalculationClassificationPlugin(CatalogCalculationPlugin):
     To do this, plot the difference between the PSF magnitude and the model
     magnitude vs. the PSF magnitude, and look for where the cloud of galaxies
     begins.
+
+    This plugin operates on whole catalogs, classifying contiguous catalogs
+    with column arithmetic, but `calculate` also accepts a single record.
     """
 
     ConfigClass = CatalogCalculationClassificationConfig
 
+    plugType = "multi"
+
     @classmethod
     def getExecutionOrder(cls):
         return cls.DEFAULT_CATALOGCALCULATION
@@ -75,7 +81,40 @@ class CatalogCalculationClassificationPlugin(CatalogCalculationPlugin):
                                               doc="Set to 1 for extended sources, 0 for point sources.")
         self.keyFlag = schema.addField(name + "_flag", type="Flag", doc="Set to 1 for any fatal failure.")
 
-    def calculate(self, measRecord):
+    def calculate(self, cat):
+        if isinstance(cat, lsst.afw.table.BaseRecord):
+            self._calculateRecord(cat)
+        elif not cat.isContiguous():
+            for measRecord in cat:
+                self._calculateRecord(measRecord)
+        else:
+            self._calculateCatalog(cat)
+
+    def _calculateCatalog(self, catalog):
+        """Classify all sources in a contiguous catalog.
+        """
+        modelSlot = catalog.getTable().getModelFluxSlot()
+        psfSlot = catalog.getTable().getPsfFluxSlot()
+        flux1 = self.config.fluxRatio*catalog[modelSlot.getMeasKey()]
+        if self.config.modelErrFactor != 0:
+            flux1 = flux1 + self.config.modelErrFactor*catalog[modelSlot.getErrKey()]
+        flux2 = catalog[psfSlot.getMeasKey()]
+        if not self.config.psfErrFactor == 0:
+            flux2 = flux2 + self.config.psfErrFactor*catalog[psfSlot.getErrKey()]
+
+        # Failures are as for _calculateRecord.
+        failed = np.isnan(flux1) | np.isnan(flux2)
+        if modelSlot.isValid():
+            failed |= catalog[modelSlot.getFlagKey()]
+        if psfSlot.isValid():
+            failed |= catalog[psfSlot.getFlagKey()]
+        catalog[self.keyProbability] = np.where(failed, catalog[self.keyProbability],
+                                                np.where(flux1 < flux2, 0.0, 1.0))
+        catalog[self.keyFlag] = catalog[self.keyFlag] | failed
+
+    def _calculateRecord(self, measRecord):
+        """Classify a single source.
+        """
         modelFlux = measRecord.getModelInstFlux()
         psfFlux = measRecord.getPsfInstFlux()
         modelFluxFlag = (measRecord.getModelFluxFlag()
@@ -101,4 +140,8 @@ class CatalogCalculationClassificationPlugin(CatalogCalculationPlugin):
             measRecord.set(self.keyProbability, 0.0 if flux1 < flux2 else 1.0)
 
     def fail(self, measRecord, error=None):
-        measRecord.set(self.keyFlag, True)
+        if isinstance(measRecord, lsst.afw.table.BaseRecord):
+            measRecord.set(self.keyFlag, True)
+        else:
+            for record in measRecord:
+                record.set(self.keyFlag, True)
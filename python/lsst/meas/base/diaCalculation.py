@@ -20,6 +20,7 @@
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
 from collections import namedtuple
+
 import numpy as np
 import pandas as pd
 
@@ -28,8 +29,10 @@ from .catalogCalculation import (CatalogCalculationPluginConfig,
                                  CatalogCalculationConfig,
                                  CatalogCalculationTask,
                                  CCContext)
+from .diaSegments import DiaSourceSegments
 from .pluginsBase import BasePlugin
 from .pluginRegistry import (PluginRegistry, PluginMap)
+import lsst.pex.config
 import lsst.pipe.base
 from lsst.utils.timer import timeMethod
 
@@ -103,6 +106,13 @@ class DiaObjectCalculationPlugin(CatalogCalculationPlugin):
     common across all observations/detections such as position.
     """
 
+    needsTimeSeries = False
+    """Whether this ``"multi"`` plugin accepts a ``timeSeriesCache`` keyword
+    argument, through which light curves prepared with
+    `~lsst.meas.base.diaSegments.TimeSeries.fromGroupBy` are shared with
+    other plugins (`bool`).
+    """
+
     def __init__(self, config, name, metadata):
         BasePlugin.__init__(self, config, name)
 
@@ -391,17 +401,29 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
 
         updatingDiaSources = diaSourceCat.loc[updatedDiaObjectIds, :]
         diaSourcesGB = updatingDiaSources.groupby(level=0)
+        timeSeriesCache = {}
         self._run_all_plugins(updatedDiaObjectIds,
                               diaObjectsToUpdate,
                               updatingDiaSources,
                               diaSourcesGB,
-                              None)
+                              None,
+                              timeSeriesCache=timeSeriesCache)
+
+        # Partition the DiaSources by band once, rather than slicing the
+        # MultiIndex in every band pass.
+        bandDiaSources = dict(iter(updatingDiaSources.groupby(level=1, sort=False)))
         for band in filterNames:
+            if band not in bandDiaSources:
+                self.log.warning("No DiaSource data with fitler=%s. "
+                                 "Continuing...", band)
+                continue
             self._run_all_plugins(updatedDiaObjectIds,
                                   diaObjectsToUpdate,
                                   updatingDiaSources,
                                   diaSourcesGB,
-                                  band)
+                                  band,
+                                  bandDiaSources[band],
+                                  timeSeriesCache=timeSeriesCache)
         # Need to store the newly updated diaObjects directly as the editing
         # a view into diaObjectsToUpdate does not update the values of
         # diaObjectCat.
@@ -410,12 +432,123 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
             diaObjectCat=diaObjectCat,
             updatedDiaObjects=diaObjectsToUpdate)
 
+    @timeMethod
+    def runColumnar(self,
+                    diaObjectCat,
+                    diaSourceCat,
+                    updatedDiaObjectIds,
+                    filterNames):
+        """Compute summaries for the updated DiaObjects from column-oriented
+        catalogs.
+
+        This is an alternative to `run` that does not index or modify its
+        inputs.  DiaSources are located with offset arrays computed from their
+        sort order rather than with a `pandas.MultiIndex`, and only the rows
+        of the updated DiaObjects and their DiaSources are converted or
+        copied.
+
+        Parameters
+        ----------
+        diaObjectCat : `pyarrow.Table`, `numpy.ndarray`, or `pandas.DataFrame`
+            DiaObjects to update values of, with a ``diaObjectId`` column.
+            May be any table supporting column access by name and row
+            selection with ``take`` (Arrow), integer array indexing (numpy
+            structured arrays), or ``iloc`` (pandas).
+        diaSourceCat : `pyarrow.Table`, `numpy.ndarray`, or `pandas.DataFrame`
+            DiaSources associated with the DiaObjects in ``diaObjectCat``,
+            sorted by ``(diaObjectId, band)``.
+        updatedDiaObjectIds : `numpy.ndarray`
+            Integer ids of the DiaObjects to update.  All must be present in
+            ``diaObjectCat``.
+        filterNames : `list` of `str`
+            List of string names of filters to be being processed.
+
+        Returns
+        -------
+        returnStruct : `lsst.pipe.base.Struct`
+            Struct containing:
+
+            ``updatedDiaObjects``
+                The updated DiaObjects only, in the order of
+                ``updatedDiaObjectIds`` and of the same type as
+                ``diaObjectCat`` (`pandas.DataFrame` for other mappings).
+
+        Raises
+        ------
+        KeyError
+            Raised if an updated DiaObject is not in ``diaObjectCat``.
+        ValueError
+            Raised if ``diaSourceCat`` is not sorted.
+        """
+        updatedDiaObjectIds = np.asarray(updatedDiaObjectIds)
+        objectIds = np.asarray(diaObjectCat["diaObjectId"])
+        order = np.argsort(objectIds, kind="stable")
+        positions = np.searchsorted(objectIds, updatedDiaObjectIds, sorter=order)
+        found = positions < len(order)
+        objectRows = order[positions[found]]
+        found[found] = objectIds[objectRows] == updatedDiaObjectIds[found]
+        if not np.all(found):
+            raise KeyError(f"DiaObjects {updatedDiaObjectIds[~found]} are not in diaObjectCat.")
+        diaObjectsToUpdate = _toDataFrame(_takeRows(diaObjectCat, objectRows)).set_index(
+            "diaObjectId", drop=False)
+        self.log.info("Calculating summary stats for %i DiaObjects",
+                      len(diaObjectsToUpdate))
+
+        segments = DiaSourceSegments(diaSourceCat["diaObjectId"], diaSourceCat["band"])
+        segmentIndices = segments.find(updatedDiaObjectIds)
+        kept = np.unique(segmentIndices[segmentIndices >= 0])
+        if len(kept) < len(segments):
+            sourceRows = segments.rows(kept)
+            diaSourceCat = _takeRows(diaSourceCat, sourceRows)
+            segments = DiaSourceSegments(diaSourceCat["diaObjectId"], diaSourceCat["band"])
+            segmentIndices = segments.find(updatedDiaObjectIds)
+        diaSources = _toDataFrame(diaSourceCat)
+        diaSourcesGB = diaSources.groupby("diaObjectId", sort=False)
+        timeSeriesCache = {}
+
+        for band in [None] + list(filterNames):
+            if band:
+                bandRows = segments.bandRows(band)
+                if len(bandRows) == 0:
+                    self.log.warning("No DiaSource data with fitler=%s. "
+                                     "Continuing...", band)
+                    continue
+                filterDiaSourcesGB = diaSources.iloc[bandRows].groupby("diaObjectId", sort=False)
+            else:
+                filterDiaSourcesGB = None
+
+            def objectSources():
+                for updatedDiaObjectId, index in zip(updatedDiaObjectIds, segmentIndices):
+                    if index < 0:
+                        objDiaSources = diaSources.iloc[0:0]
+                    else:
+                        objDiaSources = diaSources.iloc[segments.objectSlice(index)]
+                    if band:
+                        rows = segments.bandSlice(index, band) if index >= 0 else slice(0, 0)
+                        if rows.stop == rows.start:
+                            self.log.warning(
+                                "DiaObjectId=%d has no DiaSources for filter=%s. "
+                                "Continuing...", updatedDiaObjectId, band)
+                            continue
+                        filterObjDiaSources = diaSources.iloc[rows]
+                    else:
+                        filterObjDiaSources = None
+                    yield updatedDiaObjectId, objDiaSources, filterObjDiaSources
+
+            self._run_plugins(diaObjectsToUpdate, diaSourcesGB, filterDiaSourcesGB, objectSources, band,
+                              timeSeriesCache)
+
+        return lsst.pipe.base.Struct(
+            updatedDiaObjects=_fromDataFrame(diaObjectsToUpdate, diaObjectCat))
+
     def _run_all_plugins(self,
                          updatedDiaObjectIds,
                          diaObjectsToUpdate,
                          updatingDiaSources,
                          diaSourcesGB,
-                         band):
+                         band,
+                         updatingFilterDiaSources=None,
+                         timeSeriesCache=None):
         """Run each of the plugins on specific data and band.
 
         All catalogs are modified in-place.
@@ -434,8 +567,13 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
             A copy of ``updatingDiaSources`` grouped by diaObjectId.
         band : `str` or `None`
             The filter to process, or `None` to run filter-agnostic plugins.
+        updatingFilterDiaSources : `pandas.DataFrame`, optional
+            The subset of ``updatingDiaSources`` observed in ``band``, if
+            already selected.
+        timeSeriesCache : `dict`, optional
+            Cache of light curves shared by plugins that need them.
         """
-        if band:
+        if band and updatingFilterDiaSources is None:
             try:
                 updatingFilterDiaSources = updatingDiaSources.loc[
                     (slice(None), band), :
@@ -444,11 +582,61 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
                 self.log.warning("No DiaSource data with fitler=%s. "
                                  "Continuing...", band)
                 return
+        if band:
             # Level=0 here groups by diaObjectId.
             filterDiaSourcesGB = updatingFilterDiaSources.groupby(level=0)
         else:
             filterDiaSourcesGB = None
 
+        def objectSources():
+            for updatedDiaObjectId in updatedDiaObjectIds:
+                # Sub-select diaSources associated with this diaObject.
+                objDiaSources = updatingDiaSources.loc[updatedDiaObjectId]
+
+                # Sub-select on diaSources observed in the current filter.
+                if band:
+                    try:
+                        filterObjDiaSources = objDiaSources.loc[band]
+                    except KeyError:
+                        self.log.warning(
+                            "DiaObjectId=%d has no DiaSources for filter=%s. "
+                            "Continuing...", updatedDiaObjectId, band)
+                        continue
+                else:
+                    filterObjDiaSources = None
+                yield updatedDiaObjectId, objDiaSources, filterObjDiaSources
+
+        self._run_plugins(diaObjectsToUpdate, diaSourcesGB, filterDiaSourcesGB, objectSources, band,
+                          timeSeriesCache)
+
+    def _run_plugins(self,
+                     diaObjectsToUpdate,
+                     diaSourcesGB,
+                     filterDiaSourcesGB,
+                     objectSources,
+                     band,
+                     timeSeriesCache=None):
+        """Run each of the plugins on already-selected data for one band.
+
+        Parameters
+        ----------
+        diaObjectsToUpdate : `pandas.DataFrame`
+            DiaObjects to update values of, indexed on "diaObjectId".
+        diaSourcesGB : `pandas.core.groupby.DataFrameGroupBy`
+            DiaSources of ``diaObjectsToUpdate`` grouped by diaObjectId.
+        filterDiaSourcesGB : `pandas.core.groupby.DataFrameGroupBy` or `None`
+            DiaSources observed in ``band`` grouped by diaObjectId, or `None`
+            if ``band`` is `None`.
+        objectSources : callable
+            Function returning an iterable of ``(diaObjectId, diaSources,
+            filterDiaSources)`` for each DiaObject, for single-object
+            plugins.
+        band : `str` or `None`
+            The filter to process, or `None` to run filter-agnostic plugins.
+        timeSeriesCache : `dict`, optional
+            Cache of light curves passed to plugins with ``needsTimeSeries``
+            set, so that they are only prepared once.
+        """
         log_band = "band " + band if band else "no band"
         for runlevel in sorted(self.executionDict):
             for plug in self.executionDict[runlevel].single:
@@ -456,22 +644,7 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
                     continue
                 self.log.verbose("Running plugin %s on %s.", plug.name, log_band)
 
-                for updatedDiaObjectId in updatedDiaObjectIds:
-                    # Sub-select diaSources associated with this diaObject.
-                    objDiaSources = updatingDiaSources.loc[updatedDiaObjectId]
-
-                    # Sub-select on diaSources observed in the current filter.
-                    if band:
-                        try:
-                            filterObjDiaSources = objDiaSources.loc[band]
-                        except KeyError:
-                            self.log.warning(
-                                "DiaObjectId={updatedDiaObjectId} has no "
-                                "DiaSources for filter=%s. "
-                                "Continuing...", band)
-                            continue
-                    else:
-                        filterObjDiaSources = None
+                for updatedDiaObjectId, objDiaSources, filterObjDiaSources in objectSources():
                     with CCContext(plug, updatedDiaObjectId, self.log):
                         # We feed the catalog we need to update and the id
                         # so as to get a few into the catalog and not a copy.
@@ -485,11 +658,13 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
                 if plug.needsFilter ^ bool(band):
                     continue
                 self.log.verbose("Running plugin %s on %s.", plug.name, log_band)
+                extraArgs = {"timeSeriesCache": timeSeriesCache} if plug.needsTimeSeries else {}
                 with CCContext(plug, diaObjectsToUpdate, self.log):
                     plug.calculate(diaObjects=diaObjectsToUpdate,
                                    diaSources=diaSourcesGB,
                                    filterDiaSources=filterDiaSourcesGB,
-                                   band=band)
+                                   band=band,
+                                   **extraArgs)
 
     def _initialize_dia_object(self, objId):
         """Create a new DiaObject with values required to be initialized by the
@@ -527,3 +702,76 @@ class DiaObjectCalculationTask(CatalogCalculationTask):
         for f in ["u", "g", "r", "i", "z", "y"]:
             new_dia_object["%s_psfFluxNdata" % f] = 0
         return new_dia_object
+
+
+def _takeRows(table, rows):
+    """Select rows of a table by position, without converting it.
+
+    Parameters
+    ----------
+    table : `pyarrow.Table`, `numpy.ndarray`, `pandas.DataFrame` or `dict`
+        Table to select from.
+    rows : `numpy.ndarray`
+        Integer positions of the rows to select.
+
+    Returns
+    -------
+    selected
+        Selected rows, of the same type as ``table`` (`dict` of
+        `numpy.ndarray` for other mappings of columns).
+    """
+    if isinstance(table, pd.DataFrame):
+        return table.iloc[rows]
+    if isinstance(table, np.ndarray):
+        return table[rows]
+    if hasattr(table, "take"):
+        return table.take(rows)
+    return {name: np.asarray(column)[rows] for name, column in table.items()}
+
+
+def _toDataFrame(table):
+    """Convert a table to a `pandas.DataFrame` with a positional index.
+
+    Parameters
+    ----------
+    table : `pyarrow.Table`, `numpy.ndarray`, `pandas.DataFrame` or `dict`
+        Table to convert.
+
+    Returns
+    -------
+    frame : `pandas.DataFrame`
+        Converted table; ``table`` itself if it is already a DataFrame whose
+        index does not shadow any of its columns.
+    """
+    if isinstance(table, pd.DataFrame):
+        if any(name in table.columns for name in table.index.names if name is not None):
+            return table.reset_index(drop=True)
+        return table
+    if hasattr(table, "to_pandas"):
+        return table.to_pandas()
+    return pd.DataFrame(table)
+
+
+def _fromDataFrame(frame, like):
+    """Convert a `pandas.DataFrame` to the table type of another table.
+
+    Parameters
+    ----------
+    frame : `pandas.DataFrame`
+        Table to convert.
+    like : `pyarrow.Table`, `numpy.ndarray`, `pandas.DataFrame` or `dict`
+        Table whose type to convert to.
+
+    Returns
+    -------
+    table
+        Converted table; ``frame`` unless ``like`` is an Arrow table or a
+        numpy structured array.
+    """
+    if isinstance(like, pd.DataFrame):
+        return frame
+    if isinstance(like, np.ndarray):
+        return frame.to_records(index=False)
+    if hasattr(type(like), "from_pandas"):
+        return type(like).from_pandas(frame, preserve_index=False)
+    return frame
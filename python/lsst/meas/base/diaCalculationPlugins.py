@@ -28,19 +28,18 @@ as defined in the schema of the Apdb both in name and units.
 import functools
 import warnings
 
-from astropy.stats import median_absolute_deviation
 import numpy as np
 import pandas as pd
-from scipy.optimize import lsq_linear
 
 import lsst.geom as geom
 import lsst.pex.config as pexConfig
-import lsst.sphgeom as sphgeom
 from astropy.timeseries import LombScargle
 from astropy.timeseries import LombScargleMultiband
 import math
 import statistics
 
+from ._measBaseLib import computeHtmIndices, computeSegmentMads, computeSegmentPercentiles
+from .diaSegments import Segments, TimeSeries
 from .diaCalculation import (
     DiaObjectCalculationPluginConfig,
     DiaObjectCalculationPlugin)
@@ -132,6 +131,7 @@ class LombScarglePeriodogram(DiaObjectCalculationPlugin):
     plugType = "multi"
     outputCols = ["period", "power"]
     needsFilter = True
+    needsTimeSeries = True
 
     @classmethod
     def getExecutionOrder(cls):
@@ -142,7 +142,8 @@ class LombScarglePeriodogram(DiaObjectCalculationPlugin):
                   diaObjects,
                   diaSources,
                   filterDiaSources,
-                  band):
+                  band,
+                  timeSeriesCache=None):
         """Compute the periodogram.
 
         Parameters
@@ -151,6 +152,13 @@ class LombScarglePeriodogram(DiaObjectCalculationPlugin):
             Summary objects to store values in.
         diaSources : `pandas.DataFrame` or `pandas.DataFrameGroupBy`
             Catalog of DiaSources summarized by this DiaObject.
+        filterDiaSources : `pandas.DataFrameGroupBy`
+            DiaSources observed in ``band``, grouped by DiaObject.
+        band : `str`
+            Simple, string name of the filter for the period being
+            calculated.
+        timeSeriesCache : `dict`, optional
+            Cache of light curves shared with other plugins.
         """
 
         # Check and initialize output columns in diaObjects.
@@ -159,13 +167,18 @@ class LombScarglePeriodogram(DiaObjectCalculationPlugin):
         if (powerCol := f"{band}_power") not in diaObjects.columns:
             diaObjects[powerCol] = np.nan
 
-        def _calculate_period(df, min_detections=5, nterms=1, oversampling_factor=5, nyquist_factor=100):
-            """Compute the Lomb-Scargle periodogram given a set of DiaSources.
+        def _calculate_period(time, flux, flux_err, min_detections=5, nterms=1, oversampling_factor=5,
+                              nyquist_factor=100):
+            """Compute the Lomb-Scargle periodogram of a light curve.
 
             Parameters
             ----------
-            df : `pandas.DataFrame`
-                The input DataFrame.
+            time : `numpy.ndarray`
+                The times of the non-NaN fluxes.
+            flux : `numpy.ndarray`
+                The non-NaN fluxes.
+            flux_err : `numpy.ndarray`
+                The errors on the fluxes.
             min_detections : `int`, optional
                 The minimum number of detections.
             nterms : `int`, optional
@@ -177,18 +190,11 @@ class LombScarglePeriodogram(DiaObjectCalculationPlugin):
 
             Returns
             -------
-            pd_tab : `pandas.Series`
-                The output DataFrame with the Lomb-Scargle parameters.
+            period, power : `float`
+                The period and power of the periodogram peak.
             """
-            tmpDf = df[~np.logical_or(np.isnan(df["psfFlux"]),
-                                      np.isnan(df["midpointMjdTai"]))]
-
-            if len(tmpDf) < min_detections:
-                return pd.Series({periodCol: np.nan, powerCol: np.nan})
-
-            time = tmpDf["midpointMjdTai"].to_numpy()
-            flux = tmpDf["psfFlux"].to_numpy()
-            flux_err = tmpDf["psfFluxErr"].to_numpy()
+            if len(time) < min_detections:
+                return np.nan, np.nan
 
             lsp = LombScargle(time, flux, dy=flux_err, nterms=nterms)
             f_grid = compute_optimized_periodogram_grid(
@@ -196,11 +202,17 @@ class LombScarglePeriodogram(DiaObjectCalculationPlugin):
             period = 1/f_grid
             power = lsp.power(f_grid)
 
-            return pd.Series({periodCol: period[np.argmax(power)],
-                              powerCol: np.max(power)})
+            return period[np.argmax(power)], np.max(power)
+
+        timeSeries = TimeSeries.fromGroupBy(filterDiaSources, cache=timeSeriesCache)
+        results = np.full((len(timeSeries), 2), np.nan)
+        for i, (begin, end) in enumerate(zip(timeSeries.offsets[:-1], timeSeries.offsets[1:])):
+            results[i] = _calculate_period(timeSeries.times[begin:end],
+                                           timeSeries.fluxes[begin:end],
+                                           timeSeries.errors[begin:end])
 
         diaObjects.loc[:, [periodCol, powerCol]
-                       ] = filterDiaSources.apply(_calculate_period)
+                       ] = pd.DataFrame(results, index=timeSeries.keys, columns=[periodCol, powerCol])
 
 
 class LombScarglePeriodogramMultiConfig(DiaObjectCalculationPluginConfig):
@@ -217,6 +229,7 @@ class LombScarglePeriodogramMulti(DiaObjectCalculationPlugin):
     outputCols = ["multiPeriod", "multiPower",
                   "multiFap", "multiAmp", "multiPhase"]
     needsFilter = True
+    needsTimeSeries = True
 
     @classmethod
     def getExecutionOrder(cls):
@@ -303,6 +316,7 @@ class LombScarglePeriodogramMulti(DiaObjectCalculationPlugin):
     def calculate(self,
                   diaObjects,
                   diaSources,
+                  timeSeriesCache=None,
                   **kwargs):
         """Compute the multi-band LombScargle periodogram of a DiaObject given
         a set of DiaSources.
@@ -313,6 +327,8 @@ class LombScarglePeriodogramMulti(DiaObjectCalculationPlugin):
             Summary objects to store values in.
         diaSources : `pandas.DataFrame` or `pandas.DataFrameGroupBy`
             Catalog of DiaSources summarized by this DiaObject.
+        timeSeriesCache : `dict`, optional
+            Cache of light curves shared with other plugins.
         **kwargs : `dict`
             Unused kwargs that are always passed to a plugin.
         """
@@ -329,13 +345,20 @@ class LombScarglePeriodogramMulti(DiaObjectCalculationPlugin):
         if (phaseCol := "multiPhase") not in diaObjects.columns:
             diaObjects[phaseCol] = pd.Series([np.nan]*n_bands, dtype="object")
 
-        def _calculate_period_multi(df, min_detections=9, oversampling_factor=5, nyquist_factor=100):
+        def _calculate_period_multi(time, flux, flux_err, bands, min_detections=9, oversampling_factor=5,
+                                    nyquist_factor=100):
             """Calculate the multi-band Lomb-Scargle periodogram.
 
             Parameters
             ----------
-            df : `pandas.DataFrame`
-                The input DataFrame.
+            time : `numpy.ndarray`
+                The times of the non-NaN fluxes.
+            flux : `numpy.ndarray`
+                The non-NaN fluxes.
+            flux_err : `numpy.ndarray`
+                The errors on the fluxes.
+            bands : `numpy.ndarray`
+                The band of each flux.
             min_detections : `int`, optional
                 The minimum number of detections, including all bands.
             oversampling_factor : `int`, optional
@@ -345,23 +368,14 @@ class LombScarglePeriodogramMulti(DiaObjectCalculationPlugin):
 
             Returns
             -------
-            pd_tab : `pandas.Series`
-                The output DataFrame with the Lomb-Scargle parameters.
+            params : `tuple`
+                The period, power, false-alarm probability, amplitudes and
+                phases of the periodogram peak.
             """
-            tmpDf = df[~np.logical_or(np.isnan(df["psfFlux"]),
-                                      np.isnan(df["midpointMjdTai"]))]
-
-            if (len(tmpDf)) < min_detections:
-                return pd.Series({periodCol: np.nan,
-                                  powerCol: np.nan,
-                                  fapCol: np.nan,
-                                  ampCol: pd.Series([np.nan]*n_bands, dtype="object"),
-                                  phaseCol: pd.Series([np.nan]*n_bands, dtype="object")})
-
-            time = tmpDf["midpointMjdTai"].to_numpy()
-            flux = tmpDf["psfFlux"].to_numpy()
-            flux_err = tmpDf["psfFluxErr"].to_numpy()
-            bands = tmpDf["band"].to_numpy()
+            if len(time) < min_detections:
+                return (np.nan, np.nan, np.nan,
+                        pd.Series([np.nan]*n_bands, dtype="object"),
+                        pd.Series([np.nan]*n_bands, dtype="object"))
 
             lsp = LombScargleMultiband(time, flux, bands, dy=flux_err,
                                        nterms_base=1, nterms_band=1)
@@ -376,17 +390,25 @@ class LombScarglePeriodogramMulti(DiaObjectCalculationPlugin):
 
             params_table_new = self.generate_lsp_params(lsp, f_grid[np.argmax(power)], bands)
 
-            pd_tab = pd.Series({periodCol: period[np.argmax(power)],
-                                powerCol: np.max(power),
-                                fapCol: fap_estimate,
-                                ampCol: params_table_new[0],
-                                phaseCol: params_table_new[1]
-                                })
+            return (period[np.argmax(power)], np.max(power), fap_estimate,
+                    params_table_new[0], params_table_new[1])
 
-            return pd_tab
+        timeSeries = TimeSeries.fromGroupBy(diaSources, cache=timeSeriesCache)
+        bands = timeSeries.gather("band")
+        results = np.full((len(timeSeries), 3), np.nan)
+        amps = np.empty(len(timeSeries), dtype=object)
+        phases = np.empty(len(timeSeries), dtype=object)
+        for i, (begin, end) in enumerate(zip(timeSeries.offsets[:-1], timeSeries.offsets[1:])):
+            period, power, fap, amps[i], phases[i] = _calculate_period_multi(timeSeries.times[begin:end],
+                                                                             timeSeries.fluxes[begin:end],
+                                                                             timeSeries.errors[begin:end],
+                                                                             bands[begin:end])
+            results[i] = period, power, fap
 
-        diaObjects.loc[:, [periodCol, powerCol, fapCol, ampCol, phaseCol]
-                       ] = diaSources.apply(_calculate_period_multi)
+        df = pd.DataFrame(results, index=timeSeries.keys, columns=[periodCol, powerCol, fapCol])
+        df[ampCol] = pd.Series(amps, index=timeSeries.keys, dtype="object")
+        df[phaseCol] = pd.Series(phases, index=timeSeries.keys, dtype="object")
+        diaObjects.loc[:, [periodCol, powerCol, fapCol, ampCol, phaseCol]] = df
 
 
 class MeanDiaPositionConfig(DiaObjectCalculationPluginConfig):
@@ -452,11 +474,16 @@ class HTMIndexDiaPositionConfig(DiaObjectCalculationPluginConfig):
         doc="Level of the HTM pixelization.",
         default=20,
     )
+    numThreads = pexConfig.Field(
+        dtype=int,
+        doc="Number of threads used to compute HTM indices; 0 for one per hardware thread.",
+        default=1,
+    )
 
 
 @register("ap_HTMIndex")
 class HTMIndexDiaPosition(DiaObjectCalculationPlugin):
-    """Compute the mean position of a DiaObject given a set of DiaSources.
+    """Compute the HTM index of the position of each DiaObject.
 
     Notes
     -----
@@ -467,37 +494,29 @@ class HTMIndexDiaPosition(DiaObjectCalculationPlugin):
     """
     ConfigClass = HTMIndexDiaPositionConfig
 
-    plugType = 'single'
+    plugType = 'multi'
 
     inputCols = ["ra", "dec"]
     outputCols = ["pixelId"]
     needsFilter = False
 
-    def __init__(self, config, name, metadata):
-        DiaObjectCalculationPlugin.__init__(self, config, name, metadata)
-        self.pixelator = sphgeom.HtmPixelization(self.config.htmLevel)
-
     @classmethod
     def getExecutionOrder(cls):
         return cls.FLUX_MOMENTS_CALCULATED
 
-    def calculate(self, diaObjects, diaObjectId, **kwargs):
-        """Compute the mean position of a DiaObject given a set of DiaSources
+    def calculate(self, diaObjects, **kwargs):
+        """Compute the HTM index of the position of every DiaObject.
 
         Parameters
         ----------
-        diaObjects : `pandas.dataFrame`
+        diaObjects : `pandas.DataFrame`
             Summary objects to store values in and read ra/dec from.
-        diaObjectId : `int`
-            Id of the diaObject to update.
         **kwargs
             Any additional keyword arguments that may be passed to the plugin.
         """
-        sphPoint = geom.SpherePoint(
-            diaObjects.at[diaObjectId, "ra"] * geom.degrees,
-            diaObjects.at[diaObjectId, "dec"] * geom.degrees)
-        diaObjects.at[diaObjectId, "pixelId"] = self.pixelator.index(
-            sphPoint.getVector())
+        diaObjects["pixelId"] = computeHtmIndices(diaObjects["ra"].to_numpy(dtype=np.float64),
+                                                  diaObjects["dec"].to_numpy(dtype=np.float64),
+                                                  self.config.htmLevel, self.config.numThreads)
 
 
 class NumDiaSourcesDiaPluginConfig(DiaObjectCalculationPluginConfig):
@@ -653,6 +672,11 @@ class PercentileDiaPsfFluxConfig(DiaObjectCalculationPluginConfig):
         doc="Percentiles to calculate to compute values for. Should be "
             "integer values."
     )
+    numThreads = pexConfig.Field(
+        dtype=int,
+        doc="Number of threads used to compute percentiles; 0 for one per hardware thread.",
+        default=1,
+    )
 
 
 @register("ap_percentileFlux")
@@ -679,7 +703,6 @@ class PercentileDiaPsfFlux(DiaObjectCalculationPlugin):
     def getExecutionOrder(cls):
         return cls.DEFAULT_CATALOGCALCULATION
 
-    @catchWarnings(warns=["All-NaN slice encountered"])
     def calculate(self,
                   diaObjects,
                   diaSources,
@@ -714,15 +737,16 @@ class PercentileDiaPsfFlux(DiaObjectCalculationPlugin):
             elif dtype is None:
                 dtype = diaObjects[pTileName].dtype
 
-        def _fluxPercentiles(df):
-            pTiles = np.nanpercentile(df["psfFlux"], self.config.percentiles)
-            return pd.Series(
-                dict((tileName, pTile)
-                     for tileName, pTile in zip(pTileNames, pTiles)))
+        segments = Segments.fromGroupBy(filterDiaSources)
+        pTiles = computeSegmentPercentiles(np.asarray(segments.gather("psfFlux"), dtype=np.float64),
+                                           segments.offsets,
+                                           np.array(self.config.percentiles, dtype=np.float64),
+                                           self.config.numThreads)
+        df = pd.DataFrame(pTiles, index=segments.keys, columns=pTileNames)
         if dtype is None:
-            diaObjects.loc[:, pTileNames] = filterDiaSources.apply(_fluxPercentiles)
+            diaObjects.loc[:, pTileNames] = df
         else:
-            diaObjects.loc[:, pTileNames] = filterDiaSources.apply(_fluxPercentiles).astype(dtype)
+            diaObjects.loc[:, pTileNames] = df.astype(dtype)
 
 
 class SigmaDiaPsfFluxConfig(DiaObjectCalculationPluginConfig):
@@ -839,7 +863,11 @@ class Chi2DiaPsfFlux(DiaObjectCalculationPlugin):
 
 
 class MadDiaPsfFluxConfig(DiaObjectCalculationPluginConfig):
-    pass
+    numThreads = pexConfig.Field(
+        dtype=int,
+        doc="Number of threads used to compute deviations; 0 for one per hardware thread.",
+        default=1,
+    )
 
 
 @register("ap_madFlux")
@@ -859,7 +887,6 @@ class MadDiaPsfFlux(DiaObjectCalculationPlugin):
     def getExecutionOrder(cls):
         return cls.DEFAULT_CATALOGCALCULATION
 
-    @catchWarnings(warns=["All-NaN slice encountered"])
     def calculate(self,
                   diaObjects,
                   diaSources,
@@ -883,16 +910,17 @@ class MadDiaPsfFlux(DiaObjectCalculationPlugin):
         **kwargs
             Any additional keyword arguments that may be passed to the plugin.
         """
+        segments = Segments.fromGroupBy(filterDiaSources)
+        mads = segments.toSeries(
+            computeSegmentMads(np.asarray(segments.gather("psfFlux"), dtype=np.float64),
+                               segments.offsets,
+                               self.config.numThreads))
         column = "{}_psfFluxMAD".format(band)
         if column in diaObjects:
             dtype = diaObjects[column].dtype
-            diaObjects.loc[:, column] = \
-                filterDiaSources.psfFlux.apply(median_absolute_deviation,
-                                               ignore_nan=True).astype(dtype)
+            diaObjects.loc[:, column] = mads.astype(dtype)
         else:
-            diaObjects.loc[:, column] = \
-                filterDiaSources.psfFlux.apply(median_absolute_deviation,
-                                               ignore_nan=True)
+            diaObjects.loc[:, column] = mads
 
 
 class SkewDiaPsfFluxConfig(DiaObjectCalculationPluginConfig):
@@ -1019,6 +1047,7 @@ class MaxSlopeDiaPsfFlux(DiaObjectCalculationPlugin):
     outputCols = ["psfFluxMaxSlope"]
     plugType = "multi"
     needsFilter = True
+    needsTimeSeries = True
 
     @classmethod
     def getExecutionOrder(cls):
@@ -1029,6 +1058,7 @@ class MaxSlopeDiaPsfFlux(DiaObjectCalculationPlugin):
                   diaSources,
                   filterDiaSources,
                   band,
+                  timeSeriesCache=None,
                   **kwargs):
         """Compute the maximum ratio time ordered deltaFlux / deltaTime.
 
@@ -1044,27 +1074,29 @@ class MaxSlopeDiaPsfFlux(DiaObjectCalculationPlugin):
             diaObject that are observed in the band pass ``band``.
         band : `str`
             Simple, string name of the filter for the flux being calculated.
+        timeSeriesCache : `dict`, optional
+            Cache of light curves shared with other plugins.
         **kwargs
             Any additional keyword arguments that may be passed to the plugin.
         """
 
-        def _maxSlope(df):
-            tmpDf = df[~np.logical_or(np.isnan(df["psfFlux"]),
-                                      np.isnan(df["midpointMjdTai"]))]
-            if len(tmpDf) < 2:
-                return np.nan
-            times = tmpDf["midpointMjdTai"].to_numpy()
-            timeArgs = times.argsort()
-            times = times[timeArgs]
-            fluxes = tmpDf["psfFlux"].to_numpy()[timeArgs]
-            return (np.diff(fluxes) / np.diff(times)).max()
+        timeSeries = TimeSeries.fromGroupBy(filterDiaSources, cache=timeSeriesCache)
+        ids = timeSeries.segmentIds
+        # Slopes between consecutive sources of the same DiaObject.
+        samePair = ids[1:] == ids[:-1]
+        with np.errstate(divide="ignore", invalid="ignore"):
+            slopes = np.diff(timeSeries.fluxes)[samePair] / np.diff(timeSeries.times)[samePair]
+        maxSlopes = np.full(len(timeSeries), -np.inf)
+        np.maximum.at(maxSlopes, ids[1:][samePair], slopes)
+        maxSlopes[timeSeries.sizes < 2] = np.nan
+        maxSlopes = timeSeries.toSeries(maxSlopes)
 
         column = "{}_psfFluxMaxSlope".format(band)
         if column in diaObjects:
             dtype = diaObjects[column].dtype
-            diaObjects.loc[:, column] = filterDiaSources.apply(_maxSlope).astype(dtype)
+            diaObjects.loc[:, column] = maxSlopes.astype(dtype)
         else:
-            diaObjects.loc[:, column] = filterDiaSources.apply(_maxSlope)
+            diaObjects.loc[:, column] = maxSlopes
 
 
 class ErrMeanDiaPsfFluxConfig(DiaObjectCalculationPluginConfig):
@@ -1135,6 +1167,7 @@ class LinearFitDiaPsfFlux(DiaObjectCalculationPlugin):
     outputCols = ["psfFluxLinearSlope", "psfFluxLinearIntercept"]
     plugType = "multi"
     needsFilter = True
+    needsTimeSeries = True
 
     @classmethod
     def getExecutionOrder(cls):
@@ -1145,6 +1178,7 @@ class LinearFitDiaPsfFlux(DiaObjectCalculationPlugin):
                   diaSources,
                   filterDiaSources,
                   band,
+                  timeSeriesCache=None,
                   **kwargs):
         """Compute fit a linear model to flux vs time.
 
@@ -1160,6 +1194,8 @@ class LinearFitDiaPsfFlux(DiaObjectCalculationPlugin):
             diaObject that are observed in the band pass ``band``.
         band : `str`
             Simple, string name of the filter for the flux being calculated.
+        timeSeriesCache : `dict`, optional
+            Cache of light curves shared with other plugins.
         **kwargs
             Any additional keyword arguments that may be passed to the plugin.
         """
@@ -1172,21 +1208,46 @@ class LinearFitDiaPsfFlux(DiaObjectCalculationPlugin):
             diaObjects[bName] = np.nan
         dtype = diaObjects[mName].dtype
 
-        def _linearFit(df):
-            tmpDf = df[~np.logical_or(
-                np.isnan(df["psfFlux"]),
-                np.logical_or(np.isnan(df["psfFluxErr"]),
-                              np.isnan(df["midpointMjdTai"])))]
-            if len(tmpDf) < 2:
-                return pd.Series({mName: np.nan, bName: np.nan})
-            fluxes = tmpDf["psfFlux"].to_numpy()
-            errors = tmpDf["psfFluxErr"].to_numpy()
-            times = tmpDf["midpointMjdTai"].to_numpy()
-            A = np.array([times / errors, 1 / errors]).transpose()
-            m, b = lsq_linear(A, fluxes / errors).x
-            return pd.Series({mName: m, bName: b}, dtype=dtype)
+        timeSeries = TimeSeries.fromGroupBy(filterDiaSources, cache=timeSeriesCache)
+        timeSeries = timeSeries.select(~np.isnan(timeSeries.errors))
+        slopes, intercepts = self._linearFit(timeSeries)
+        df = pd.DataFrame({mName: slopes, bName: intercepts}, index=timeSeries.keys, dtype=dtype)
+        diaObjects.loc[:, [mName, bName]] = df
+
+    @staticmethod
+    def _linearFit(timeSeries):
+        """Fit a straight line to each light curve by weighted least squares.
+
+        Parameters
+        ----------
+        timeSeries : `lsst.meas.base.diaSegments.TimeSeries`
+            Light curves to fit; all errors must be non-NaN.
 
-        diaObjects.loc[:, [mName, bName]] = filterDiaSources.apply(_linearFit)
+        Returns
+        -------
+        slopes, intercepts : `numpy.ndarray`
+            Slope and intercept of the fit to each light curve; NaN for light
+            curves with fewer than two distinct times.
+        """
+        nPoints = timeSeries.sizes
+        weights = 1/timeSeries.errors**2
+        # Fit about the mean time of each light curve for numerical
+        # stability, as MJDs are large compared to their range.
+        with np.errstate(divide="ignore", invalid="ignore"):
+            meanTimes = timeSeries.sum(timeSeries.times) / nPoints
+        times = timeSeries.times - meanTimes[timeSeries.segmentIds]
+        fluxes = timeSeries.fluxes
+        sumW = timeSeries.sum(weights)
+        sumT = timeSeries.sum(weights*times)
+        sumF = timeSeries.sum(weights*fluxes)
+        sumTT = timeSeries.sum(weights*times**2)
+        sumTF = timeSeries.sum(weights*times*fluxes)
+        det = sumW*sumTT - sumT**2
+        good = (nPoints >= 2) & (det > 0)
+        with np.errstate(divide="ignore", invalid="ignore"):
+            slopes = np.where(good, (sumW*sumTF - sumT*sumF) / det, np.nan)
+            intercepts = np.where(good, (sumTT*sumF - sumT*sumTF) / det - slopes*meanTimes, np.nan)
+        return slopes, intercepts
 
 
 class StetsonJDiaPsfFluxConfig(DiaObjectCalculationPluginConfig):
@@ -1236,25 +1297,85 @@ class StetsonJDiaPsfFlux(DiaObjectCalculationPlugin):
         """
         meanName = "{}_psfFluxMean".format(band)
 
-        def _stetsonJ(df):
-            tmpDf = df[~np.logical_or(np.isnan(df["psfFlux"]),
-                                      np.isnan(df["psfFluxErr"]))]
-            if len(tmpDf) < 2:
-                return np.nan
-            fluxes = tmpDf["psfFlux"].to_numpy()
-            errors = tmpDf["psfFluxErr"].to_numpy()
-
-            return self._stetson_J(
-                fluxes,
-                errors,
-                diaObjects.at[tmpDf.diaObjectId.iat[0], meanName])
+        segments = Segments.fromGroupBy(filterDiaSources)
+        fluxes = segments.gather("psfFlux")
+        errors = segments.gather("psfFluxErr")
+        valid = ~np.logical_or(np.isnan(fluxes), np.isnan(errors))
+        segments = segments.select(valid)
+        means = diaObjects[meanName].reindex(segments.keys).to_numpy(dtype=np.float64)
+        stetsonJ = self._stetson_J_segments(segments, fluxes[valid], errors[valid], means)
 
         column = "{}_psfFluxStetsonJ".format(band)
         if column in diaObjects:
             dtype = diaObjects[column].dtype
-            diaObjects.loc[:, column] = filterDiaSources.apply(_stetsonJ).astype(dtype)
+            diaObjects.loc[:, column] = segments.toSeries(stetsonJ).astype(dtype)
         else:
-            diaObjects.loc[:, column] = filterDiaSources.apply(_stetsonJ)
+            diaObjects.loc[:, column] = segments.toSeries(stetsonJ)
+
+    def _stetson_J_segments(self, segments, fluxes, errors, means, alpha=2., beta=2., n_iter=20,
+                            tol=1e-6):
+        """Compute the single band stetsonJ statistic of many lightcurves at
+        once.
+
+        The results are equal, to rounding, to calling `_stetson_J` on each
+        segment, but the iterative mean is run for all segments
+        simultaneously, only updating segments that have not yet converged.
+        The sums are accumulated with `numpy.bincount` rather than
+        `numpy.average`, so they are added in a different order.
+
+        Parameters
+        ----------
+        segments : `lsst.meas.base.diaSegments.Segments`
+            Segmentation of ``fluxes`` and ``errors`` into lightcurves.
+        fluxes : `numpy.ndarray` (N,)
+            Calibrated lightcurve flux values, in segment order.
+        errors : `numpy.ndarray` (N,)
+            Errors on the calibrated lightcurve fluxes.
+        means : `numpy.ndarray` (M,)
+            Starting mean of each segment.
+        alpha, beta, n_iter, tol
+            Parameters of the iterative mean; see `_stetson_mean`.
+
+        Returns
+        -------
+        stetsonJ : `numpy.ndarray` (M,)
+            stetsonJ statistic for each segment; NaN for segments with fewer
+            than two points.
+        """
+        nPoints = segments.sizes
+        use = nPoints >= 2
+        with np.errstate(divide="ignore", invalid="ignore"):
+            nFactor = np.sqrt(nPoints / (nPoints - 1))
+        ids = segments.segmentIds
+        nFactorPoints = nFactor[ids]
+        invVar = 1 / errors ** 2
+        mean = np.where(use, means, np.nan)
+
+        # Iterate only over the points of segments that have not converged.
+        active = use.copy()
+        points = np.flatnonzero(active[ids])
+        for iter_idx in range(n_iter):
+            if len(points) == 0:
+                break
+            pointIds = ids[points]
+            chi = np.fabs(nFactorPoints[points] * (fluxes[points] - mean[pointIds]) / errors[points])
+            weights = invVar[points] / (1 + (chi / alpha) ** beta)
+            sumWeights = np.bincount(pointIds, weights=weights, minlength=len(segments))
+            sumValues = np.bincount(pointIds, weights=weights * fluxes[points], minlength=len(segments))
+            with np.errstate(divide="ignore", invalid="ignore"):
+                tmpMean = sumValues / sumWeights
+                diff = np.fabs(tmpMean - mean)
+                mean = np.where(active, tmpMean, mean)
+                converged = active & (diff / mean < tol) & (diff < tol)
+            if converged.any():
+                active &= ~converged
+                points = points[active[pointIds]]
+
+        deltaVal = nFactorPoints * (fluxes - mean[ids]) / errors
+        pK = deltaVal ** 2 - 1
+        with np.errstate(divide="ignore", invalid="ignore"):
+            stetsonJ = segments.sum(np.sign(pK) * np.sqrt(np.fabs(pK))) / nPoints
+        return np.where(use, stetsonJ, np.nan)
 
     def _stetson_J(self, fluxes, errors, mean=None):
         """Compute the single band stetsonJ statistic.
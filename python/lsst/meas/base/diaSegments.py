@@ -0,0 +1,384 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Segmented (CSR-style) access to DiaSource columns, for computing
+per-DiaObject summaries with whole-array operations.
+"""
+
+__all__ = ("Segments", "DiaSourceSegments", "TimeSeries")
+
+import functools
+
+import numpy as np
+import pandas as pd
+
+
+class Segments:
+    """A partition of the rows of a table into contiguous segments, one per
+    group.
+
+    Column values are gathered into flat arrays in which the rows of each
+    group are contiguous, with group ``i`` occupying elements
+    ``offsets[i]:offsets[i + 1]``.  Per-group reductions can then be computed
+    for all groups at once.
+
+    Parameters
+    ----------
+    keys : `pandas.Index`
+        Key of each group (e.g. ``diaObjectId``).
+    offsets : `numpy.ndarray`
+        Array of ``len(keys) + 1`` offsets of the start of each segment.
+    frame : `pandas.DataFrame`
+        Table the segment elements are drawn from.
+    rows : `numpy.ndarray` or `None`
+        Positional index into ``frame`` of each segment element, or `None`
+        if the elements are the rows of ``frame`` in order.
+    """
+
+    def __init__(self, keys, offsets, frame, rows=None):
+        self.keys = keys
+        self.offsets = offsets
+        self._frame = frame
+        self._rows = rows
+
+    @classmethod
+    def fromGroupBy(cls, groups):
+        """Construct from a grouped DataFrame.
+
+        Parameters
+        ----------
+        groups : `pandas.core.groupby.DataFrameGroupBy`
+            Grouped table; segments are in the order of the group keys.
+
+        Returns
+        -------
+        segments : `Segments`
+            Segmentation of the rows of ``groups.obj``.
+        """
+        codes = groups.ngroup().to_numpy()
+        counts = np.bincount(codes, minlength=groups.ngroups)
+        offsets = np.zeros(len(counts) + 1, dtype=np.int64)
+        np.cumsum(counts, out=offsets[1:])
+        if len(codes) > 1 and np.any(codes[1:] < codes[:-1]):
+            rows = np.argsort(codes, kind="stable")
+        else:
+            rows = None
+        return cls(groups.size().index, offsets, groups.obj, rows)
+
+    def __len__(self):
+        return len(self.keys)
+
+    @property
+    def sizes(self):
+        """Number of elements in each segment (`numpy.ndarray`)."""
+        return np.diff(self.offsets)
+
+    @functools.cached_property
+    def segmentIds(self):
+        """Index of the segment each element belongs to
+        (`numpy.ndarray`).
+        """
+        return np.repeat(np.arange(len(self.keys)), self.sizes)
+
+    def gather(self, column):
+        """Return the values of a column in segment order.
+
+        Parameters
+        ----------
+        column : `str`
+            Name of the column.
+
+        Returns
+        -------
+        values : `numpy.ndarray`
+            Column values; a view of the column if no reordering is needed.
+        """
+        values = self._frame[column].to_numpy()
+        if self._rows is None:
+            return values
+        return values[self._rows]
+
+    def select(self, mask):
+        """Return segments containing only some of the elements.
+
+        Parameters
+        ----------
+        mask : `numpy.ndarray`
+            Boolean array, in segment order, of the elements to keep.
+
+        Returns
+        -------
+        segments : `Segments`
+            Segments with the same keys (some may now be empty).
+        """
+        counts = np.bincount(self.segmentIds[mask], minlength=len(self.keys))
+        offsets = np.zeros(len(counts) + 1, dtype=np.int64)
+        np.cumsum(counts, out=offsets[1:])
+        rows = np.flatnonzero(mask) if self._rows is None else self._rows[mask]
+        return Segments(self.keys, offsets, self._frame, rows)
+
+    def sum(self, values):
+        """Sum an array of element values over each segment.
+
+        Parameters
+        ----------
+        values : `numpy.ndarray`
+            Values in segment order.
+
+        Returns
+        -------
+        sums : `numpy.ndarray`
+            Sum over each segment; zero for empty segments.
+        """
+        return np.bincount(self.segmentIds, weights=values, minlength=len(self.keys))
+
+    def toSeries(self, values):
+        """Wrap per-segment values in a Series indexed by the group keys.
+
+        Parameters
+        ----------
+        values : `numpy.ndarray`
+            One value per segment.
+
+        Returns
+        -------
+        series : `pandas.Series`
+            Values indexed by ``keys``.
+        """
+        return pd.Series(values, index=self.keys)
+
+
+class TimeSeries(Segments):
+    """Per-DiaObject light curves, sorted by time, in segmented arrays.
+
+    DiaSources with a NaN time or flux are dropped, and the times, fluxes and
+    flux errors of the rest are gathered once so that several plugins can
+    share them.  Flux errors may still be NaN.
+
+    Parameters
+    ----------
+    keys, offsets, frame, rows
+        As for `Segments`.
+    times : `numpy.ndarray`
+        ``midpointMjdTai`` of each element.
+    fluxes : `numpy.ndarray`
+        Flux of each element.
+    errors : `numpy.ndarray`
+        Flux error of each element.
+    """
+
+    def __init__(self, keys, offsets, frame, rows, times, fluxes, errors):
+        super().__init__(keys, offsets, frame, rows)
+        self.times = times
+        self.fluxes = fluxes
+        self.errors = errors
+
+    @classmethod
+    def fromGroupBy(cls, groups, fluxColumn="psfFlux", cache=None):
+        """Construct from a grouped DataFrame of DiaSources.
+
+        Parameters
+        ----------
+        groups : `pandas.core.groupby.DataFrameGroupBy`
+            DiaSources grouped by DiaObject.
+        fluxColumn : `str`, optional
+            Name of the flux column; its error column is assumed to be
+            ``fluxColumn + "Err"``.
+        cache : `dict`, optional
+            Cache of time series already constructed from grouped tables,
+            which is checked and updated.
+
+        Returns
+        -------
+        timeSeries : `TimeSeries`
+            Light curves of each group.
+        """
+        if cache is not None:
+            cached = cache.get((id(groups), fluxColumn))
+            if cached is not None and cached[0] is groups:
+                return cached[1]
+        segments = Segments.fromGroupBy(groups)
+        times = segments.gather("midpointMjdTai")
+        fluxes = segments.gather(fluxColumn)
+        valid = ~np.logical_or(np.isnan(times), np.isnan(fluxes))
+        segments = segments.select(valid)
+        # Sort by time within each segment; the sort is stable so the order
+        # of simultaneous sources is kept.
+        order = np.lexsort((times[valid], segments.segmentIds))
+        rows = segments._rows[order]
+        timeSeries = cls(segments.keys, segments.offsets, segments._frame, rows,
+                         times[valid][order].astype(np.float64),
+                         fluxes[valid][order].astype(np.float64),
+                         segments.gather(fluxColumn + "Err")[order].astype(np.float64))
+        if cache is not None:
+            # Keep a reference to the groups so their id is not reused.
+            cache[(id(groups), fluxColumn)] = (groups, timeSeries)
+        return timeSeries
+
+    def select(self, mask):
+        """Return a time series containing only some of the elements.
+
+        Parameters
+        ----------
+        mask : `numpy.ndarray`
+            Boolean array, in segment order, of the elements to keep.
+
+        Returns
+        -------
+        timeSeries : `TimeSeries`
+            Time series with the same keys (some may now be empty).
+        """
+        segments = super().select(mask)
+        return TimeSeries(segments.keys, segments.offsets, segments._frame, segments._rows,
+                          self.times[mask], self.fluxes[mask], self.errors[mask])
+
+
+class DiaSourceSegments:
+    """Offsets of the DiaSources of each DiaObject, and of each band within
+    them, in a table sorted by ``(diaObjectId, band)``.
+
+    Parameters
+    ----------
+    diaObjectIds : `numpy.ndarray`
+        ``diaObjectId`` of each DiaSource, in ascending order.
+    bands : `numpy.ndarray`
+        ``band`` of each DiaSource, in ascending order within each DiaObject.
+
+    Raises
+    ------
+    ValueError
+        Raised if the DiaSources are not sorted.
+    """
+
+    def __init__(self, diaObjectIds, bands):
+        diaObjectIds = np.asarray(diaObjectIds)
+        bands = np.asarray(bands)
+        nSources = len(diaObjectIds)
+        sameObject = diaObjectIds[1:] == diaObjectIds[:-1]
+        if (np.any(diaObjectIds[1:] < diaObjectIds[:-1])
+                or np.any(bands[1:][sameObject] < bands[:-1][sameObject])):
+            raise ValueError("DiaSources must be sorted by (diaObjectId, band).")
+        if nSources == 0:
+            self.offsets = np.zeros(1, dtype=np.int64)
+        else:
+            starts = np.flatnonzero(~sameObject) + 1
+            self.offsets = np.concatenate(([0], starts, [nSources])).astype(np.int64)
+        self.diaObjectIds = diaObjectIds[self.offsets[:-1]]
+        self._bands = bands
+        self._bandRows = {}
+        self._bandOffsets = {}
+
+    def __len__(self):
+        return len(self.diaObjectIds)
+
+    def find(self, diaObjectIds):
+        """Find the segments of a set of DiaObjects.
+
+        Parameters
+        ----------
+        diaObjectIds : `numpy.ndarray`
+            DiaObject IDs to look up.
+
+        Returns
+        -------
+        indices : `numpy.ndarray`
+            Index of the segment of each DiaObject, or -1 for DiaObjects
+            with no DiaSources.
+        """
+        indices = np.searchsorted(self.diaObjectIds, diaObjectIds)
+        found = indices < len(self.diaObjectIds)
+        found[found] = self.diaObjectIds[indices[found]] == np.asarray(diaObjectIds)[found]
+        return np.where(found, indices, -1)
+
+    def rows(self, indices):
+        """Return the rows of a subset of the segments.
+
+        Parameters
+        ----------
+        indices : `numpy.ndarray`
+            Indices of the segments, in ascending order.
+
+        Returns
+        -------
+        rows : `numpy.ndarray`
+            Row numbers of all DiaSources in the given segments, in order.
+        """
+        begins = self.offsets[indices]
+        sizes = self.offsets[np.asarray(indices) + 1] - begins
+        shifts = begins - (np.cumsum(sizes) - sizes)
+        return np.arange(sizes.sum()) + np.repeat(shifts, sizes)
+
+    def objectSlice(self, index):
+        """Return the rows of the DiaSources of one DiaObject.
+
+        Parameters
+        ----------
+        index : `int`
+            Index of the segment of the DiaObject.
+
+        Returns
+        -------
+        rows : `slice`
+            Slice of the rows of the DiaObject's DiaSources.
+        """
+        return slice(self.offsets[index], self.offsets[index + 1])
+
+    def bandRows(self, band):
+        """Return the rows of all DiaSources observed in a band.
+
+        Parameters
+        ----------
+        band : `str`
+            Name of the band.
+
+        Returns
+        -------
+        rows : `numpy.ndarray`
+            Row numbers of the DiaSources, in ascending order.
+        """
+        if band not in self._bandRows:
+            rows = np.flatnonzero(self._bands == band)
+            self._bandRows[band] = rows
+            self._bandOffsets[band] = np.searchsorted(rows, self.offsets)
+        return self._bandRows[band]
+
+    def bandSlice(self, index, band):
+        """Return the rows of the DiaSources of one DiaObject observed in a
+        band.
+
+        Parameters
+        ----------
+        index : `int`
+            Index of the segment of the DiaObject.
+        band : `str`
+            Name of the band.
+
+        Returns
+        -------
+        rows : `slice`
+            Slice of the rows of the DiaSources; empty if the DiaObject has
+            none in ``band``.
+        """
+        rows = self.bandRows(band)
+        begin, end = self._bandOffsets[band][index:index + 2]
+        if begin == end:
+            return slice(0, 0)
+        return slice(rows[begin], rows[begin] + end - begin)
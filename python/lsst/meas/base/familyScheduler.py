@@ -0,0 +1,200 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Cost-based scheduling of deblend families during measurement.
+"""
+
+__all__ = ("FamilySchedulerConfig", "FamilyScheduler")
+
+import time
+
+import numpy as np
+
+import lsst.pex.config
+
+
+class FamilySchedulerConfig(lsst.pex.config.Config):
+    """Configuration for `FamilyScheduler`.
+    """
+
+    orderByCost = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc="Measure families in decreasing order of predicted cost, rather than in catalog order?",
+    )
+    doRecordCosts = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc="Record summary statistics of the predicted and measured (thread CPU time) costs of the "
+            "families in the task metadata, for tuning the cost model.",
+    )
+    perSourceCost = lsst.pex.config.Field(
+        dtype=float,
+        default=1.0,
+        doc="Predicted cost of running one plugin on one source, independent of its size.",
+    )
+    perPixelCost = lsst.pex.config.Field(
+        dtype=float,
+        default=0.01,
+        doc="Predicted additional cost of running one plugin on one source, per Footprint pixel.",
+    )
+    pluginCostFactors = lsst.pex.config.DictField(
+        keytype=str,
+        itemtype=float,
+        default={},
+        doc="Multiplicative cost factors for individual plugins, by name; unlisted plugins have a "
+            "factor of 1.",
+    )
+
+
+class FamilyScheduler:
+    """Predict the cost of measuring deblend families, measure them in order
+    of decreasing predicted cost, and record how long they took.
+
+    Parameters
+    ----------
+    config : `FamilySchedulerConfig`
+        Configuration for the scheduler.
+    log : `logging.Logger`, optional
+        Logger for progress and diagnostics.
+
+    Notes
+    -----
+    Families are measured one at a time on the calling thread: plugins run
+    Python code under the global interpreter lock and share the exposure's
+    Psf caches, so measuring families on several threads would not be
+    faster, and would not be safe.  The scheduler is instead a tool for
+    ordering families and for comparing predicted with measured costs, with
+    which the cost model (and the cost of individual plugins) can be tuned.
+    """
+
+    PREDICTED_TOTAL_KEY = "familyCostPredictedTotal"
+    """Task metadata key for the total predicted cost of all families
+    (`float`)."""
+
+    ACTUAL_TOTAL_KEY = "familyCostActualTotal"
+    """Task metadata key for the total measured cost, in thread CPU seconds,
+    of all families (`float`)."""
+
+    ACTUAL_MAX_KEY = "familyCostActualMax"
+    """Task metadata key for the measured cost, in thread CPU seconds, of the
+    most expensive family (`float`)."""
+
+    SCALE_KEY = "familyCostScale"
+    """Task metadata key for the ratio of total measured to total predicted
+    cost (`float`)."""
+
+    CORRELATION_KEY = "familyCostCorrelation"
+    """Task metadata key for the correlation coefficient of predicted and
+    measured costs (`float`)."""
+
+    def __init__(self, config, log=None):
+        self.config = config
+        self.log = log
+
+    def predictCosts(self, parentCat, childCats, plugins, pluginsN=()):
+        """Predict the relative cost of measuring each family.
+
+        Parameters
+        ----------
+        parentCat : `lsst.afw.table.SourceCatalog`
+            Catalog of parent records, one per family.
+        childCats : iterable of `lsst.afw.table.SourceCatalog`
+            Children of each parent, in the same order.
+        plugins : iterable of `BasePlugin`
+            Plugins that will be run on each source individually.
+        pluginsN : iterable of `BasePlugin`, optional
+            Plugins that will be run on each family as a whole.
+
+        Returns
+        -------
+        costs : `numpy.ndarray`
+            Predicted cost of each family, in arbitrary units.
+        """
+        factors = self.config.pluginCostFactors
+        weight = sum(factors.get(plugin.name, 1.0) for plugin in plugins)
+        weight += sum(factors.get(plugin.name, 1.0) for plugin in pluginsN)
+        costs = np.zeros(len(parentCat), dtype=float)
+        for i, (parent, children) in enumerate(zip(parentCat, childCats)):
+            area = 0
+            for record in (parent, *children):
+                footprint = record.getFootprint()
+                if footprint is not None:
+                    area += footprint.getArea()
+            nSources = 1 + len(children)
+            costs[i] = weight*(self.config.perSourceCost*nSources + self.config.perPixelCost*area)
+        return costs
+
+    def run(self, func, costs):
+        """Call ``func(i)`` for each family index ``i``.
+
+        Parameters
+        ----------
+        func : callable
+            Function that measures the family with the given index.
+        costs : `numpy.ndarray`
+            Predicted cost of each family (see `predictCosts`); only used if
+            ``config.orderByCost`` is set.
+
+        Returns
+        -------
+        actual : `numpy.ndarray`
+            Thread CPU time, in seconds, spent in each call to ``func``.
+        """
+        nFamilies = len(costs)
+        actual = np.zeros(nFamilies, dtype=float)
+        if self.config.orderByCost:
+            order = np.argsort(-costs, kind="stable")
+        else:
+            order = range(nFamilies)
+        for i in order:
+            start = time.thread_time()
+            func(i)
+            actual[i] = time.thread_time() - start
+        return actual
+
+    def recordCosts(self, metadata, predicted, actual):
+        """Record summary statistics of predicted and measured family costs.
+
+        Parameters
+        ----------
+        metadata : `lsst.pipe.base.TaskMetadata`
+            Metadata to record to.
+        predicted : `numpy.ndarray`
+            Predicted cost of each family.
+        actual : `numpy.ndarray`
+            Measured cost of each family.
+        """
+        totalPredicted = predicted.sum()
+        totalActual = actual.sum()
+        scale = totalActual/totalPredicted if totalPredicted > 0 else np.nan
+        if len(predicted) > 1 and predicted.std() > 0 and actual.std() > 0:
+            correlation = np.corrcoef(predicted, actual)[0, 1]
+        else:
+            correlation = np.nan
+        metadata[self.PREDICTED_TOTAL_KEY] = float(totalPredicted)
+        metadata[self.ACTUAL_TOTAL_KEY] = float(totalActual)
+        metadata[self.ACTUAL_MAX_KEY] = float(actual.max()) if len(actual) > 0 else 0.0
+        metadata[self.SCALE_KEY] = float(scale)
+        metadata[self.CORRELATION_KEY] = float(correlation)
+        if self.log is not None:
+            self.log.verbose("Family cost model: %.3g s per unit predicted cost; correlation %.3f over %d "
+                             "families", scale, correlation, len(predicted))
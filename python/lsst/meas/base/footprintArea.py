@@ -21,6 +21,9 @@
 
 import numpy as np
 
+import lsst.afw.table
+
+from ._measBaseLib import computeFootprintAreas
 from .catalogCalculation import (CatalogCalculationPluginConfig,
                                  CatalogCalculationPlugin)
 from .pluginRegistry import register
@@ -41,10 +44,17 @@ class CatalogCalculationFootprintAreaConfig(CatalogCalculationPluginConfig):
 @register("base_FootprintArea")
 class CatalogCalculationFootprintAreaPlugin(CatalogCalculationPlugin):
     """Catalog calculation plugin to record the area of a source's footprint.
+
+    Notes
+    -----
+    This plugin operates on whole catalogs, computing all areas in a single
+    C++ call, but `calculate` also accepts a single record.
     """
 
     ConfigClass = CatalogCalculationFootprintAreaConfig
 
+    plugType = "multi"
+
     @classmethod
     def getExecutionOrder(cls):
         return cls.DEFAULT_CATALOGCALCULATION
@@ -58,8 +68,16 @@ class CatalogCalculationFootprintAreaPlugin(CatalogCalculationPlugin):
             units="pixel"
         )
 
-    def calculate(self, measRecord):
-        measRecord.set(self.key, measRecord.getFootprint().getArea())
+    def calculate(self, cat):
+        if isinstance(cat, lsst.afw.table.BaseRecord):
+            cat.set(self.key, cat.getFootprint().getArea())
+            return
+        areas = computeFootprintAreas(cat)
+        if cat.isContiguous():
+            cat[self.key] = areas
+        else:
+            for record, area in zip(cat, areas):
+                record.set(self.key, area)
 
     def fail(self, measRecord, error=None):
         # Should be impossible for this algorithm to fail unless there is no
@@ -0,0 +1,61 @@
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
+#include "ndarray/pybind11.h"
+#include "lsst/cpputils/python.h"
+
+#include <vector>
+
+#include "lsst/meas/base/FootprintIndex.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+void wrapFootprintIndex(lsst::cpputils::python::WrapperCollection &wrappers) {
+    using PyFootprintIndex = py::class_<FootprintIndex, std::shared_ptr<FootprintIndex>>;
+    wrappers.wrapType(PyFootprintIndex(wrappers.module, "FootprintIndex"), [](auto &mod, auto &cls) {
+        cls.attr("DEFAULT_NODE_CAPACITY") = py::int_(FootprintIndex::DEFAULT_NODE_CAPACITY);
+        cls.def(py::init<afw::table::SourceCatalog const &, int>(), "catalog"_a,
+                "nodeCapacity"_a = FootprintIndex::DEFAULT_NODE_CAPACITY);
+        cls.def(py::init<std::vector<geom::Box2I> const &, int>(), "boxes"_a,
+                "nodeCapacity"_a = FootprintIndex::DEFAULT_NODE_CAPACITY);
+        cls.def("__len__", &FootprintIndex::size);
+        cls.def("getInputSize", &FootprintIndex::getInputSize);
+        cls.def("getBBox", py::overload_cast<std::size_t>(&FootprintIndex::getBBox, py::const_), "i"_a);
+        cls.def("getBBox", py::overload_cast<>(&FootprintIndex::getBBox, py::const_));
+        cls.def("getDepth", &FootprintIndex::getDepth);
+        cls.def("query", &FootprintIndex::query, "region"_a);
+        cls.def("queryNeighbors", &FootprintIndex::queryNeighbors, "i"_a);
+        cls.def("computeOverlapGroups", &FootprintIndex::computeOverlapGroups);
+    });
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
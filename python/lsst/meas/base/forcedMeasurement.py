@@ -54,16 +54,24 @@ Command-line driver tasks for forced measurement include
 `ForcedPhotCcdTask`, and `ForcedPhotCoaddTask`.
 """
 
+import functools
+
+import numpy as np
+
+import lsst.afw.geom
+import lsst.geom
 import lsst.pex.config
 import lsst.pipe.base
 from lsst.utils.logging import PeriodicLogger
 
 from .pluginRegistry import PluginRegistry
 from .baseMeasurement import (BaseMeasurementPluginConfig, BaseMeasurementPlugin,
-                              BaseMeasurementConfig, BaseMeasurementTask)
+                              BaseMeasurementConfig, BaseMeasurementTask, FATAL_EXCEPTIONS)
 from .noiseReplacer import NoiseReplacer, DummyNoiseReplacer
+from .memoryAccounting import getFootprintDictBytes, getSincCoeffsBytes
+from .tracing import traceSpan
 
-__all__ = ("ForcedPluginConfig", "ForcedPlugin",
+__all__ = ("ForcedPluginConfig", "ForcedPlugin", "ReferenceTransforms", "computeCoordCentroids",
            "ForcedMeasurementConfig", "ForcedMeasurementTask")
 
 
@@ -166,6 +174,132 @@ class ForcedPlugin(BaseMeasurementPlugin):
         """
         raise NotImplementedError()
 
+    usesReferenceTransforms = False
+    """Whether this plugin implements `measureTransformed` (`bool`).
+    """
+
+    def measureTransformed(self, measCat, refCat, transforms):
+        """Measure all sources at once from reference quantities transformed
+        to the measurement frame.
+
+        Plugins that only transform reference positions or shapes (and so
+        need no pixel data) may implement this, and set
+        `usesReferenceTransforms`, to be run once for the whole catalog
+        before any per-source measurement.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog of all sources being measured, updated in place.
+        refCat : `lsst.afw.table.SourceCatalog`
+            Reference catalog, in the same order as ``measCat``.
+        transforms : `ReferenceTransforms`
+            Reference positions and local linear transforms in the pixel
+            frame of the image being measured.
+        """
+        raise NotImplementedError()
+
+
+class ReferenceTransforms:
+    """Positions and local linear transforms of reference sources in the
+    pixel frame of an image being measured, computed for all sources at once.
+
+    Parameters
+    ----------
+    refCat : `lsst.afw.table.SourceCatalog`
+        Reference catalog.
+    refWcs : `lsst.afw.geom.SkyWcs`
+        Coordinate system of the ``refCat`` centroids and shapes.
+    targetWcs : `lsst.afw.geom.SkyWcs`
+        Coordinate system of the image being measured.
+
+    Notes
+    -----
+    Each quantity is computed when it is first used, with a single batched
+    call to the WCS transforms.  Local linear transforms are estimated by
+    central differences over one reference pixel.
+    """
+
+    _offsets = np.array([[0.0, 0.0], [1.0, 0.0], [-1.0, 0.0], [0.0, 1.0], [0.0, -1.0]])
+
+    def __init__(self, refCat, refWcs, targetWcs):
+        self._refCat = refCat
+        self._refWcs = refWcs
+        self._targetWcs = targetWcs
+        self.isIdentity = refWcs is not None and refWcs == targetWcs
+
+    def __len__(self):
+        return len(self._refCat)
+
+    @functools.cached_property
+    def refCentroids(self):
+        """Centroid slot positions of the reference sources in the reference
+        frame (`numpy.ndarray`, shape ``(N, 2)``).
+        """
+        return BaseMeasurementTask.getCatalogCenters(self._refCat)
+
+    @functools.cached_property
+    def _transformedCentroids(self):
+        nPoints = len(self)
+        if self.isIdentity:
+            return self.refCentroids.copy(), np.tile(np.identity(2), (nPoints, 1, 1))
+        points = (self.refCentroids[np.newaxis, :, :] + self._offsets[:, np.newaxis, :]).reshape(-1, 2)
+        transform = lsst.afw.geom.makeWcsPairTransform(self._refWcs, self._targetWcs)
+        result = transform.applyForward(np.ascontiguousarray(points.T))
+        result = np.asarray(result).T.reshape(len(self._offsets), nPoints, 2)
+        jacobians = np.empty((nPoints, 2, 2))
+        jacobians[:, :, 0] = 0.5*(result[1] - result[2])
+        jacobians[:, :, 1] = 0.5*(result[3] - result[4])
+        return result[0], jacobians
+
+    @property
+    def centroids(self):
+        """Reference centroids transformed to the measurement frame
+        (`numpy.ndarray`, shape ``(N, 2)``).
+        """
+        return self._transformedCentroids[0]
+
+    @property
+    def jacobians(self):
+        """Local linear transforms from the reference frame to the
+        measurement frame at each reference centroid (`numpy.ndarray`, shape
+        ``(N, 2, 2)``).
+        """
+        return self._transformedCentroids[1]
+
+    @functools.cached_property
+    def coordCentroids(self):
+        """Reference coordinates transformed to the measurement frame
+        (`numpy.ndarray`, shape ``(N, 2)``).
+        """
+        return computeCoordCentroids(self._refCat, self._targetWcs)
+
+
+def computeCoordCentroids(catalog, wcs):
+    """Transform the coordinates of all records in a catalog to pixel
+    positions with a single call to the WCS.
+
+    Parameters
+    ----------
+    catalog : `lsst.afw.table.SourceCatalog`
+        Catalog whose ``coord`` fields are to be transformed.
+    wcs : `lsst.afw.geom.SkyWcs`
+        Coordinate system of the pixel frame.
+
+    Returns
+    -------
+    centroids : `numpy.ndarray`, shape ``(N, 2)``
+        Pixel positions of the records, in catalog order.
+    """
+    if catalog.isContiguous():
+        ra = np.asarray(catalog["coord_ra"], dtype=np.float64)
+        dec = np.asarray(catalog["coord_dec"], dtype=np.float64)
+    else:
+        ra = np.array([record.getCoord().getRa().asRadians() for record in catalog])
+        dec = np.array([record.getCoord().getDec().asRadians() for record in catalog])
+    x, y = wcs.skyToPixelArray(ra, dec, degrees=False)
+    return np.stack((x, y), axis=1)
+
 
 class ForcedMeasurementConfig(BaseMeasurementConfig):
     """Config class for forced measurement driver task.
@@ -201,6 +335,12 @@ class ForcedMeasurementConfig(BaseMeasurementConfig):
         dtype=str,
         default="raise",
     )
+    doTransformReferences = lsst.pex.config.Field(
+        dtype=bool,
+        default=True,
+        doc="Transform reference positions and shapes to the measurement frame for all sources at once, "
+            "before per-source measurement, for plugins that support it?",
+    )
 
     def setDefaults(self):
         self.slots.centroid = "base_TransformedCentroid"
@@ -332,16 +472,17 @@ class ForcedMeasurementTask(BaseMeasurementTask):
         # (i.e. getting the footprint from the transformed source footprint)
         footprints = {ref.getId(): (ref.getParent(), measRecord.getFootprint())
                       for (ref, measRecord) in zip(refCat, measCat)}
+        self.memory.record("footprints", footprints=lambda: getFootprintDictBytes(footprints))
 
         self.log.info("Performing forced measurement on %d source%s", len(refCat),
                       "" if len(refCat) == 1 else "s")
 
-        # Wrap the task logger into a periodic logger.
-        periodicLog = PeriodicLogger(self.log)
-
         if self.config.doReplaceWithNoise:
-            noiseReplacer = NoiseReplacer(self.config.noiseReplacer, exposure,
-                                          footprints, log=self.log, exposureId=exposureId)
+            with traceSpan("NoiseReplacer setup", "noiseReplacer", nSources=lambda: len(footprints)):
+                noiseReplacer = NoiseReplacer(self.config.noiseReplacer, exposure,
+                                              footprints, log=self.log, exposureId=exposureId)
+            if self.memory.enabled:
+                self.memory.record("noiseReplacer", **noiseReplacer.getMemoryUsage())
             algMetadata = measCat.getTable().getMetadata()
             if algMetadata is not None:
                 algMetadata.addInt("NOISE_SEED_MULTIPLIER", self.config.noiseReplacer.noiseSeedMultiplier)
@@ -352,10 +493,50 @@ class ForcedMeasurementTask(BaseMeasurementTask):
         else:
             noiseReplacer = DummyNoiseReplacer()
 
+        with traceSpan("ForcedMeasurementTask.run", "task", exposureId=exposureId,
+                       nSources=lambda: len(measCat)), \
+                self.approximatePsf(exposure, measCat.getTable().getMetadata()), \
+                self.recordSincCoeffsStatistics():
+            self.cacheCoefficients(exposure, beginOrder=beginOrder, endOrder=endOrder)
+            self.runPlugins(noiseReplacer, measCat, exposure, refCat, refWcs, beginOrder, endOrder)
+        self.memory.record("plugins", sincCoeffs=getSincCoeffsBytes)
+
+    def runPlugins(self, noiseReplacer, measCat, exposure, refCat, refWcs, beginOrder=None, endOrder=None):
+        """Call the configured measurement plugins on an image.
+
+        Parameters
+        ----------
+        noiseReplacer : `NoiseReplacer`
+            Used to fill sources not being measured with noise.
+        measCat : `lsst.afw.table.SourceCatalog`
+            Source catalog for measurement results, in the same order as
+            ``refCat``.
+        exposure : `lsst.afw.image.exposureF`
+            Image to be measured.
+        refCat : `lsst.afw.table.SourceCatalog`
+            Reference catalog passed to each plugin.
+        refWcs : `lsst.afw.geom.SkyWcs`
+            Defines the X,Y coordinate system of ``refCat``.
+        beginOrder : `int`, optional
+            Beginning execution order (inclusive). Algorithms with
+            ``executionOrder`` < ``beginOrder`` are not executed. `None` for no limit.
+        endOrder : `int`, optional
+            Ending execution order (exclusive). Algorithms with
+            ``executionOrder`` >= ``endOrder`` are not executed. `None` for no limit.
+        """
+        # Wrap the task logger into a periodic logger.
+        periodicLog = PeriodicLogger(self.log)
+
         # Create parent cat which slices both the refCat and measCat (sources)
         # first, get the reference and source records which have no parent
         refParentCat, measParentCat = refCat.getChildren(0, measCat)
         childrenIter = refCat.getChildren((refParentRecord.getId() for refParentRecord in refCat), measCat)
+        # Plugins that only transform reference quantities are run for
+        # all sources at once, and skipped in the per-source loop.
+        skipPlugins = self.getCatalogPluginNames()
+        with traceSpan("transformed plugins", "stage"):
+            skipPlugins |= self.callMeasureTransformed(measCat, exposure, refCat, refWcs,
+                                                       beginOrder=beginOrder, endOrder=endOrder)
         for parentIdx, records in enumerate(zip(refParentCat, measParentCat, childrenIter)):
             # Unpack records
             refParentRecord, measParentRecord, (refChildCat, measChildCat) = records
@@ -364,13 +545,15 @@ class ForcedMeasurementTask(BaseMeasurementTask):
             for refChildRecord, measChildRecord in zip(refChildCat, measChildCat):
                 noiseReplacer.insertSource(refChildRecord.getId())
                 self.callMeasure(measChildRecord, exposure, refChildRecord, refWcs,
-                                 beginOrder=beginOrder, endOrder=endOrder)
+                                 beginOrder=beginOrder, endOrder=endOrder,
+                                 skipPlugins=skipPlugins)
                 noiseReplacer.removeSource(refChildRecord.getId())
 
             # Then process the parent record
             noiseReplacer.insertSource(refParentRecord.getId())
             self.callMeasure(measParentRecord, exposure, refParentRecord, refWcs,
-                             beginOrder=beginOrder, endOrder=endOrder)
+                             beginOrder=beginOrder, endOrder=endOrder,
+                             skipPlugins=skipPlugins)
             self.callMeasureN(measParentCat[parentIdx:parentIdx+1], exposure,
                               refParentCat[parentIdx:parentIdx+1],
                               beginOrder=beginOrder, endOrder=endOrder)
@@ -383,13 +566,77 @@ class ForcedMeasurementTask(BaseMeasurementTask):
                             parentIdx + 1, len(refParentCat))
         noiseReplacer.end()
 
+        # Plugins with a catalog-level implementation were skipped above,
+        # and measure all sources at once here.
+        if self.config.doMeasureCatalog:
+            with traceSpan("catalog plugins", "stage"):
+                self.callMeasureCatalog(measCat, exposure, refCat, [refWcs]*len(refCat),
+                                        beginOrder=beginOrder, endOrder=endOrder)
+
         # Undeblended plugins only fire if we're running everything
         if endOrder is None:
-            for recordIndex, (measRecord, refRecord) in enumerate(zip(measCat, refCat)):
-                for plugin in self.undeblendedPlugins.iter():
-                    self.doMeasurement(plugin, measRecord, exposure, refRecord, refWcs)
-                    periodicLog.log("Undeblended forced measurement complete for %d sources out of %d",
-                                    recordIndex + 1, len(refCat))
+            with traceSpan("undeblended plugins", "stage"):
+                for recordIndex, (measRecord, refRecord) in enumerate(zip(measCat, refCat)):
+                    for plugin in self.undeblendedPlugins.iter():
+                        self.doMeasurement(plugin, measRecord, exposure, refRecord, refWcs)
+                        periodicLog.log("Undeblended forced measurement complete for %d sources "
+                                        "out of %d", recordIndex + 1, len(refCat))
+
+    def callMeasureTransformed(self, measCat, exposure, refCat, refWcs, beginOrder=None, endOrder=None):
+        """Call ``measureTransformed`` on all plugins that implement it,
+        sharing one set of transformed reference positions.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog of all sources being measured.
+        exposure : `lsst.afw.image.Exposure`
+            Image being measured.
+        refCat : `lsst.afw.table.SourceCatalog`
+            Reference catalog, in the same order as ``measCat``.
+        refWcs : `lsst.afw.geom.SkyWcs` or `lsst.geom.Angle`
+            Coordinate system of ``refCat``.
+        beginOrder : `int`, optional
+            Beginning execution order (inclusive): measurements with
+            ``executionOrder`` < ``beginOrder`` are not executed. `None` for
+            no limit.
+        endOrder : `int`, optional
+            Ending execution order (exclusive): measurements with
+            ``executionOrder`` >= ``endOrder`` are not executed. `None` for
+            no limit.
+
+        Returns
+        -------
+        names : `set` [`str`]
+            Names of the plugins that were run, which should not be run again
+            on individual sources.  Empty if ``config.doTransformReferences``
+            is `False`, or the reference and target WCSs are not both
+            available.
+        """
+        names = set()
+        targetWcs = exposure.getWcs()
+        if (not self.config.doTransformReferences or len(measCat) == 0 or targetWcs is None
+                or not isinstance(refWcs, lsst.afw.geom.SkyWcs)):
+            return names
+        transforms = ReferenceTransforms(refCat, refWcs, targetWcs)
+        for plugin in self.plugins.iter():
+            if beginOrder is not None and plugin.getExecutionOrder() < beginOrder:
+                continue
+            if endOrder is not None and plugin.getExecutionOrder() >= endOrder:
+                break
+            if not getattr(plugin, "usesReferenceTransforms", False):
+                continue
+            try:
+                plugin.measureTransformed(measCat, refCat, transforms)
+            except FATAL_EXCEPTIONS:
+                raise
+            except Exception as error:
+                self.log.getChild(plugin.name).debug(
+                    "Exception in %s.measureTransformed on %d records; measuring them individually: %s",
+                    plugin.name, len(measCat), error)
+                continue
+            names.add(plugin.name)
+        return names
 
     def generateMeasCat(self, exposure, refCat, refWcs, idFactory=None):
         r"""Initialize an output catalog from the reference catalog.
@@ -479,9 +726,9 @@ class ForcedMeasurementTask(BaseMeasurementTask):
         if psf is None:
             raise RuntimeError("Cannot construct Footprints from PSF shape without a PSF.")
         bbox = exposure.getBBox()
-        wcs = exposure.getWcs()
-        for record in sources:
-            localPoint = wcs.skyToPixel(record.getCoord())
+        centers = computeCoordCentroids(sources, exposure.getWcs())
+        for record, center in zip(sources, centers):
+            localPoint = lsst.geom.Point2D(*center)
             localIntPoint = lsst.geom.Point2I(localPoint)
             assert bbox.contains(localIntPoint), (
                 f"Center for record {record.getId()} is not in exposure; this should be guaranteed by "
@@ -19,6 +19,7 @@
 # You should have received a copy of the GNU General Public License
 # along with this program.  If not, see <https://www.gnu.org/licenses/>.
 
+import concurrent.futures
 import dataclasses
 
 import astropy.table
@@ -32,6 +33,7 @@ import lsst.geom
 import lsst.afw.detection
 import lsst.afw.geom
 import lsst.afw.image
+import lsst.afw.math
 import lsst.afw.table
 import lsst.sphgeom
 
@@ -45,11 +47,43 @@ from .forcedMeasurement import ForcedMeasurementTask
 from .applyApCorr import ApplyApCorrTask
 from .catalogCalculation import CatalogCalculationTask
 from ._id_generator import DetectorVisitIdGeneratorConfig
+from .memoryAccounting import MemoryRecorder, getDataFrameBytes, getTableBytes
+from .tracing import traceSpan
 
 __all__ = ("ForcedPhotCcdConfig", "ForcedPhotCcdTask",
            "ForcedPhotCcdFromDataFrameTask", "ForcedPhotCcdFromDataFrameConfig")
 
 
+class _ReadAheadHandle:
+    """A stand-in for a deferred dataset handle whose dataset is being read
+    on another thread.
+
+    Parameters
+    ----------
+    future : `concurrent.futures.Future`
+        Future for the dataset.
+    dataId : `lsst.daf.butler.DataCoordinate`
+        Data ID of the dataset.
+    """
+
+    def __init__(self, future, dataId):
+        self._future = future
+        self.dataId = dataId
+
+    def get(self, parameters=None):
+        """Wait for the dataset and return it.
+
+        Raises
+        ------
+        ValueError
+            Raised if ``parameters`` are given; they can only be applied
+            when the read is started.
+        """
+        if parameters:
+            raise ValueError("Parameters cannot be applied to a dataset that is already being read.")
+        return self._future.result()
+
+
 class ForcedPhotCcdConnections(PipelineTaskConnections,
                                dimensions=("instrument", "visit", "detector", "skymap", "tract"),
                                defaultTemplates={"inputCoaddName": "deep",
@@ -146,6 +180,31 @@ class ForcedPhotCcdConfig(pipeBase.PipelineTaskConfig,
         default=False,
         doc="Apply sky correction?",
     )
+    skyCorrMode = lsst.pex.config.ChoiceField(
+        dtype=str,
+        default="tiled",
+        doc="How to apply the sky correction if doApplySkyCorr=True.",
+        allowed={
+            "full": "Evaluate the sky correction over the whole detector, then subtract it.",
+            "tiled": ("Evaluate and subtract the sky correction one tile at a time, without making a "
+                      "full-detector background image."),
+            "lazy": ("As 'tiled', but only for tiles near the Footprints of the sources to be measured; "
+                     "the rest of the exposure (which is not written out) is left uncorrected."),
+        },
+    )
+    skyCorrTileSize = lsst.pex.config.Field(
+        dtype=int,
+        default=512,
+        doc="Width and height (pixels) of the tiles in which the sky correction is applied, for "
+            "skyCorrMode='tiled' or 'lazy'.",
+    )
+    skyCorrLazyMargin = lsst.pex.config.Field(
+        dtype=int,
+        default=50,
+        doc="Distance (pixels) by which source Footprint bounding boxes are grown when selecting the tiles "
+            "to correct for skyCorrMode='lazy'; should cover any pixels measurement plugins read outside "
+            "Footprints (e.g. local background annuli).",
+    )
     useVisitSummary = lsst.pex.config.Field(
         dtype=bool,
         default=True,
@@ -217,6 +276,41 @@ class ForcedPhotCcdConfig(pipeBase.PipelineTaskConfig,
         doc="Scaling factor to apply to the PSF shape when footprintSource='psf' (ignored otherwise).",
         default=3.0,
     )
+    doBatchPsfFlux = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc=(
+            "Measure base_PsfFlux for all sources with a single batched call after the other measurement "
+            "plugins have run, instead of source-by-source.  The per-source base_PsfFlux measurement and "
+            "noise replacement must be disabled (see configureBatchPsfFlux)."
+        ),
+    )
+    batchPsfFluxThreads = lsst.pex.config.Field(
+        dtype=int,
+        default=1,
+        doc="Number of threads to use for batched PSF photometry; 0 for one per hardware thread.",
+    )
+    doPipelineInputs = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc=(
+            "Read the reference catalogs on background threads while the exposure is read and "
+            "calibrated.  Requires a butler that supports concurrent reads."
+        ),
+    )
+    numInputThreads = lsst.pex.config.Field(
+        dtype=int,
+        default=4,
+        doc="Maximum number of reference catalogs to read concurrently if doPipelineInputs is True.",
+    )
+    doRecordMemory = lsst.pex.config.Field(
+        dtype=bool,
+        default=False,
+        doc=(
+            "Record the memory held by the merged reference catalog, and the process high-water mark, in "
+            "the task metadata?  Measurement memory is recorded if measurement.doRecordMemory is set."
+        ),
+    )
     idGenerator = DetectorVisitIdGeneratorConfig.make_field()
 
     def setDefaults(self):
@@ -251,6 +345,16 @@ class ForcedPhotCcdConfig(pipeBase.PipelineTaskConfig,
                     f"measurement.copyColumns['id'] should be set to {self.refCatIdColumn} "
                     f"(refCatIdColumn) when refCatStorageClass={self.refCatStorageClass}."
                 )
+        if self.doBatchPsfFlux:
+            if "base_PsfFlux" not in self.measurement.plugins.names:
+                raise ValueError("doBatchPsfFlux requires base_PsfFlux in measurement.plugins.names.")
+            if self.measurement.plugins["base_PsfFlux"].doMeasure:
+                raise ValueError("doBatchPsfFlux requires measurement.plugins['base_PsfFlux'].doMeasure "
+                                 "to be False, so sources are not measured twice.")
+            if self.measurement.doReplaceWithNoise:
+                raise ValueError("doBatchPsfFlux requires measurement.doReplaceWithNoise to be False, as "
+                                 "the batched fit is made on the image with all sources present, while "
+                                 "the other plugins would see noise-replaced neighbors.")
 
     def configureParquetRefCat(self, refCatStorageClass: str = "ArrowAstropy"):
         """Set the refCatStorageClass option to a Parquet-based type, and
@@ -265,6 +369,20 @@ class ForcedPhotCcdConfig(pipeBase.PipelineTaskConfig,
         self.measurement.copyColumns.pop("deblend_nChild", None)
         self.measurement.slots.centroid = "base_TransformedCentroidFromCoord"
 
+    def configureBatchPsfFlux(self, nThreads: int = 1):
+        """Measure base_PsfFlux with a single batched (and optionally
+        multithreaded) call instead of source-by-source.
+
+        This is appropriate when no deblending or noise replacement is needed,
+        such as forced photometry on difference images.  Noise replacement is
+        disabled for all plugins, so that they measure the same image as the
+        batched fit.
+        """
+        self.doBatchPsfFlux = True
+        self.batchPsfFluxThreads = nThreads
+        self.measurement.plugins["base_PsfFlux"].doMeasure = False
+        self.measurement.doReplaceWithNoise = False
+
 
 class ForcedPhotCcdTask(pipeBase.PipelineTask):
     """A pipeline task for performing forced measurement on CCD images.
@@ -303,9 +421,53 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
             self.makeSubtask("applyApCorr", schema=self.measurement.schema)
         self.makeSubtask('catalogCalculation', schema=self.measurement.schema)
         self.outputSchema = lsst.afw.table.SourceCatalog(self.measurement.schema)
+        self.memory = MemoryRecorder(self.metadata if self.config.doRecordMemory else None)
 
     def runQuantum(self, butlerQC, inputRefs, outputRefs):
+        if self.config.doPipelineInputs:
+            with self._makeInputExecutor() as executor:
+                inputs = self.readInputs(butlerQC, inputRefs, executor=executor)
+        else:
+            inputs = self.readInputs(butlerQC, inputRefs)
+        self._measureQuantum(butlerQC, inputRefs, outputRefs, inputs)
+
+    def readInputs(self, butlerQC, inputRefs, executor=None):
+        """Read the inputs of a quantum, apply calibrations to the exposure,
+        and select the reference objects that overlap it.
+
+        Parameters
+        ----------
+        butlerQC : `lsst.pipe.base.QuantumContext`
+            Butler interface for the quantum.
+        inputRefs : `lsst.pipe.base.InputQuantizedConnection`
+            References to the inputs of the quantum.
+        executor : `concurrent.futures.Executor`, optional
+            If provided, the reference catalogs are read on this executor,
+            concurrently with reading and calibrating the exposure.  Only the
+            reads themselves run on the executor; the butler is queried on
+            the calling thread.
+
+        Returns
+        -------
+        inputs : `dict`
+            Arguments for `run`, except ``measCat`` and ``exposureId``, plus
+            ``skyCorr`` if its application has been deferred
+            (``skyCorrMode='lazy'``).
+
+        Raises
+        ------
+        NoWorkFound
+            Raised if the exposure has no WCS.
+        """
+        if executor is not None:
+            parameters = self._getRefCatParameters()
+            refCatHandles = [
+                _ReadAheadHandle(executor.submit(handle.get, parameters=parameters), handle.dataId)
+                for handle in butlerQC.get(inputRefs.refCat)
+            ]
         inputs = butlerQC.get(inputRefs)
+        if executor is not None:
+            inputs['refCat'] = refCatHandles
 
         tract = butlerQC.quantum.dataId['tract']
         skyMap = inputs.pop('skyMap')
@@ -313,12 +475,17 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
 
         # Connections only exist if they are configured to be used.
         skyCorr = inputs.pop('skyCorr', None)
+        # In lazy mode the sky correction is only applied once the
+        # Footprints of the sources to be measured are known.
+        deferSkyCorr = skyCorr is not None and self.config.skyCorrMode == "lazy"
 
         inputs['exposure'] = self.prepareCalibratedExposure(
             inputs['exposure'],
-            skyCorr=skyCorr,
+            skyCorr=None if deferSkyCorr else skyCorr,
             visitSummary=inputs.pop("visitSummary", None),
         )
+        if deferSkyCorr:
+            inputs['skyCorr'] = skyCorr
 
         if inputs["exposure"].getWcs() is None:
             raise NoWorkFound("Exposure has no WCS.")
@@ -338,6 +505,13 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
             inputs['exposure'].getBBox(),
             inputs['exposure'].getWcs(),
         )
+        return inputs
+
+    def _measureQuantum(self, butlerQC, inputRefs, outputRefs, inputs):
+        """Measure a quantum whose inputs have been read by `readInputs`, and
+        write the outputs.
+        """
+        skyCorr = inputs.pop('skyCorr', None)
         # generateMeasCat does not actually use the refWcs; parameter is
         # passed for signature backwards compatibility.
         inputs['measCat'], inputs['exposureId'] = self.generateMeasCat(
@@ -346,9 +520,53 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
         # attachFootprints only uses refWcs in ``transformed`` mode, which is
         # not supported unless refCatStorageClass='SourceCatalog'.
         self.attachFootprints(inputs["measCat"], inputs["refCat"], inputs["exposure"], inputs["refWcs"])
+        if skyCorr is not None:
+            regions = []
+            for record in inputs["measCat"]:
+                footprint = record.getFootprint()
+                if footprint is None:
+                    regions = None
+                    break
+                regions.append(footprint.getBBox())
+            with traceSpan("applySkyCorr", "stage", nRegions=len(regions) if regions else 0):
+                self.applySkyCorr(inputs["exposure"], skyCorr, regions=regions)
         outputs = self.run(**inputs)
         butlerQC.put(outputs, outputRefs)
 
+    def _makeInputExecutor(self):
+        """Make the executor on which reference catalogs are read if
+        ``doPipelineInputs`` is set.
+        """
+        return concurrent.futures.ThreadPoolExecutor(max_workers=max(1, self.config.numInputThreads),
+                                                     thread_name_prefix="forcedPhotCcdInput")
+
+    def _getRefCatParameters(self):
+        """Return the parameters with which to read reference catalogs.
+
+        Returns
+        -------
+        parameters : `dict` or `None`
+            Parameters for `lsst.daf.butler.DeferredDatasetHandle.get`.
+        """
+        if self.config.refCatStorageClass == "SourceCatalog":
+            return None
+        return {
+            "columns": [
+                self.config.refCatIdColumn,
+                self.config.refCatRaColumn,
+                self.config.refCatDecColumn,
+            ]
+        }
+
+    def _getRefCat(self, handle):
+        """Read a reference catalog with the parameters from
+        `_getRefCatParameters`, unless its read was started by `readInputs`
+        with them already.
+        """
+        if isinstance(handle, _ReadAheadHandle):
+            return handle.get()
+        return handle.get(parameters=self._getRefCatParameters())
+
     def prepareCalibratedExposure(self, exposure, skyCorr=None, visitSummary=None):
         """Prepare a calibrated exposure and apply external calibrations
         and sky corrections if so configured.
@@ -385,10 +603,98 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
                 exposure.info.setApCorrMap(apCorrMap)
 
         if skyCorr is not None:
-            exposure.maskedImage -= skyCorr.getImage()
+            if self.config.skyCorrMode == "full":
+                exposure.maskedImage -= skyCorr.getImage()
+            else:
+                self.applySkyCorr(exposure, skyCorr)
 
         return exposure
 
+    def applySkyCorr(self, exposure, skyCorr, regions=None):
+        """Subtract a sky correction from an exposure in place, evaluating it
+        one tile at a time.
+
+        Parameters
+        ----------
+        exposure : `lsst.afw.image.Exposure`
+            Exposure to correct.
+        skyCorr : `lsst.afw.math.BackgroundList`
+            Sky correction to subtract.
+        regions : iterable of `lsst.geom.Box2I`, optional
+            If provided, only tiles within ``skyCorrLazyMargin`` of one of
+            these boxes are corrected.
+
+        Notes
+        -----
+        The background layers are summed for each tile before it is
+        subtracted, as `lsst.afw.math.BackgroundList.getImage` does for the
+        whole image, so the corrected pixels are the same.  Layers that use
+        an approximation rather than interpolation cannot be evaluated on a
+        tile, so in their presence the whole sky correction is applied at
+        once.
+        """
+        layers = [tuple(layer)[:4] for layer in skyCorr]
+        if any(approxStyle != lsst.afw.math.ApproximateControl.UNKNOWN for _, _, _, approxStyle in layers):
+            self.log.debug("Sky correction uses an approximation; applying it to the full image.")
+            exposure.maskedImage -= skyCorr.getImage()
+            return
+        bbox = exposure.getBBox()
+        image = exposure.image
+        for tile in self._makeSkyCorrTiles(bbox, regions):
+            background = None
+            for layer, interpStyle, undersampleStyle, _ in layers:
+                layerImage = layer.getImageF(tile, interpStyle, undersampleStyle)
+                if background is None:
+                    background = layerImage
+                else:
+                    background += layerImage
+            if background is not None:
+                tileImage = image[tile]
+                tileImage -= background
+
+    def _makeSkyCorrTiles(self, bbox, regions=None):
+        """Return the tiles in which to apply the sky correction.
+
+        Parameters
+        ----------
+        bbox : `lsst.geom.Box2I`
+            Bounding box of the exposure.
+        regions : iterable of `lsst.geom.Box2I`, optional
+            If provided, only tiles within ``skyCorrLazyMargin`` of one of
+            these boxes are returned.
+
+        Returns
+        -------
+        tiles : `list` [`lsst.geom.Box2I`]
+            Tiles covering (the selected parts of) ``bbox``.
+        """
+        size = max(1, self.config.skyCorrTileSize)
+        nx = -(-bbox.getWidth()//size)
+        ny = -(-bbox.getHeight()//size)
+        if regions is None:
+            selected = np.ones((ny, nx), dtype=bool)
+        else:
+            selected = np.zeros((ny, nx), dtype=bool)
+            for region in regions:
+                region = lsst.geom.Box2I(region)
+                region.grow(self.config.skyCorrLazyMargin)
+                region.clip(bbox)
+                if region.isEmpty():
+                    continue
+                ix0, ix1 = ((region.getMinX() - bbox.getMinX())//size,
+                            (region.getMaxX() - bbox.getMinX())//size)
+                iy0, iy1 = ((region.getMinY() - bbox.getMinY())//size,
+                            (region.getMaxY() - bbox.getMinY())//size)
+                selected[iy0:iy1 + 1, ix0:ix1 + 1] = True
+        tiles = []
+        for iy, ix in zip(*np.nonzero(selected)):
+            tile = lsst.geom.Box2I(lsst.geom.Point2I(bbox.getMinX() + int(ix)*size,
+                                                     bbox.getMinY() + int(iy)*size),
+                                   lsst.geom.Extent2I(size, size))
+            tile.clip(bbox)
+            tiles.append(tile)
+        return tiles
+
     def generateMeasCat(self, dataId, exposure, refCat, refWcs):
         """Generate a measurement catalog.
 
@@ -444,6 +750,8 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
                 (`lsst.afw.table.SourceCatalog`).
         """
         self.measurement.run(measCat, exposure, refCat, refWcs, exposureId=exposureId)
+        if self.config.doBatchPsfFlux:
+            self.measureBatchPsfFlux(measCat, exposure)
         if self.config.doApCorr:
             apCorrMap = exposure.getInfo().getApCorrMap()
             if apCorrMap is None:
@@ -457,6 +765,40 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
 
         return pipeBase.Struct(measCat=measCat)
 
+    def measureBatchPsfFlux(self, measCat, exposure):
+        """Measure PSF fluxes for all sources at their centroid slot
+        positions with a single call to `PsfFluxAlgorithm.measureCatalog`.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            The measurement catalog, with the centroid slot already filled.
+            The ``base_PsfFlux`` fields are filled in place.
+        exposure : `lsst.afw.image.Exposure`
+            The image to measure.
+        """
+        plugin = self.measurement.plugins["base_PsfFlux"]
+        if measCat.isContiguous():
+            x = np.asarray(measCat.getX(), dtype=np.float64)
+            y = np.asarray(measCat.getY(), dtype=np.float64)
+        else:
+            x = np.array([record.getX() for record in measCat], dtype=np.float64)
+            y = np.array([record.getY() for record in measCat], dtype=np.float64)
+        self.log.info("Measuring PSF fluxes for %d sources in batch mode", len(measCat))
+        with traceSpan("PsfFlux.measureCatalog", "pluginCatalog", nSources=len(measCat)):
+            plugin.cpp.measureCatalog(measCat, exposure, x, y, nThreads=self.config.batchPsfFluxThreads)
+        # Match the per-source measurement, which sets the general failure
+        # flag for sources whose input centroid is flagged.
+        centroidFlagKey = measCat.getCentroidSlot().getFlagKey()
+        if centroidFlagKey.isValid():
+            failureKey = measCat.schema.find(f"{plugin.name}_flag").key
+            if measCat.isContiguous():
+                measCat[failureKey] |= measCat[centroidFlagKey]
+            else:
+                for record in measCat:
+                    if record.get(centroidFlagKey):
+                        record.set(failureKey, True)
+
     def attachFootprints(self, sources, refCat, exposure, refWcs):
         """Attach footprints to blank sources prior to measurements.
 
@@ -534,6 +876,7 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
         if mergedRefCat is None:
             raise RuntimeError("No reference objects for forced photometry.")
         mergedRefCat.sort(lsst.afw.table.SourceTable.getParentKey())
+        self.memory.record("refCat", merged=lambda: len(mergedRefCat)*mergedRefCat.schema.getRecordSize())
         return mergedRefCat
 
     def _prepDataFrameRefCat(self, refCatHandles, exposureBBox, exposureWcs):
@@ -556,19 +899,10 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
         refCat : `lsst.afw.table.SourceTable`
             Source Catalog with minimal schema that overlaps exposureBBox
         """
-        dfList = [
-            i.get(
-                parameters={
-                    "columns": [
-                        self.config.refCatIdColumn,
-                        self.config.refCatRaColumn,
-                        self.config.refCatDecColumn,
-                    ]
-                }
-            )
-            for i in refCatHandles
-        ]
+        dfList = [self._getRefCat(i) for i in refCatHandles]
         df = pd.concat(dfList)
+        del dfList
+        self.memory.record("refCat", merged=lambda: getDataFrameBytes(df))
         # translate ra/dec coords in dataframe to detector pixel coords
         # to down select rows that overlap the detector bbox
         mapping = exposureWcs.getTransform().getMapping()
@@ -599,19 +933,10 @@ class ForcedPhotCcdTask(pipeBase.PipelineTask):
         refCat : `lsst.afw.table.SourceTable`
             Source Catalog with minimal schema that overlaps exposureBBox
         """
-        table_list = [
-            i.get(
-                parameters={
-                    "columns": [
-                        self.config.refCatIdColumn,
-                        self.config.refCatRaColumn,
-                        self.config.refCatDecColumn,
-                    ]
-                }
-            )
-            for i in refCatHandles
-        ]
+        table_list = [self._getRefCat(i) for i in refCatHandles]
         full_table = astropy.table.vstack(table_list)
+        del table_list
+        self.memory.record("refCat", merged=lambda: getTableBytes(full_table))
         # translate ra/dec coords in table to detector pixel coords
         # to down-select rows that overlap the detector bbox
         mapping = exposureWcs.getTransform().getMapping()
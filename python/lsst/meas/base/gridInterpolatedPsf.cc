@@ -0,0 +1,85 @@
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "lsst/cpputils/python.h"
+
+#include <memory>
+
+#include "lsst/pex/config/python.h"
+
+#include "lsst/meas/base/GridInterpolatedPsf.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+using PyGridInterpolatedPsf =
+        py::class_<GridInterpolatedPsf, std::shared_ptr<GridInterpolatedPsf>, afw::detection::Psf>;
+using PyGridInterpolatedPsfControl = py::class_<GridInterpolatedPsfControl>;
+
+PyGridInterpolatedPsfControl declareGridInterpolatedPsfControl(
+        lsst::cpputils::python::WrapperCollection &wrappers) {
+    return wrappers.wrapType(
+            PyGridInterpolatedPsfControl(wrappers.module, "GridInterpolatedPsfControl"),
+            [](auto &mod, auto &cls) {
+                LSST_DECLARE_CONTROL_FIELD(cls, GridInterpolatedPsfControl, gridSpacing);
+                LSST_DECLARE_CONTROL_FIELD(cls, GridInterpolatedPsfControl, nCheckPoints);
+                LSST_DECLARE_CONTROL_FIELD(cls, GridInterpolatedPsfControl, seed);
+                LSST_DECLARE_CONTROL_FIELD(cls, GridInterpolatedPsfControl, maxRelativeError);
+                cls.def(py::init<>());
+            });
+}
+
+PyGridInterpolatedPsf declareGridInterpolatedPsf(lsst::cpputils::python::WrapperCollection &wrappers) {
+    return wrappers.wrapType(
+            PyGridInterpolatedPsf(wrappers.module, "GridInterpolatedPsf"), [](auto &mod, auto &cls) {
+                cls.def(py::init<std::shared_ptr<afw::detection::Psf const>, geom::Box2I const &,
+                                 GridInterpolatedPsfControl const &>(),
+                        "psf"_a, "bbox"_a, "ctrl"_a = GridInterpolatedPsfControl());
+                cls.def("getExactPsf", &GridInterpolatedPsf::getExactPsf);
+                cls.def("getGridBBox", &GridInterpolatedPsf::getGridBBox);
+                cls.def("getNx", &GridInterpolatedPsf::getNx);
+                cls.def("getNy", &GridInterpolatedPsf::getNy);
+                cls.def("getMaxKernelError", &GridInterpolatedPsf::getMaxKernelError);
+                cls.def("getMaxShapeError", &GridInterpolatedPsf::getMaxShapeError);
+                cls.def("isAccurate", &GridInterpolatedPsf::isAccurate);
+            });
+}
+
+}  // namespace
+
+void wrapGridInterpolatedPsf(lsst::cpputils::python::WrapperCollection &wrappers) {
+    auto clsControl = declareGridInterpolatedPsfControl(wrappers);
+    auto clsPsf = declareGridInterpolatedPsf(wrappers);
+    clsPsf.attr("Control") = clsControl;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,200 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Lightweight accounting of the memory held at measurement stage
+boundaries.
+
+The sizes reported are of the pixel, span and table data held by the
+structures that dominate the memory use of measurement; Python object
+overheads are not included.
+"""
+
+__all__ = ("MemoryRecorder", "getMaxResidentBytes", "getFootprintBytes", "getFootprintDictBytes",
+           "getDataFrameBytes", "getTableBytes", "getSincCoeffsBytes", "getSincCoeffsStatistics")
+
+import resource
+import sys
+
+from ._measBaseLib import SincCoeffsD, SincCoeffsF
+
+# An afw.geom.Span is a row and two column indices.
+_SPAN_BYTES = 12
+
+
+def getMaxResidentBytes():
+    """Return the high-water mark of this process's resident set size.
+
+    Returns
+    -------
+    nBytes : `int`
+        Peak resident set size so far, in bytes.
+    """
+    maxRss = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in kilobytes, except on macOS where it is in bytes.
+    return maxRss if sys.platform == "darwin" else 1024*maxRss
+
+
+def getFootprintBytes(footprint):
+    """Return the number of bytes of data held by a footprint.
+
+    Parameters
+    ----------
+    footprint : `lsst.afw.detection.Footprint`
+        Footprint, which may be heavy.
+
+    Returns
+    -------
+    nBytes : `int`
+        Bytes of spans and peaks, plus pixels if the footprint is heavy.
+    """
+    if footprint is None:
+        return 0
+    peaks = footprint.getPeaks()
+    nBytes = _SPAN_BYTES*len(footprint.getSpans()) + len(peaks)*peaks.getSchema().getRecordSize()
+    if footprint.isHeavy():
+        nBytes += (footprint.getImageArray().nbytes + footprint.getMaskArray().nbytes
+                   + footprint.getVarianceArray().nbytes)
+    return nBytes
+
+
+def getFootprintDictBytes(footprints):
+    """Return the number of bytes of data held by a dictionary of
+    footprints.
+
+    Parameters
+    ----------
+    footprints : `dict` [`int`, (`int`, `lsst.afw.detection.Footprint`)]
+        Footprints keyed by ID, each with its parent ID, as returned by
+        `BaseMeasurementTask.getFootprintsFromCatalog`.
+
+    Returns
+    -------
+    nBytes : `int`
+        Total bytes held by the footprints.
+    """
+    return sum(getFootprintBytes(footprint) for _, footprint in footprints.values())
+
+
+def getDataFrameBytes(df):
+    """Return the number of bytes held by a DataFrame, including its index
+    and the contents of any object columns.
+
+    Parameters
+    ----------
+    df : `pandas.DataFrame`
+        Table to measure.
+
+    Returns
+    -------
+    nBytes : `int`
+        Bytes held by the table.
+    """
+    return int(df.memory_usage(index=True, deep=True).sum())
+
+
+def getTableBytes(table):
+    """Return the number of bytes held by the columns of an astropy table.
+
+    Parameters
+    ----------
+    table : `astropy.table.Table`
+        Table to measure.
+
+    Returns
+    -------
+    nBytes : `int`
+        Bytes held by the columns.
+    """
+    return sum(int(column.nbytes) for column in table.itercols())
+
+
+def getSincCoeffsBytes():
+    """Return the number of bytes of Sinc aperture coefficients cached.
+
+    Returns
+    -------
+    nBytes : `int`
+        Bytes held by the single- and double-precision caches.
+    """
+    return SincCoeffsF.getCacheBytes() + SincCoeffsD.getCacheBytes()
+
+
+def getSincCoeffsStatistics():
+    """Return the combined statistics of the Sinc aperture coefficient
+    caches.
+
+    Returns
+    -------
+    statistics : `dict` [`str`, `int` or `float`]
+        Sums over the single- and double-precision caches of the
+        ``hits``, ``misses``, ``evictions``, ``computeTime`` (seconds),
+        ``entries`` and ``bytes`` attributes of
+        `SincCoeffsF.CacheStatistics`.
+    """
+    caches = (SincCoeffsF.getCacheStatistics(), SincCoeffsD.getCacheStatistics())
+    return {name: sum(getattr(stats, name) for stats in caches)
+            for name in ("hits", "misses", "evictions", "computeTime", "entries", "bytes")}
+
+
+class MemoryRecorder:
+    """Record the memory held by data structures, and the process
+    high-water mark, at the boundaries of the stages of a task.
+
+    Entries are added to task metadata as
+    ``<prefix>.<stage>.<name>Bytes`` for each structure and
+    ``<prefix>.<stage>.maxResidentBytes`` for the high-water mark.
+
+    Parameters
+    ----------
+    metadata : `lsst.pipe.base.TaskMetadata` or `None`
+        Metadata to record to; if `None`, nothing is recorded.
+    prefix : `str`, optional
+        Prefix for the metadata keys.
+    """
+
+    def __init__(self, metadata, prefix="memory"):
+        self.metadata = metadata
+        self.prefix = prefix
+
+    @property
+    def enabled(self):
+        """Whether memory usage is being recorded (`bool`)."""
+        return self.metadata is not None
+
+    def record(self, stage, **sizes):
+        """Record memory usage at the end of a stage.
+
+        Parameters
+        ----------
+        stage : `str`
+            Name of the stage.
+        **sizes
+            Bytes held by each named structure, as an `int` or as a
+            callable returning one; callables are not called if recording
+            is disabled.
+        """
+        if self.metadata is None:
+            return
+        for name, nBytes in sizes.items():
+            if callable(nBytes):
+                nBytes = nBytes()
+            self.metadata[f"{self.prefix}.{stage}.{name}Bytes"] = int(nBytes)
+        self.metadata[f"{self.prefix}.{stage}.maxResidentBytes"] = getMaxResidentBytes()
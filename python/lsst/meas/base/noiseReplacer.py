@@ -26,6 +26,9 @@ import lsst.afw.image as afwImage
 import lsst.afw.math as afwMath
 import lsst.pex.config
 
+from .memoryAccounting import getFootprintBytes
+from .tracing import traceSpan
+
 __all__ = ("NoiseReplacerConfig", "NoiseReplacer", "DummyNoiseReplacer")
 
 
@@ -209,6 +212,19 @@ class NoiseReplacer:
             # Also set the OTHERDET bit
             fp.spans.setMask(mask, self.otherbitmask)
 
+    def getMemoryUsage(self):
+        """Return the memory held by the saved source pixels and the noise
+        that replaces them.
+
+        Returns
+        -------
+        usage : `dict` [`str`, `int`]
+            Bytes held by the source (``"heavies"``) and noise
+            (``"noise"``) heavy footprints.
+        """
+        return {"heavies": sum(getFootprintBytes(fp) for fp in self.heavies.values()),
+                "noise": sum(getFootprintBytes(fp) for fp in self.heavyNoise.values())}
+
     def insertSource(self, id):
         """Insert the heavy footprint of a given source into the exposure.
 
@@ -221,20 +237,21 @@ class NoiseReplacer:
         -----
         Also adjusts the mask plane to show the source of this footprint.
         """
-        # Copy this source's pixels into the image
-        mi = self.exposure.getMaskedImage()
-        im = mi.getImage()
-        mask = mi.getMask()
-        # usedid can point either to this source, or to the first parent in the
-        # parent chain which has a heavy footprint (or to the topmost parent,
-        # which always has one)
-        usedid = id
-        while self.footprints[usedid][0] != 0 and usedid not in self.heavies:
-            usedid = self.footprints[usedid][0]
-        fp = self.heavies[usedid]
-        fp.insert(im)
-        fp.spans.setMask(mask, self.thisbitmask)
-        fp.spans.clearMask(mask, self.otherbitmask)
+        with traceSpan("NoiseReplacer.insertSource", "noiseReplacer"):
+            # Copy this source's pixels into the image
+            mi = self.exposure.getMaskedImage()
+            im = mi.getImage()
+            mask = mi.getMask()
+            # usedid can point either to this source, or to the first parent in the
+            # parent chain which has a heavy footprint (or to the topmost parent,
+            # which always has one)
+            usedid = id
+            while self.footprints[usedid][0] != 0 and usedid not in self.heavies:
+                usedid = self.footprints[usedid][0]
+            fp = self.heavies[usedid]
+            fp.insert(im)
+            fp.spans.setMask(mask, self.thisbitmask)
+            fp.spans.clearMask(mask, self.otherbitmask)
 
     def removeSource(self, id):
         """Replace the heavy footprint of a given source with noise.
@@ -250,24 +267,25 @@ class NoiseReplacer:
         -----
         Also restores the mask plane.
         """
-        # remove a single source
-        # (Replace this source's pixels by noise again.)
-        # Do this by finding the source's top-level ancestor
-        mi = self.exposure.getMaskedImage()
-        im = mi.getImage()
-        mask = mi.getMask()
-
-        # use the same algorithm as in remove Source to find the heavy noise footprint
-        # which will undo what insertSource(id) does
-        usedid = id
-        while self.footprints[usedid][0] != 0 and usedid not in self.heavies:
-            usedid = self.footprints[usedid][0]
-        # Re-insert the noise pixels
-        fp = self.heavyNoise[usedid]
-        fp.insert(im)
-        # Clear the THISDET mask plane.
-        fp.spans.clearMask(mask, self.thisbitmask)
-        fp.spans.setMask(mask, self.otherbitmask)
+        with traceSpan("NoiseReplacer.removeSource", "noiseReplacer"):
+            # remove a single source
+            # (Replace this source's pixels by noise again.)
+            # Do this by finding the source's top-level ancestor
+            mi = self.exposure.getMaskedImage()
+            im = mi.getImage()
+            mask = mi.getMask()
+
+            # use the same algorithm as in remove Source to find the heavy noise footprint
+            # which will undo what insertSource(id) does
+            usedid = id
+            while self.footprints[usedid][0] != 0 and usedid not in self.heavies:
+                usedid = self.footprints[usedid][0]
+            # Re-insert the noise pixels
+            fp = self.heavyNoise[usedid]
+            fp.insert(im)
+            # Clear the THISDET mask plane.
+            fp.spans.clearMask(mask, self.thisbitmask)
+            fp.spans.setMask(mask, self.otherbitmask)
 
     def end(self):
         """End the NoiseReplacer.
@@ -275,17 +293,18 @@ class NoiseReplacer:
         Restores original data to the exposure from the heavies dictionary and
         the mask planes to their original state.
         """
-        # restores original image, cleans up temporaries
-        # (ie, replace all the top-level pixels)
-        mi = self.exposure.getMaskedImage()
-        im = mi.getImage()
-        mask = mi.getMask()
-        for id in self.footprints.keys():
-            if self.footprints[id][0] != 0:
-                continue
-            self.heavies[id].insert(im)
-        for maskname in self.removeplanes:
-            mask.removeAndClearMaskPlane(maskname, True)
+        with traceSpan("NoiseReplacer.end", "noiseReplacer"):
+            # restores original image, cleans up temporaries
+            # (ie, replace all the top-level pixels)
+            mi = self.exposure.getMaskedImage()
+            im = mi.getImage()
+            mask = mi.getMask()
+            for id in self.footprints.keys():
+                if self.footprints[id][0] != 0:
+                    continue
+                self.heavies[id].insert(im)
+            for maskname in self.removeplanes:
+                mask.removeAndClearMaskPlane(maskname, True)
 
         del self.removeplanes
         del self.thisbitmask
@@ -416,6 +416,24 @@ ForcedInputCountPlugin = InputCountPlugin.makeForcedPlugin("base_InputCount")
 """
 
 
+def _setColumn(measCat, key, values):
+    """Set a field of every record in a catalog from an array.
+    """
+    if measCat.isContiguous():
+        measCat[key] = values
+    else:
+        for measRecord, value in zip(measCat, values):
+            measRecord.set(key, value)
+
+
+def _getColumn(catalog, key):
+    """Get a field of every record in a catalog as an array.
+    """
+    if catalog.isContiguous():
+        return np.asarray(catalog[key])
+    return np.array([record.get(key) for record in catalog])
+
+
 class EvaluateLocalPhotoCalibPluginConfig(BaseMeasurementPluginConfig):
     """Configuration for the variance calculation plugin.
     """
@@ -463,6 +481,23 @@ class EvaluateLocalPhotoCalibPlugin(GenericPlugin):
         measRecord.set(self.photoKey, calib)
         measRecord.set(self.photoErrKey, calibErr)
 
+    def measureCatalog(self, measCat, exposure, centers):
+        photoCalib = exposure.getPhotoCalib()
+        if photoCalib is None:
+            log.debug(
+                "%s: photoCalib is None.  Setting localPhotoCalib to NaN for %d records",
+                self.name,
+                len(measCat),
+            )
+            calib = np.full(len(measCat), np.nan)
+            calibErr = np.full(len(measCat), np.nan)
+            _setColumn(measCat, self._failKey, np.ones(len(measCat), dtype=bool))
+        else:
+            calib = photoCalib.getLocalCalibrationArray(centers[:, 0], centers[:, 1])
+            calibErr = np.full(len(measCat), photoCalib.getCalibrationErr())
+        _setColumn(measCat, self.photoKey, calib)
+        _setColumn(measCat, self.photoErrKey, calibErr)
+
 
 SingleFrameEvaluateLocalPhotoCalibPlugin = EvaluateLocalPhotoCalibPlugin.makeSingleFramePlugin(
     "base_LocalPhotoCalib")
@@ -533,6 +568,67 @@ class EvaluateLocalWcsPlugin(GenericPlugin):
         measRecord.set(self.cdMatrix21Key, localMatrix[1, 0])
         measRecord.set(self.cdMatrix22Key, localMatrix[1, 1])
 
+    def measureCatalog(self, measCat, exposure, centers):
+        wcs = exposure.getWcs()
+        if wcs is None:
+            log.debug(
+                "%s: WCS is None.  Setting localWcs matrix values to NaN for %d records",
+                self.name,
+                len(measCat),
+            )
+            localMatrices = np.full((len(measCat), 2, 2), np.nan)
+            _setColumn(measCat, self._failKey, np.ones(len(measCat), dtype=bool))
+        else:
+            localMatrices = self.makeLocalTransformMatrixArray(wcs, centers)
+        _setColumn(measCat, self.cdMatrix11Key, localMatrices[:, 0, 0])
+        _setColumn(measCat, self.cdMatrix12Key, localMatrices[:, 0, 1])
+        _setColumn(measCat, self.cdMatrix21Key, localMatrices[:, 1, 0])
+        _setColumn(measCat, self.cdMatrix22Key, localMatrices[:, 1, 1])
+
+    def makeLocalTransformMatrixArray(self, wcs, centers):
+        """Create local, linear approximations of the wcs transformation
+        matrix at many points at once.
+
+        The matrices are the derivatives of the gnomonic projection about
+        each center (with respect to the on-sky position of that center), by
+        central differences over one pixel.  All offset positions are
+        transformed to the sky in a single call.
+
+        Parameters
+        ----------
+        wcs : `lsst.afw.geom.SkyWcs`
+            Wcs to approximate
+        centers : `numpy.ndarray`
+            Array of shape ``(N, 2)`` of the points at which to evaluate the
+            LocalWcs.
+
+        Returns
+        -------
+        localMatrices : `numpy.ndarray`
+            Array of shape ``(N, 2, 2)`` of the local wcs approximation at
+            each center, with units radians.
+        """
+        nPoints = len(centers)
+        offsets = np.array([[0.0, 0.0], [1.0, 0.0], [-1.0, 0.0], [0.0, 1.0], [0.0, -1.0]])
+        points = (centers[np.newaxis, :, :] + offsets[:, np.newaxis, :]).reshape(-1, 2)
+        ra, dec = wcs.pixelToSkyArray(points[:, 0], points[:, 1], degrees=False)
+        ra = ra.reshape(len(offsets), nPoints)
+        dec = dec.reshape(len(offsets), nPoints)
+        sinDec0 = np.sin(dec[0])
+        cosDec0 = np.cos(dec[0])
+        sinDec = np.sin(dec[1:])
+        cosDec = np.cos(dec[1:])
+        cosDRa = np.cos(ra[1:] - ra[0])
+        cosDistance = sinDec0*sinDec + cosDec0*cosDec*cosDRa
+        xi = cosDec*np.sin(ra[1:] - ra[0])/cosDistance
+        eta = (cosDec0*sinDec - sinDec0*cosDec*cosDRa)/cosDistance
+        localMatrices = np.empty((nPoints, 2, 2))
+        localMatrices[:, 0, 0] = 0.5*(xi[0] - xi[1])
+        localMatrices[:, 1, 0] = 0.5*(eta[0] - eta[1])
+        localMatrices[:, 0, 1] = 0.5*(xi[2] - xi[3])
+        localMatrices[:, 1, 1] = 0.5*(eta[2] - eta[3])
+        return localMatrices
+
     def makeLocalTransformMatrix(self, wcs, center):
         """Create a local, linear approximation of the wcs transformation
         matrix.
@@ -854,6 +950,7 @@ class ForcedTransformedCentroidPlugin(ForcedPlugin):
     """
 
     ConfigClass = ForcedTransformedCentroidConfig
+    usesReferenceTransforms = True
 
     @classmethod
     def getExecutionOrder(cls):
@@ -888,6 +985,15 @@ class ForcedTransformedCentroidPlugin(ForcedPlugin):
         if self.flagKey is not None:
             measRecord.set(self.flagKey, refRecord.getCentroidFlag())
 
+    def measureTransformed(self, measCat, refCat, transforms):
+        self._setCentroids(measCat, refCat, transforms.centroids)
+
+    def _setCentroids(self, measCat, refCat, centroids):
+        _setColumn(measCat, self.centroidKey.getX(), centroids[:, 0])
+        _setColumn(measCat, self.centroidKey.getY(), centroids[:, 1])
+        if self.flagKey is not None:
+            _setColumn(measCat, self.flagKey, _getColumn(refCat, refCat.getCentroidSlot().getFlagKey()))
+
 
 class ForcedTransformedCentroidFromCoordConfig(ForcedTransformedCentroidConfig):
     """Configuration for the forced transformed coord algorithm.
@@ -931,6 +1037,9 @@ class ForcedTransformedCentroidFromCoordPlugin(ForcedTransformedCentroidPlugin):
         if self.flagKey is not None:
             measRecord.set(self.flagKey, refRecord.getCentroidFlag())
 
+    def measureTransformed(self, measCat, refCat, transforms):
+        self._setCentroids(measCat, refCat, transforms.coordCentroids)
+
 
 class ForcedTransformedShapeConfig(ForcedPluginConfig):
     """Configuration for the forced transformed shape algorithm.
@@ -964,6 +1073,7 @@ class ForcedTransformedShapePlugin(ForcedPlugin):
     """
 
     ConfigClass = ForcedTransformedShapeConfig
+    usesReferenceTransforms = True
 
     @classmethod
     def getExecutionOrder(cls):
@@ -1000,3 +1110,26 @@ class ForcedTransformedShapePlugin(ForcedPlugin):
             measRecord.set(self.shapeKey, refRecord.getShape())
         if self.flagKey is not None:
             measRecord.set(self.flagKey, refRecord.getShapeFlag())
+
+    def measureTransformed(self, measCat, refCat, transforms):
+        if refCat.isContiguous():
+            xx = np.asarray(refCat.getIxx(), dtype=np.float64)
+            yy = np.asarray(refCat.getIyy(), dtype=np.float64)
+            xy = np.asarray(refCat.getIxy(), dtype=np.float64)
+        else:
+            xx, yy, xy = np.array([(r.getIxx(), r.getIyy(), r.getIxy()) for r in refCat]).reshape(-1, 3).T
+        if not transforms.isIdentity:
+            # Apply Q' = J Q J^T for the local linear transform J of each
+            # source.
+            j = transforms.jacobians
+            xx, yy, xy = (
+                j[:, 0, 0]**2*xx + 2.0*j[:, 0, 0]*j[:, 0, 1]*xy + j[:, 0, 1]**2*yy,
+                j[:, 1, 0]**2*xx + 2.0*j[:, 1, 0]*j[:, 1, 1]*xy + j[:, 1, 1]**2*yy,
+                j[:, 0, 0]*j[:, 1, 0]*xx + (j[:, 0, 0]*j[:, 1, 1] + j[:, 0, 1]*j[:, 1, 0])*xy
+                + j[:, 0, 1]*j[:, 1, 1]*yy,
+            )
+        _setColumn(measCat, self.shapeKey.getIxx(), xx)
+        _setColumn(measCat, self.shapeKey.getIyy(), yy)
+        _setColumn(measCat, self.shapeKey.getIxy(), xy)
+        if self.flagKey is not None:
+            _setColumn(measCat, self.flagKey, _getColumn(refCat, refCat.getShapeSlot().getFlagKey()))
@@ -22,6 +22,7 @@
 
 #include "pybind11/pybind11.h"
 #include "pybind11/stl.h"
+#include "ndarray/pybind11.h"
 #include "lsst/cpputils/python.h"
 
 #include <memory>
@@ -49,6 +50,10 @@ PyFluxControl declareFluxControl(lsst::cpputils::python::WrapperCollection &wrap
      return wrappers.wrapType(PyFluxControl(wrappers.module, "PsfFluxControl"), [](auto &mod, auto &cls) {
 
          LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, badMaskPlanes);
+         LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, subpixelPhases);
+         LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, interpolatePhases);
+         LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, phaseCellSize);
+         LSST_DECLARE_CONTROL_FIELD(cls, PsfFluxControl, doMeasureN);
 
          cls.def(py::init<>());
      });
@@ -66,6 +71,10 @@ PyFluxAlgorithm declareFluxAlgorithm(lsst::cpputils::python::WrapperCollection &
         cls.def(py::init<PsfFluxAlgorithm::Control const &, std::string const &, afw::table::Schema &,
                         std::string const &>(),
                 "ctrl"_a, "name"_a, "schema"_a, "logName"_a);
+
+        cls.def("computePsfImage", &PsfFluxAlgorithm::computePsfImage, "psf"_a, "position"_a);
+        cls.def("measureCatalog", &PsfFluxAlgorithm::measureCatalog, "measCat"_a, "exposure"_a, "x"_a, "y"_a,
+                "nThreads"_a = 0, py::call_guard<py::gil_scoped_release>());
     });
 }
 
@@ -48,6 +48,7 @@ using PyFluxTransform =
 PyFluxControl declareFluxControl(lsst::cpputils::python::WrapperCollection &wrappers) {
     return wrappers.wrapType(PyFluxControl(wrappers.module, "ScaledApertureFluxControl"), [](auto &mod, auto &cls) {
         LSST_DECLARE_CONTROL_FIELD(cls, ScaledApertureFluxControl, scale);
+        LSST_DECLARE_CONTROL_FIELD(cls, ScaledApertureFluxControl, radiusStep);
         LSST_DECLARE_CONTROL_FIELD(cls, ScaledApertureFluxControl, shiftKernel);
 
         cls.def(py::init<>());
@@ -62,6 +63,8 @@ PyFluxAlgorithm declareFluxAlgorithm(lsst::cpputils::python::WrapperCollection &
 
         cls.def("measure", &ScaledApertureFluxAlgorithm::measure, "measRecord"_a, "exposure"_a);
         cls.def("fail", &ScaledApertureFluxAlgorithm::fail, "measRecord"_a, "error"_a = nullptr);
+        cls.def("cacheCoefficients", &ScaledApertureFluxAlgorithm::cacheCoefficients, "exposure"_a,
+                py::call_guard<py::gil_scoped_release>());
     });
 }
 
@@ -0,0 +1,48 @@
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "pybind11/pybind11.h"
+#include "ndarray/pybind11.h"
+#include "lsst/cpputils/python.h"
+
+#include "lsst/meas/base/SegmentStatistics.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+void wrapSegmentStatistics(lsst::cpputils::python::WrapperCollection &wrappers) {
+    wrappers.wrap([](auto &mod) {
+        mod.def("computeSegmentPercentiles", &computeSegmentPercentiles, "values"_a, "offsets"_a,
+                "percentiles"_a, "nThreads"_a = 1, py::call_guard<py::gil_scoped_release>());
+        mod.def("computeSegmentMads", &computeSegmentMads, "values"_a, "offsets"_a, "nThreads"_a = 1,
+                py::call_guard<py::gil_scoped_release>());
+    });
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -31,13 +31,20 @@ systems if necessary to avoid information loss (this should, of course, be
 indicated in the field documentation).
 """
 
+
+import numpy as np
+
+import lsst.pex.config
 from lsst.utils.logging import PeriodicLogger
 from lsst.utils.timer import timeMethod
 
 from .pluginRegistry import PluginRegistry
 from .baseMeasurement import (BaseMeasurementPluginConfig, BaseMeasurementPlugin,
                               BaseMeasurementConfig, BaseMeasurementTask)
+from .familyScheduler import FamilySchedulerConfig, FamilyScheduler
 from .noiseReplacer import NoiseReplacer, DummyNoiseReplacer
+from .memoryAccounting import getFootprintDictBytes, getSincCoeffsBytes
+from .tracing import traceSpan
 
 __all__ = ("SingleFramePluginConfig", "SingleFramePlugin",
            "SingleFrameMeasurementConfig", "SingleFrameMeasurementTask")
@@ -156,6 +163,16 @@ class SingleFrameMeasurementConfig(BaseMeasurementConfig):
         default=[],
         doc="Plugins to run on undeblended image"
     )
+    blendednessThreads = lsst.pex.config.Field(
+        dtype=int,
+        default=1,
+        doc="Number of threads over which base_Blendedness measures the parent-image metrics of deblend "
+            "families, after noise replacement has ended; 0 for one per hardware thread.",
+    )
+    scheduler = lsst.pex.config.ConfigField(
+        dtype=FamilySchedulerConfig,
+        doc="Ordering of deblend families by predicted cost, and recording of their costs"
+    )
 
 
 class SingleFrameMeasurementTask(BaseMeasurementTask):
@@ -249,6 +266,7 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
         assert measCat.getSchema().contains(self.schema)
         if footprints is None:
             footprints = self.getFootprintsFromCatalog(measCat)
+        self.memory.record("footprints", footprints=lambda: getFootprintDictBytes(footprints))
 
         # noiseReplacer is used to fill the footprints with noise and save
         # heavy footprints of the source pixels so that they can be restored
@@ -257,8 +275,11 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
         # belong to objects in measCat will be replaced with noise
 
         if self.config.doReplaceWithNoise:
-            noiseReplacer = NoiseReplacer(self.config.noiseReplacer, exposure, footprints,
-                                          noiseImage=noiseImage, log=self.log, exposureId=exposureId)
+            with traceSpan("NoiseReplacer setup", "noiseReplacer", nSources=lambda: len(footprints)):
+                noiseReplacer = NoiseReplacer(self.config.noiseReplacer, exposure, footprints,
+                                              noiseImage=noiseImage, log=self.log, exposureId=exposureId)
+            if self.memory.enabled:
+                self.memory.record("noiseReplacer", **noiseReplacer.getMemoryUsage())
             algMetadata = measCat.getMetadata()
             if algMetadata is not None:
                 algMetadata.addInt(self.NOISE_SEED_MULTIPLIER, self.config.noiseReplacer.noiseSeedMultiplier)
@@ -269,7 +290,13 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
         else:
             noiseReplacer = DummyNoiseReplacer()
 
-        self.runPlugins(noiseReplacer, measCat, exposure, beginOrder, endOrder)
+        with traceSpan("SingleFrameMeasurementTask.run", "task", exposureId=exposureId,
+                       nSources=lambda: len(measCat)), \
+                self.approximatePsf(exposure, measCat.getMetadata()), \
+                self.recordSincCoeffsStatistics():
+            self.cacheCoefficients(exposure, beginOrder=beginOrder, endOrder=endOrder)
+            self.runPlugins(noiseReplacer, measCat, exposure, beginOrder, endOrder)
+        self.memory.record("plugins", sincCoeffs=getSincCoeffsBytes)
 
     def runPlugins(self, noiseReplacer, measCat, exposure, beginOrder=None, endOrder=None):
         r"""Call the configured measument plugins on an image.
@@ -309,54 +336,118 @@ class SingleFrameMeasurementTask(BaseMeasurementTask):
         # Wrap the task logger into a period logger
         periodicLog = PeriodicLogger(self.log)
 
-        childrenIter = measCat.getChildren([measParentRecord.getId() for measParentRecord in measParentCat])
-        for parentIdx, (measParentRecord, measChildCat) in enumerate(zip(measParentCat, childrenIter)):
-            # first get all the children of this parent, insert footprint in
-            # turn, and measure
-            # TODO: skip this loop if there are no plugins configured for
-            # single-object mode
-            for measChildRecord in measChildCat:
-                noiseReplacer.insertSource(measChildRecord.getId())
-                self.callMeasure(measChildRecord, exposure, beginOrder=beginOrder, endOrder=endOrder)
-
-                if self.doBlendedness:
-                    self.blendPlugin.cpp.measureChildPixels(exposure.getMaskedImage(), measChildRecord)
-
-                noiseReplacer.removeSource(measChildRecord.getId())
-
-            # Then insert the parent footprint, and measure that
-            noiseReplacer.insertSource(measParentRecord.getId())
-            self.callMeasure(measParentRecord, exposure, beginOrder=beginOrder, endOrder=endOrder)
-
-            if self.doBlendedness:
-                self.blendPlugin.cpp.measureChildPixels(exposure.getMaskedImage(), measParentRecord)
-
-            # Finally, process both parent and child set through measureN
-            self.callMeasureN(measParentCat[parentIdx:parentIdx+1], exposure,
-                              beginOrder=beginOrder, endOrder=endOrder)
-            self.callMeasureN(measChildCat, exposure, beginOrder=beginOrder, endOrder=endOrder)
-            noiseReplacer.removeSource(measParentRecord.getId())
+        measChildCats = list(measCat.getChildren([measParentRecord.getId()
+                                                  for measParentRecord in measParentCat]))
+        scheduler = FamilyScheduler(self.config.scheduler, log=self.log)
+        catalogPluginNames = self.getCatalogPluginNames()
+        nFamiliesDone = 0
+
+        def measureFamily(parentIdx):
+            nonlocal nFamiliesDone
+            # Arguments are lazy, so they cost nothing unless tracing.
+            with traceSpan("family", "family", parent=lambda: measParentCat[parentIdx].getId(),
+                           nChildren=lambda: len(measChildCats[parentIdx])):
+                self.measureFamily(noiseReplacer, measParentCat[parentIdx:parentIdx+1],
+                                   measChildCats[parentIdx], exposure, beginOrder=beginOrder,
+                                   endOrder=endOrder, skipPlugins=catalogPluginNames)
+            nFamiliesDone += 1
             # Log a message if it has been a while since the last log.
             periodicLog.log("Measurement complete for %d parents (and their children) out of %d",
-                            parentIdx + 1, nMeasParentCat)
+                            nFamiliesDone, nMeasParentCat)
+
+        schedulerConfig = self.config.scheduler
+        if schedulerConfig.orderByCost or schedulerConfig.doRecordCosts:
+            costs = scheduler.predictCosts(measParentCat, measChildCats, self.plugins.iter(),
+                                           self.plugins.iterN())
+        else:
+            costs = np.zeros(nMeasParentCat, dtype=float)
+        with traceSpan("families", "stage", nFamilies=nMeasParentCat):
+            actualCosts = scheduler.run(measureFamily, costs)
+        if schedulerConfig.doRecordCosts:
+            scheduler.recordCosts(self.metadata, costs, actualCosts)
 
         # When done, restore the exposure to its original state
         noiseReplacer.end()
 
+        # Plugins with a catalog-level implementation were skipped above, and
+        # measure all sources at once here.
+        if self.config.doMeasureCatalog:
+            with traceSpan("catalog plugins", "stage"):
+                self.callMeasureCatalog(measCat, exposure, beginOrder=beginOrder, endOrder=endOrder)
+
         # Undeblended plugins only fire if we're running everything
         if endOrder is None:
-            for sourceIndex, source in enumerate(measCat):
-                for plugin in self.undeblendedPlugins.iter():
-                    self.doMeasurement(plugin, source, exposure)
-                # Log a message if it has been a while since the last log.
-                periodicLog.log("Undeblended measurement complete for %d sources out of %d",
-                                sourceIndex + 1, nMeasCat)
-
-        # Now we loop over all of the sources one more time to compute the
-        # blendedness metrics
+            with traceSpan("undeblended plugins", "stage"):
+                for sourceIndex, source in enumerate(measCat):
+                    for plugin in self.undeblendedPlugins.iter():
+                        self.doMeasurement(plugin, source, exposure)
+                    # Log a message if it has been a while since the last log.
+                    periodicLog.log("Undeblended measurement complete for %d sources out of %d",
+                                    sourceIndex + 1, nMeasCat)
+
+        # Now compute the parent-image blendedness metrics of all sources,
+        # one deblend family at a time.
         if self.doBlendedness:
-            for source in measCat:
-                self.blendPlugin.cpp.measureParentPixels(exposure.getMaskedImage(), source)
+            with traceSpan("Blendedness.measureCatalogParentPixels", "stage"):
+                self.blendPlugin.cpp.measureCatalogParentPixels(exposure.getMaskedImage(), measCat,
+                                                                nThreads=self.config.blendednessThreads)
+
+    def measureFamily(self, noiseReplacer, measParentCat, measChildCat, exposure, beginOrder=None,
+                      endOrder=None, skipPlugins=()):
+        r"""Measure a parent source and its children.
+
+        Parameters
+        ----------
+        noiseReplacer : `NoiseReplacer`
+            Used to fill sources not being measured with noise.
+        measParentCat : `lsst.afw.table.SourceCatalog`
+            Catalog containing only the parent record.
+        measChildCat : `lsst.afw.table.SourceCatalog`
+            Catalog of the children of the parent.
+        exposure : `lsst.afw.image.ExposureF`
+            Image containing the pixel data to be measured together with
+            associated PSF, WCS, etc.
+        beginOrder : `float`, optional
+            Start execution order (inclusive): measurements with
+            ``executionOrder < beginOrder`` are not executed. `None` for no
+            limit.
+        endOrder : `float`, optional
+            Final execution order (exclusive): measurements with
+            ``executionOrder >= endOrder`` are not executed. `None` for no
+            limit.
+        skipPlugins : collection of `str`, optional
+            Names of plugins to skip, because they are run on the whole
+            catalog instead.
+        """
+        measParentRecord = measParentCat[0]
+        # first get all the children of this parent, insert footprint in
+        # turn, and measure
+        # TODO: skip this loop if there are no plugins configured for
+        # single-object mode
+        for measChildRecord in measChildCat:
+            noiseReplacer.insertSource(measChildRecord.getId())
+            self.callMeasure(measChildRecord, exposure, beginOrder=beginOrder, endOrder=endOrder,
+                             skipPlugins=skipPlugins)
+
+            if self.doBlendedness:
+                with traceSpan("Blendedness.measureChildPixels", "plugin"):
+                    self.blendPlugin.cpp.measureChildPixels(exposure.getMaskedImage(), measChildRecord)
+
+            noiseReplacer.removeSource(measChildRecord.getId())
+
+        # Then insert the parent footprint, and measure that
+        noiseReplacer.insertSource(measParentRecord.getId())
+        self.callMeasure(measParentRecord, exposure, beginOrder=beginOrder, endOrder=endOrder,
+                         skipPlugins=skipPlugins)
+
+        if self.doBlendedness:
+            with traceSpan("Blendedness.measureChildPixels", "plugin"):
+                self.blendPlugin.cpp.measureChildPixels(exposure.getMaskedImage(), measParentRecord)
+
+        # Finally, process both parent and child set through measureN
+        self.callMeasureN(measParentCat, exposure, beginOrder=beginOrder, endOrder=endOrder)
+        self.callMeasureN(measChildCat, exposure, beginOrder=beginOrder, endOrder=endOrder)
+        noiseReplacer.removeSource(measParentRecord.getId())
 
     def measure(self, measCat, exposure):
         """Backwards-compatibility alias for `run`.
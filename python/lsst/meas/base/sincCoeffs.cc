@@ -21,6 +21,7 @@
  */
 
 #include "pybind11/pybind11.h"
+#include "pybind11/stl.h"
 #include "lsst/cpputils/python.h"
 
 #include "lsst/meas/base/SincCoeffs.h"
@@ -40,6 +41,33 @@ void declareSincCoeffs(lsst::cpputils::python::WrapperCollection &wrappers, std:
     wrappers.wrapType(py::class_<SincCoeffs<T>>(wrappers.module, className.c_str()), [](auto &mod, auto &cls) {
         cls.def_static("cache", &SincCoeffs<T>::cache, "rInner"_a, "rOuter"_a);
         cls.def_static("get", &SincCoeffs<T>::get, "outerEllipse"_a, "innerRadiusFactor"_a);
+        cls.def_static("getInterpolated", &SincCoeffs<T>::getInterpolated, "radius"_a, "radiusStep"_a);
+        cls.def_static("cacheInterpolated", &SincCoeffs<T>::cacheInterpolated, "rMin"_a, "rMax"_a,
+                       "radiusStep"_a);
+        cls.def_static("getCacheBytes", &SincCoeffs<T>::getCacheBytes);
+        cls.def_static("getCacheStatistics", &SincCoeffs<T>::getCacheStatistics);
+        cls.def_static("getCacheEntries", &SincCoeffs<T>::getCacheEntries);
+        cls.def_static("resetCacheStatistics", &SincCoeffs<T>::resetCacheStatistics);
+        cls.def_static("setCacheCapacity", &SincCoeffs<T>::setCacheCapacity, "capacity"_a);
+        cls.def_static("getCacheCapacity", &SincCoeffs<T>::getCacheCapacity);
+        cls.def_static("clearCache", &SincCoeffs<T>::clearCache);
+
+        using Statistics = typename SincCoeffs<T>::CacheStatistics;
+        py::class_<Statistics> clsStatistics(cls, "CacheStatistics");
+        clsStatistics.def_readonly("hits", &Statistics::hits);
+        clsStatistics.def_readonly("misses", &Statistics::misses);
+        clsStatistics.def_readonly("evictions", &Statistics::evictions);
+        clsStatistics.def_readonly("computeTime", &Statistics::computeTime);
+        clsStatistics.def_readonly("entries", &Statistics::entries);
+        clsStatistics.def_readonly("bytes", &Statistics::bytes);
+
+        using Entry = typename SincCoeffs<T>::CacheEntry;
+        py::class_<Entry> clsEntry(cls, "CacheEntry");
+        clsEntry.def_readonly("radius", &Entry::radius);
+        clsEntry.def_readonly("innerFactor", &Entry::innerFactor);
+        clsEntry.def_readonly("bytes", &Entry::bytes);
+        clsEntry.def_readonly("hits", &Entry::hits);
+        clsEntry.def_readonly("computeTime", &Entry::computeTime);
     });
 }
 
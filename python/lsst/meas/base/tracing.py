@@ -0,0 +1,222 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Optional timeline tracing of measurement stages.
+
+Traces are recorded in the Chrome trace-event format, which can be viewed
+with ``chrome://tracing`` or https://ui.perfetto.dev.  Tracing is off unless
+it is enabled with `enableTracing` or by setting the environment variable
+named by `TRACE_FILE_ENV` to the path of the file to write when the process
+exits; while it is off, `traceSpan` returns a shared no-op context manager.
+Arguments that are costly to compute may be passed to `traceSpan` as
+callables, which are only called while tracing is on.
+
+A recorder keeps at most ``maxEvents`` events (`DEFAULT_MAX_EVENTS` unless
+given to `enableTracing`), so that tracing a long run cannot exhaust memory;
+later events are counted but not kept, and the count is written to the
+trace's ``otherData`` as ``droppedEvents``.
+"""
+
+__all__ = ("TRACE_FILE_ENV", "DEFAULT_MAX_EVENTS", "TraceRecorder", "enableTracing", "disableTracing",
+           "isTracing", "traceSpan")
+
+import atexit
+import contextlib
+import json
+import os
+import threading
+import time
+
+TRACE_FILE_ENV = "MEAS_BASE_TRACE_FILE"
+"""Environment variable that, if set, enables tracing for the whole process
+and gives the file the trace is written to on exit (`str`)."""
+
+DEFAULT_MAX_EVENTS = 1000000
+"""Default maximum number of events a `TraceRecorder` keeps (`int`); each
+takes a few hundred bytes."""
+
+
+class TraceRecorder:
+    """A thread-safe collection of trace events.
+
+    Parameters
+    ----------
+    path : `str`, optional
+        File to write the trace to when it is finished.
+    maxEvents : `int`, optional
+        Maximum number of events to keep; later events are only counted.
+
+    Attributes
+    ----------
+    nDropped : `int`
+        Number of events not kept because ``maxEvents`` was reached.
+    """
+
+    def __init__(self, path=None, maxEvents=DEFAULT_MAX_EVENTS):
+        self.path = path
+        self.maxEvents = maxEvents
+        self.nDropped = 0
+        self._events = []
+        self._lock = threading.Lock()
+        self._pid = os.getpid()
+        self._origin = time.perf_counter_ns()
+
+    def __len__(self):
+        return len(self._events)
+
+    @contextlib.contextmanager
+    def span(self, name, category, args=None):
+        """Record the duration of a ``with`` block as a complete event.
+
+        Parameters
+        ----------
+        name : `str`
+            Name of the event.
+        category : `str`
+            Category of the event.
+        args : `dict`, optional
+            Additional JSON-serializable values to attach to the event.
+            Callable values are replaced by the result of calling them.
+        """
+        if args:
+            args = {key: value() if callable(value) else value for key, value in args.items()}
+        start = time.perf_counter_ns()
+        try:
+            yield
+        finally:
+            end = time.perf_counter_ns()
+            event = {
+                "name": name,
+                "cat": category,
+                "ph": "X",
+                "ts": (start - self._origin)/1000.0,
+                "dur": (end - start)/1000.0,
+                "pid": self._pid,
+                "tid": threading.get_ident(),
+            }
+            if args:
+                event["args"] = args
+            with self._lock:
+                if len(self._events) < self.maxEvents:
+                    self._events.append(event)
+                else:
+                    self.nDropped += 1
+
+    def toDict(self):
+        """Return the trace as a JSON-serializable `dict`.
+        """
+        with self._lock:
+            events = list(self._events)
+            nDropped = self.nDropped
+        result = {"traceEvents": events, "displayTimeUnit": "ms"}
+        if nDropped:
+            result["otherData"] = {"droppedEvents": nDropped}
+        return result
+
+    def write(self, path=None):
+        """Write the trace to a file.
+
+        Parameters
+        ----------
+        path : `str`, optional
+            File to write to; defaults to ``self.path``.
+        """
+        path = path if path is not None else self.path
+        with open(path, "w") as stream:
+            json.dump(self.toDict(), stream)
+
+
+_recorder = None
+_NO_SPAN = contextlib.nullcontext()
+
+
+def enableTracing(path=None, maxEvents=DEFAULT_MAX_EVENTS):
+    """Start recording trace events, replacing any current recorder.
+
+    Parameters
+    ----------
+    path : `str`, optional
+        File to write the trace to when `disableTracing` is called.
+    maxEvents : `int`, optional
+        Maximum number of events to keep.
+
+    Returns
+    -------
+    recorder : `TraceRecorder`
+        The new recorder.
+    """
+    global _recorder
+    _recorder = TraceRecorder(path, maxEvents=maxEvents)
+    return _recorder
+
+
+def disableTracing():
+    """Stop recording trace events, writing them to the recorder's file if
+    it has one.
+
+    Returns
+    -------
+    recorder : `TraceRecorder` or `None`
+        The recorder that was in use, if any.
+    """
+    global _recorder
+    recorder = _recorder
+    _recorder = None
+    if recorder is not None and recorder.path is not None:
+        recorder.write()
+    return recorder
+
+
+def isTracing():
+    """Return whether trace events are being recorded (`bool`).
+    """
+    return _recorder is not None
+
+
+def traceSpan(name, category="measurement", **args):
+    """Return a context manager that records the duration of a ``with``
+    block, if tracing is enabled.
+
+    Parameters
+    ----------
+    name : `str`
+        Name of the event.
+    category : `str`, optional
+        Category of the event.
+    **args
+        Additional JSON-serializable values to attach to the event.  Values
+        may instead be callables returning them, which are only called if
+        tracing is enabled.
+
+    Returns
+    -------
+    span : context manager
+        Records an event on exit, or does nothing if tracing is disabled.
+    """
+    recorder = _recorder
+    if recorder is None:
+        return _NO_SPAN
+    return recorder.span(name, category, args)
+
+
+if os.environ.get(TRACE_FILE_ENV):
+    enableTracing(os.environ[TRACE_FILE_ENV])
+    atexit.register(disableTracing)
@@ -398,7 +398,7 @@ def wrapForcedAlgorithm(AlgClass, executionOrder, name=None, needsMetadata=False
                 return AlgClass(config.makeControl(), name, extractSchemaArg(schemaMapper), **kwargs)
 
     return wrapAlgorithm(WrappedForcedPlugin, AlgClass, executionOrder=executionOrder, name=name,
-                         factory=factory, hasLogName=hasLogName, **kwds)
+                         factory=factory, hasMeasureN=hasMeasureN, hasLogName=hasLogName, **kwds)
 
 
 def wrapSimpleAlgorithm(AlgClass, executionOrder, name=None, needsMetadata=False, hasMeasureN=False,
@@ -463,11 +463,11 @@ def wrapSimpleAlgorithm(AlgClass, executionOrder, name=None, needsMetadata=False
     three.
     """
     return (wrapSingleFrameAlgorithm(AlgClass, executionOrder=executionOrder, name=name,
-                                     needsMetadata=needsMetadata, hasLogName=hasLogName,
-                                     deprecated=deprecated, **kwds),
+                                     needsMetadata=needsMetadata, hasMeasureN=hasMeasureN,
+                                     hasLogName=hasLogName, deprecated=deprecated, **kwds),
             wrapForcedAlgorithm(AlgClass, executionOrder=executionOrder, name=name,
-                                needsMetadata=needsMetadata, hasLogName=hasLogName,
-                                needsSchemaOnly=True, **kwds))
+                                needsMetadata=needsMetadata, hasMeasureN=hasMeasureN,
+                                hasLogName=hasLogName, needsSchemaOnly=True, **kwds))
 
 
 def wrapTransform(transformClass, hasLogName=False):
@@ -531,7 +531,8 @@ class GenericPlugin(BasePlugin):
     Sub-classes should set `ConfigClass` and implement the `measure` and
     `measureN` methods. They may optionally provide alternative
     implementations for the `__init__`, `fail` and `getExecutionOrder`
-    methods.
+    methods, and a `measureCatalog` method that measures all sources at once
+    from precomputed centers.
 
     This default implementation simply adds a field for recording
     a fatal failure of the measurement plugin.
@@ -592,6 +593,40 @@ class GenericPlugin(BasePlugin):
         """
         raise NotImplementedError()
 
+    def measureCatalog(self, measCat, exposure, centers):
+        """Measure all sources in a catalog at once.
+
+        Plugins that do not depend on the pixels of individual sources (and
+        so do not need neighbors to be replaced with noise) may implement
+        this to replace one call to `measure` per source with whole-array
+        operations.  If the measurement task's ``doMeasureCatalog`` is set,
+        it is called once, after all per-source plugins have been run, with
+        the centers of all sources computed by the framework.
+
+        Parameters
+        ----------
+        measCat : `lsst.afw.table.SourceCatalog`
+            Catalog for the sources being measured.
+        exposure : `lsst.afw.image.Exposure`
+            Exposure on which the sources are being measured.
+        centers : `numpy.ndarray`
+            Array of shape ``(len(measCat), 2)`` of the pixel coordinates
+            ``(x, y)`` of each source.
+
+        Raises
+        ------
+        MeasurementError
+            Raised if the measurement fails for a known/justifiable reason;
+            the framework then falls back to calling `measure` on each
+            source.
+        """
+        raise NotImplementedError()
+
+    @property
+    def hasMeasureCatalog(self):
+        """Whether this plugin implements `measureCatalog` (`bool`)."""
+        return type(self).measureCatalog is not GenericPlugin.measureCatalog
+
     def fail(self, measRecord, error=None):
         """Record a measurement failure.
 
@@ -636,6 +671,13 @@ class GenericPlugin(BasePlugin):
             def measureN(self, measCat, exposure, refCat, refWcs):
                 return self._generic.measureN(measCat, exposure, refCat, refWcs)
 
+            def measureCatalog(self, measCat, exposure, centers):
+                return self._generic.measureCatalog(measCat, exposure, centers)
+
+            @property
+            def hasMeasureCatalog(self):
+                return self._generic.hasMeasureCatalog
+
             def fail(self, measRecord, error=None):
                 self._generic.fail(measRecord, error if error is not None else None)
 
@@ -683,6 +725,13 @@ class GenericPlugin(BasePlugin):
             def measureN(self, measCat, exposure, refCat, refWcs):
                 return self._generic.measureN(measCat, exposure, refCat, refWcs)
 
+            def measureCatalog(self, measCat, exposure, centers):
+                return self._generic.measureCatalog(measCat, exposure, centers)
+
+            @property
+            def hasMeasureCatalog(self):
+                return self._generic.hasMeasureCatalog
+
             def fail(self, measRecord, error=None):
                 self._generic.fail(measRecord, error if error is not None else None)
 
@@ -115,12 +115,12 @@ template <typename T>
 std::shared_ptr<afw::image::Image<T> const>
 getSincCoeffs(geom::Box2I const &bbox,                      // measurement image bbox we need to fit inside
               afw::geom::ellipses::Ellipse const &ellipse,  // ellipse that defines the aperture
+              afw::image::Image<T> const &coeffs,           // coefficients of the aperture, centered on 0,0
               ApertureFluxAlgorithm::Result &result,        // result object where we set flags if we do clip
               ApertureFluxAlgorithm::Control const &ctrl    // configuration
 ) {
-std::shared_ptr<afw::image::Image<T> const> cImage = SincCoeffs<T>::get(ellipse.getCore(), 0.0);
-    cImage = afw::math::offsetImage(*cImage, ellipse.getCenter().getX(), ellipse.getCenter().getY(),
-                                    ctrl.shiftKernel);
+    std::shared_ptr<afw::image::Image<T> const> cImage = afw::math::offsetImage(
+            coeffs, ellipse.getCenter().getX(), ellipse.getCenter().getY(), ctrl.shiftKernel);
     if (!bbox.contains(cImage->getBBox())) {
         // We had to clip out at least part part of the coeff image,
         // but since that's much larger than the aperture (and close
@@ -140,6 +140,14 @@ std::shared_ptr<afw::image::Image<T> const> cImage = SincCoeffs<T>::get(ellipse.
     return cImage;
 }
 
+template <typename T>
+std::shared_ptr<afw::image::Image<T> const> getSincCoeffs(geom::Box2I const &bbox,
+                                                          afw::geom::ellipses::Ellipse const &ellipse,
+                                                          ApertureFluxAlgorithm::Result &result,
+                                                          ApertureFluxAlgorithm::Control const &ctrl) {
+    return getSincCoeffs<T>(bbox, ellipse, *SincCoeffs<T>::get(ellipse.getCore(), 0.0), result, ctrl);
+}
+
 }  // namespace
 
 template <typename T>
@@ -158,8 +166,16 @@ template <typename T>
 ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeSincFlux(
         afw::image::MaskedImage<T> const &image, afw::geom::ellipses::Ellipse const &ellipse,
         Control const &ctrl) {
+    return computeSincFlux(image, ellipse, *SincCoeffs<T>::get(ellipse.getCore(), 0.0), ctrl);
+}
+
+template <typename T>
+ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeSincFlux(
+        afw::image::MaskedImage<T> const &image, afw::geom::ellipses::Ellipse const &ellipse,
+        afw::image::Image<T> const &coeffs, Control const &ctrl) {
     Result result;
-    std::shared_ptr<afw::image::Image<T> const> cImage = getSincCoeffs<T>(image.getBBox(), ellipse, result, ctrl);
+    std::shared_ptr<afw::image::Image<T> const> cImage =
+            getSincCoeffs<T>(image.getBBox(), ellipse, coeffs, result, ctrl);
     if (result.getFlag(APERTURE_TRUNCATED.number)) return result;
     afw::image::MaskedImage<T> subImage(image, cImage->getBBox(afw::image::PARENT), afw::image::PARENT);
     result.instFlux = (ndarray::asEigenArray(subImage.getImage()->getArray()) *
@@ -245,6 +261,9 @@ ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeFlux(afw::image::Mas
             afw::image::Image<T> const &, afw::geom::ellipses::Ellipse const &, Control const &);       \
     template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeSincFlux(                      \
             afw::image::MaskedImage<T> const &, afw::geom::ellipses::Ellipse const &, Control const &); \
+    template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeSincFlux(                      \
+            afw::image::MaskedImage<T> const &, afw::geom::ellipses::Ellipse const &,                   \
+            afw::image::Image<T> const &, Control const &);                                             \
     template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeNaiveFlux(                     \
             afw::image::Image<T> const &, afw::geom::ellipses::Ellipse const &, Control const &);       \
     template ApertureFluxAlgorithm::Result ApertureFluxAlgorithm::computeNaiveFlux(                     \
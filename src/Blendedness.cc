@@ -22,11 +22,17 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "boost/math/constants/constants.hpp"
 
 #include "lsst/meas/base/Blendedness.h"
+#include "lsst/meas/base/ParallelUtilities.h"
 #include "lsst/afw/detection/HeavyFootprint.h"
 #include "lsst/meas/base/exceptions.h"
 #include "lsst/afw/geom/ellipses/Ellipse.h"
@@ -190,6 +196,112 @@ void computeMoments(afw::image::MaskedImage<float> const& image, geom::Point2D c
     }
 }
 
+// Return the spans of the weight region of a source, clipped to the image.
+std::vector<afw::geom::Span> computeWeightSpans(geom::Box2I const& bbox, geom::Point2D const& centroid,
+                                                afw::geom::ellipses::Quadrupole const& shape,
+                                                double nSigmaWeightMax) {
+    afw::geom::ellipses::Ellipse ellipse(shape, centroid);
+    ellipse.getCore().scale(nSigmaWeightMax);
+    afw::geom::ellipses::PixelRegion region(ellipse);
+    std::vector<afw::geom::Span> spans;
+    for (auto const& span : region) {
+        if (span.getY() < bbox.getMinY() || span.getY() > bbox.getMaxY()) {
+            continue;
+        }
+        afw::geom::Span clipped(span.getY(), std::max(span.getMinX(), bbox.getMinX()),
+                                std::min(span.getMaxX(), bbox.getMaxX()));
+        if (clipped.getMinX() <= clipped.getMaxX()) {
+            spans.push_back(clipped);
+        }
+    }
+    return spans;
+}
+
+/*
+ *  Compute the moments of several sources (typically a deblend family) in one raster scan over the
+ *  rows of the union of their weight regions.
+ *
+ *  Each pixel's absolute-value expectation and bias, the most expensive part of the computation, is
+ *  evaluated once however many weight regions include it.  The pixels of each source are accumulated
+ *  in the same order as by computeMoments, so the results are identical.
+ */
+template <typename Accumulator>
+void computeFamilyMoments(afw::image::MaskedImage<float> const& image,
+                          std::vector<geom::Point2D> const& centroids,
+                          std::vector<afw::geom::ellipses::Quadrupole> const& shapes, double nSigmaWeightMax,
+                          std::vector<Accumulator>& accumulatorsRaw,
+                          std::vector<Accumulator>& accumulatorsAbs) {
+    geom::Box2I const bbox = image.getBBox(afw::image::PARENT);
+    std::size_t const nSources = centroids.size();
+    std::vector<geom::LinearTransform> transforms;
+    std::vector<std::vector<afw::geom::Span>> sourceSpans;
+    transforms.reserve(nSources);
+    sourceSpans.reserve(nSources);
+    int minY = std::numeric_limits<int>::max();
+    int maxY = std::numeric_limits<int>::min();
+    for (std::size_t i = 0; i < nSources; ++i) {
+        transforms.push_back(shapes[i].getGridTransform());
+        sourceSpans.push_back(computeWeightSpans(bbox, centroids[i], shapes[i], nSigmaWeightMax));
+        if (!sourceSpans.back().empty()) {
+            minY = std::min(minY, sourceSpans.back().front().getY());
+            maxY = std::max(maxY, sourceSpans.back().back().getY());
+        }
+    }
+    if (minY > maxY) {
+        return;
+    }
+    // The spans in each row of the tile, with the index of the source they belong to.
+    std::vector<std::vector<std::pair<std::size_t, afw::geom::Span>>> rows(maxY - minY + 1);
+    for (std::size_t i = 0; i < nSources; ++i) {
+        for (auto const& span : sourceSpans[i]) {
+            rows[span.getY() - minY].emplace_back(i, span);
+        }
+    }
+    std::vector<float> dataRow(bbox.getWidth());
+    std::vector<float> absRow(bbox.getWidth());
+    for (auto& row : rows) {
+        if (row.empty()) {
+            continue;
+        }
+        int const y = row.front().second.getY();
+        // Evaluate every pixel covered by at least one span exactly once.
+        std::sort(row.begin(), row.end(), [](auto const& a, auto const& b) {
+            return a.second.getMinX() < b.second.getMinX();
+        });
+        int done = bbox.getMinX() - 1;
+        for (auto const& entry : row) {
+            int const begin = std::max(entry.second.getMinX(), done + 1);
+            int const end = entry.second.getMaxX();
+            if (begin > end) {
+                continue;
+            }
+            auto pixelIter = image.x_at(begin - image.getX0(), y - image.getY0());
+            for (int x = begin; x <= end; ++x, ++pixelIter) {
+                float data = pixelIter.image();
+                float variance = pixelIter.variance();
+                float mu = BlendednessAlgorithm::computeAbsExpectation(data, variance);
+                float bias = BlendednessAlgorithm::computeAbsBias(mu, variance);
+                dataRow[x - bbox.getMinX()] = data;
+                absRow[x - bbox.getMinX()] = std::abs(data) - bias;
+            }
+            done = end;
+        }
+        for (auto const& entry : row) {
+            std::size_t const i = entry.first;
+            afw::geom::Span const& span = entry.second;
+            for (int x = span.getMinX(); x <= span.getMaxX(); ++x) {
+                geom::Extent2D d = geom::Point2D(geom::Point2I(x, y)) - centroids[i];
+                geom::Extent2D td = transforms[i](d);
+                // use single precision for faster exp, as in computeMoments
+                float weight = std::exp(static_cast<float>(-0.5 * td.computeSquaredNorm()));
+                std::size_t const k = x - bbox.getMinX();
+                accumulatorsRaw[i](d.getX(), d.getY(), weight, dataRow[k]);
+                accumulatorsAbs[i](d.getX(), d.getY(), weight, absRow[k]);
+            }
+        }
+    }
+}
+
 }  // namespace
 
 BlendednessAlgorithm::BlendednessAlgorithm(Control const& ctrl, std::string const& name,
@@ -273,12 +385,7 @@ float BlendednessAlgorithm::computeAbsBias(float mu, float variance) {
            mu * std::erfc(mu / std::sqrt(2.0f * variance));
 }
 
-void BlendednessAlgorithm::_measureMoments(afw::image::MaskedImage<float> const& image,
-                                           afw::table::SourceRecord& child,
-                                           afw::table::Key<double> const& instFluxRawKey,
-                                           afw::table::Key<double> const& instFluxAbsKey,
-                                           ShapeResultKey const& _shapeRawKey,
-                                           ShapeResultKey const& _shapeAbsKey) const {
+bool BlendednessAlgorithm::_checkMomentInputs(afw::table::SourceRecord& child) const {
     if (_ctrl.doFlux || _ctrl.doShape) {
         if (!child.getTable()->getCentroidSlot().getMeasKey().isValid()) {
             throw LSST_EXCEPT(pex::exceptions::LogicError,
@@ -319,8 +426,18 @@ void BlendednessAlgorithm::_measureMoments(afw::image::MaskedImage<float> const&
             _flagHandler.setValue(child, FAILURE.number, true);
             fatal = true;
         }
-        if (fatal) return;
+        return !fatal;
     }
+    return true;
+}
+
+void BlendednessAlgorithm::_measureMoments(afw::image::MaskedImage<float> const& image,
+                                           afw::table::SourceRecord& child,
+                                           afw::table::Key<double> const& instFluxRawKey,
+                                           afw::table::Key<double> const& instFluxAbsKey,
+                                           ShapeResultKey const& _shapeRawKey,
+                                           ShapeResultKey const& _shapeAbsKey) const {
+    if (!_checkMomentInputs(child)) return;
 
     if (_ctrl.doShape) {
         ShapeAccumulator accumulatorRaw;
@@ -354,6 +471,72 @@ void BlendednessAlgorithm::measureParentPixels(afw::image::MaskedImage<float> co
         child.set(_old, computeOldBlendedness(child.getFootprint(), *image.getImage()));
     }
     _measureMoments(image, child, _instFluxParentRaw, _instFluxParentAbs, _shapeParentRaw, _shapeParentAbs);
+    _setParentRatios(child);
+}
+
+void BlendednessAlgorithm::measureCatalogParentPixels(afw::image::MaskedImage<float> const& image,
+                                                      afw::table::SourceCatalog const& catalog,
+                                                      int nThreads) const {
+    // Group the records into families by their parent, so each family is tiled once.
+    std::vector<std::vector<std::size_t>> families;
+    std::unordered_map<afw::table::RecordId, std::size_t> familyIndices;
+    for (std::size_t k = 0; k < catalog.size(); ++k) {
+        afw::table::SourceRecord const& record = catalog[k];
+        afw::table::RecordId const familyId = record.getParent() == 0 ? record.getId() : record.getParent();
+        auto inserted = familyIndices.emplace(familyId, families.size());
+        if (inserted.second) {
+            families.emplace_back();
+        }
+        families[inserted.first->second].push_back(k);
+    }
+    parallelFor(families.size(), nThreads, [&](std::size_t f) {
+        std::vector<std::size_t> const& family = families[f];
+        std::vector<std::size_t> measured;
+        std::vector<geom::Point2D> centroids;
+        std::vector<afw::geom::ellipses::Quadrupole> shapes;
+        for (std::size_t k : family) {
+            afw::table::SourceRecord& child = *catalog.get(k);
+            if (_ctrl.doOld) {
+                child.set(_old, computeOldBlendedness(child.getFootprint(), *image.getImage()));
+            }
+            if ((_ctrl.doFlux || _ctrl.doShape) && _checkMomentInputs(child)) {
+                measured.push_back(k);
+                centroids.push_back(child.getCentroid());
+                shapes.push_back(child.getShape());
+            }
+        }
+        if (_ctrl.doShape) {
+            std::vector<ShapeAccumulator> accumulatorsRaw(measured.size());
+            std::vector<ShapeAccumulator> accumulatorsAbs(measured.size());
+            computeFamilyMoments(image, centroids, shapes, _ctrl.nSigmaWeightMax, accumulatorsRaw,
+                                 accumulatorsAbs);
+            for (std::size_t i = 0; i < measured.size(); ++i) {
+                afw::table::SourceRecord& child = *catalog.get(measured[i]);
+                if (_ctrl.doFlux) {
+                    child.set(_instFluxParentRaw, accumulatorsRaw[i].getFlux());
+                    child.set(_instFluxParentAbs, std::max(accumulatorsAbs[i].getFlux(), 0.0));
+                }
+                _shapeParentRaw.set(child, accumulatorsRaw[i].getShape());
+                _shapeParentAbs.set(child, accumulatorsAbs[i].getShape());
+            }
+        } else if (_ctrl.doFlux) {
+            std::vector<FluxAccumulator> accumulatorsRaw(measured.size());
+            std::vector<FluxAccumulator> accumulatorsAbs(measured.size());
+            computeFamilyMoments(image, centroids, shapes, _ctrl.nSigmaWeightMax, accumulatorsRaw,
+                                 accumulatorsAbs);
+            for (std::size_t i = 0; i < measured.size(); ++i) {
+                afw::table::SourceRecord& child = *catalog.get(measured[i]);
+                child.set(_instFluxParentRaw, accumulatorsRaw[i].getFlux());
+                child.set(_instFluxParentAbs, std::max(accumulatorsAbs[i].getFlux(), 0.0));
+            }
+        }
+        for (std::size_t k : family) {
+            _setParentRatios(*catalog.get(k));
+        }
+    });
+}
+
+void BlendednessAlgorithm::_setParentRatios(afw::table::SourceRecord& child) const {
     if (_ctrl.doFlux) {
         child.set(_raw, 1.0 - child.get(_instFluxChildRaw) / child.get(_instFluxParentRaw));
         child.set(_abs, 1.0 - child.get(_instFluxChildAbs) / child.get(_instFluxParentAbs));
@@ -0,0 +1,221 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <utility>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/meas/base/FootprintIndex.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+std::vector<geom::Box2I> getFootprintBBoxes(afw::table::SourceCatalog const& catalog) {
+    std::vector<geom::Box2I> boxes;
+    boxes.reserve(catalog.size());
+    for (auto const& record : catalog) {
+        auto const& footprint = record.getFootprint();
+        boxes.push_back(footprint ? footprint->getBBox() : geom::Box2I());
+    }
+    return boxes;
+}
+
+ndarray::Array<std::int64_t, 1, 1> toSortedArray(std::vector<std::size_t>& indices) {
+    std::sort(indices.begin(), indices.end());
+    ndarray::Array<std::int64_t, 1, 1> result = ndarray::allocate(indices.size());
+    std::copy(indices.begin(), indices.end(), result.begin());
+    return result;
+}
+
+// Return the root of an item in a union-find forest, halving the path as it goes.
+std::size_t findRoot(std::vector<std::size_t>& parents, std::size_t i) {
+    while (parents[i] != i) {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+    }
+    return i;
+}
+
+}  // namespace
+
+FootprintIndex::FootprintIndex(afw::table::SourceCatalog const& catalog, int nodeCapacity)
+        : FootprintIndex(getFootprintBBoxes(catalog), nodeCapacity) {}
+
+FootprintIndex::FootprintIndex(std::vector<geom::Box2I> const& boxes, int nodeCapacity) : _bboxes(boxes) {
+    if (nodeCapacity < 2) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Node capacity must be at least 2, not %d") % nodeCapacity).str());
+    }
+    _entries.reserve(_bboxes.size());
+    for (std::size_t i = 0; i < _bboxes.size(); ++i) {
+        if (!_bboxes[i].isEmpty()) {
+            _entries.push_back(Entry{_bboxes[i], i});
+        }
+    }
+    _build(nodeCapacity);
+}
+
+void FootprintIndex::_build(std::size_t nodeCapacity) {
+    // Sort-Tile-Recursive packing of one level: sort into ceil(sqrt(nNodes)) vertical slabs of whole
+    // nodes by x, sort each slab by y, and group runs of nodeCapacity items into nodes.  Centers are
+    // compared at twice their values to stay in integers.
+    auto pack = [nodeCapacity](auto& items) {
+        std::size_t const nItems = items.size();
+        std::size_t const nNodes = (nItems + nodeCapacity - 1) / nodeCapacity;
+        std::size_t const nSlabs = static_cast<std::size_t>(std::ceil(std::sqrt(nNodes)));
+        std::size_t const slabSize = ((nNodes + nSlabs - 1) / nSlabs) * nodeCapacity;
+        std::sort(items.begin(), items.end(), [](auto const& a, auto const& b) {
+            return a.bbox.getMinX() + a.bbox.getMaxX() < b.bbox.getMinX() + b.bbox.getMaxX();
+        });
+        for (std::size_t begin = 0; begin < nItems; begin += slabSize) {
+            std::sort(items.begin() + begin, items.begin() + std::min(nItems, begin + slabSize),
+                      [](auto const& a, auto const& b) {
+                          return a.bbox.getMinY() + a.bbox.getMaxY() < b.bbox.getMinY() + b.bbox.getMaxY();
+                      });
+        }
+        std::vector<Node> nodes;
+        nodes.reserve(nNodes);
+        for (std::size_t begin = 0; begin < nItems; begin += nodeCapacity) {
+            std::size_t const end = std::min(nItems, begin + nodeCapacity);
+            Node node{items[begin].bbox, begin, end};
+            for (std::size_t k = begin + 1; k < end; ++k) {
+                node.bbox.include(items[k].bbox);
+            }
+            nodes.push_back(node);
+        }
+        return nodes;
+    };
+
+    _levels.clear();
+    if (_entries.empty()) {
+        return;
+    }
+    _levels.push_back(pack(_entries));
+    while (_levels.back().size() > 1) {
+        std::vector<Node> upper = pack(_levels.back());
+        _levels.push_back(std::move(upper));
+    }
+}
+
+template <typename Function>
+void FootprintIndex::_visit(geom::Box2I const& region, Function&& func) const {
+    if (_levels.empty() || region.isEmpty()) {
+        return;
+    }
+    // Depth-first traversal; each stack item is a (level, node) pair.
+    std::vector<std::pair<std::size_t, std::size_t>> stack;
+    stack.emplace_back(_levels.size() - 1, 0);
+    while (!stack.empty()) {
+        std::size_t const level = stack.back().first;
+        Node const& node = _levels[level][stack.back().second];
+        stack.pop_back();
+        if (!node.bbox.overlaps(region)) {
+            continue;
+        }
+        if (level == 0) {
+            for (std::size_t k = node.begin; k < node.end; ++k) {
+                if (_entries[k].bbox.overlaps(region)) {
+                    func(_entries[k].index);
+                }
+            }
+        } else {
+            for (std::size_t k = node.begin; k < node.end; ++k) {
+                stack.emplace_back(level - 1, k);
+            }
+        }
+    }
+}
+
+geom::Box2I FootprintIndex::getBBox(std::size_t i) const {
+    if (i >= _bboxes.size()) {
+        throw LSST_EXCEPT(pex::exceptions::OutOfRangeError,
+                          (boost::format("Index %d out of range for %d items") % i % _bboxes.size()).str());
+    }
+    return _bboxes[i];
+}
+
+geom::Box2I FootprintIndex::getBBox() const {
+    return _levels.empty() ? geom::Box2I() : _levels.back().front().bbox;
+}
+
+ndarray::Array<std::int64_t, 1, 1> FootprintIndex::query(geom::Box2I const& region) const {
+    std::vector<std::size_t> found;
+    _visit(region, [&found](std::size_t index) { found.push_back(index); });
+    return toSortedArray(found);
+}
+
+ndarray::Array<std::int64_t, 1, 1> FootprintIndex::queryNeighbors(std::size_t i) const {
+    std::vector<std::size_t> found;
+    _visit(getBBox(i), [&found, i](std::size_t index) {
+        if (index != i) {
+            found.push_back(index);
+        }
+    });
+    return toSortedArray(found);
+}
+
+ndarray::Array<std::int64_t, 1, 1> FootprintIndex::computeOverlapGroups() const {
+    std::size_t const nInputs = _bboxes.size();
+    std::vector<std::size_t> parents(nInputs);
+    std::iota(parents.begin(), parents.end(), 0);
+    for (auto const& entry : _entries) {
+        _visit(entry.bbox, [&parents, &entry](std::size_t index) {
+            // Each overlapping pair is seen from both sides; merging once is enough.
+            if (index > entry.index) {
+                std::size_t const a = findRoot(parents, entry.index);
+                std::size_t const b = findRoot(parents, index);
+                if (a != b) {
+                    parents[std::max(a, b)] = std::min(a, b);
+                }
+            }
+        });
+    }
+    ndarray::Array<std::int64_t, 1, 1> labels = ndarray::allocate(nInputs);
+    std::vector<std::int64_t> rootLabels(nInputs, -1);
+    std::int64_t nGroups = 0;
+    for (std::size_t i = 0; i < nInputs; ++i) {
+        if (_bboxes[i].isEmpty()) {
+            labels[i] = -1;
+            continue;
+        }
+        std::int64_t& label = rootLabels[findRoot(parents, i)];
+        if (label < 0) {
+            label = nGroups++;
+        }
+        labels[i] = label;
+    }
+    return labels;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
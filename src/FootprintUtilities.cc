@@ -0,0 +1,45 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "lsst/afw/detection/Footprint.h"
+#include "lsst/meas/base/FootprintUtilities.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+ndarray::Array<std::int32_t, 1, 1> computeFootprintAreas(afw::table::SourceCatalog const& catalog) {
+    ndarray::Array<std::int32_t, 1, 1> result = ndarray::allocate(catalog.size());
+    auto out = result.begin();
+    for (auto const& record : catalog) {
+        auto const& footprint = record.getFootprint();
+        *out++ = footprint ? static_cast<std::int32_t>(footprint->getArea()) : 0;
+    }
+    return result;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,197 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "boost/format.hpp"
+#include "ndarray/eigen.h"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/GridInterpolatedPsf.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+typedef afw::detection::Psf::Image PsfImage;
+
+int computeNodeCount(int size, int spacing) {
+    return std::max(2, static_cast<int>(std::lround(static_cast<double>(size) / spacing)) + 1);
+}
+
+// Accumulate weight*image into the (larger) output image, which must contain image's bbox.
+void accumulate(PsfImage& output, PsfImage const& image, double weight) {
+    PsfImage view(output, image.getBBox(), afw::image::PARENT, false);
+    view.scaledPlus(weight, image);
+}
+
+}  // namespace
+
+GridInterpolatedPsf::GridInterpolatedPsf(std::shared_ptr<afw::detection::Psf const> psf,
+                                         geom::Box2I const& bbox, Control const& ctrl)
+        : _psf(psf), _bbox(bbox), _ctrl(ctrl), _maxKernelError(0.0), _maxShapeError(0.0) {
+    if (!_psf) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Cannot approximate a null Psf");
+    }
+    if (_bbox.isEmpty()) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Grid bounding box must not be empty");
+    }
+    if (_ctrl.gridSpacing <= 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("gridSpacing must be positive; got %d") % _ctrl.gridSpacing).str());
+    }
+    if (_ctrl.nCheckPoints < 1) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("nCheckPoints must be positive; got %d") % _ctrl.nCheckPoints)
+                                  .str());
+    }
+    _nx = computeNodeCount(_bbox.getWidth(), _ctrl.gridSpacing);
+    _ny = computeNodeCount(_bbox.getHeight(), _ctrl.gridSpacing);
+    // Nodes lie on the bbox edges; degenerate (single-pixel) boxes get unit spacing.
+    _dx = std::max(static_cast<double>(_bbox.getMaxX() - _bbox.getMinX()) / (_nx - 1), 1.0);
+    _dy = std::max(static_cast<double>(_bbox.getMaxY() - _bbox.getMinY()) / (_ny - 1), 1.0);
+
+    _kernelImages.reserve(_nx * _ny);
+    _shapes.reserve(_nx * _ny);
+    for (int j = 0; j < _ny; ++j) {
+        for (int i = 0; i < _nx; ++i) {
+            geom::Point2D node(_bbox.getMinX() + i * _dx, _bbox.getMinY() + j * _dy);
+            _kernelImages.push_back(_psf->computeKernelImage(node));
+            _shapes.push_back(_psf->computeShape(node));
+        }
+    }
+
+    // Compare against the exact Psf at random positions to bound the interpolation error.
+    std::mt19937 rng(_ctrl.seed);
+    std::uniform_real_distribution<double> xDist(_bbox.getMinX(), _bbox.getMaxX());
+    std::uniform_real_distribution<double> yDist(_bbox.getMinY(), _bbox.getMaxY());
+    for (int n = 0; n < _ctrl.nCheckPoints; ++n) {
+        geom::Point2D position(xDist(rng), yDist(rng));
+        std::shared_ptr<PsfImage> exact = _psf->computeKernelImage(position);
+        std::shared_ptr<PsfImage> approx = doComputeKernelImage(position, afw::image::Color());
+        geom::Box2I unionBBox = exact->getBBox();
+        unionBBox.include(approx->getBBox());
+        PsfImage exactPadded(unionBBox);
+        exactPadded = 0.0;
+        accumulate(exactPadded, *exact, 1.0);
+        PsfImage difference(unionBBox);
+        difference = 0.0;
+        accumulate(difference, *approx, 1.0);
+        difference -= exactPadded;
+        double peak = ndarray::asEigenArray(exactPadded.getArray()).abs().maxCoeff();
+        double maxDiff = ndarray::asEigenArray(difference.getArray()).abs().maxCoeff();
+        _maxKernelError = std::max(_maxKernelError, maxDiff / peak);
+
+        double exactRadius = _psf->computeShape(position).getDeterminantRadius();
+        double approxRadius = doComputeShape(position, afw::image::Color()).getDeterminantRadius();
+        _maxShapeError = std::max(_maxShapeError, std::abs(approxRadius - exactRadius) / exactRadius);
+    }
+}
+
+std::shared_ptr<afw::detection::Psf> GridInterpolatedPsf::clone() const {
+    return std::make_shared<GridInterpolatedPsf>(*this);
+}
+
+std::shared_ptr<afw::detection::Psf> GridInterpolatedPsf::resized(int width, int height) const {
+    return std::make_shared<GridInterpolatedPsf>(_psf->resized(width, height), _bbox, _ctrl);
+}
+
+GridInterpolatedPsf::Weights GridInterpolatedPsf::_computeWeights(geom::Point2D const& position) const {
+    double fx = std::clamp((position.getX() - _bbox.getMinX()) / _dx, 0.0, _nx - 1.0);
+    double fy = std::clamp((position.getY() - _bbox.getMinY()) / _dy, 0.0, _ny - 1.0);
+    int i = std::min(static_cast<int>(fx), _nx - 2);
+    int j = std::min(static_cast<int>(fy), _ny - 2);
+    double tx = fx - i;
+    double ty = fy - j;
+    Weights result;
+    result.index[0] = j * _nx + i;
+    result.index[1] = j * _nx + i + 1;
+    result.index[2] = (j + 1) * _nx + i;
+    result.index[3] = (j + 1) * _nx + i + 1;
+    result.weight[0] = (1.0 - tx) * (1.0 - ty);
+    result.weight[1] = tx * (1.0 - ty);
+    result.weight[2] = (1.0 - tx) * ty;
+    result.weight[3] = tx * ty;
+    return result;
+}
+
+std::shared_ptr<GridInterpolatedPsf::Image> GridInterpolatedPsf::doComputeKernelImage(
+        geom::Point2D const& position, afw::image::Color const& color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeKernelImage(position, color);
+    }
+    Weights weights = _computeWeights(position);
+    auto result = std::make_shared<Image>(doComputeBBox(position, color));
+    *result = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        if (weights.weight[k] != 0.0) {
+            accumulate(*result, *_kernelImages[weights.index[k]], weights.weight[k]);
+        }
+    }
+    return result;
+}
+
+double GridInterpolatedPsf::doComputeApertureFlux(double radius, geom::Point2D const& position,
+                                                  afw::image::Color const& color) const {
+    return _psf->computeApertureFlux(radius, position, color);
+}
+
+afw::geom::ellipses::Quadrupole GridInterpolatedPsf::doComputeShape(geom::Point2D const& position,
+                                                                    afw::image::Color const& color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeShape(position, color);
+    }
+    Weights weights = _computeWeights(position);
+    double ixx = 0.0, iyy = 0.0, ixy = 0.0;
+    for (int k = 0; k < 4; ++k) {
+        afw::geom::ellipses::Quadrupole const& shape = _shapes[weights.index[k]];
+        ixx += weights.weight[k] * shape.getIxx();
+        iyy += weights.weight[k] * shape.getIyy();
+        ixy += weights.weight[k] * shape.getIxy();
+    }
+    return afw::geom::ellipses::Quadrupole(ixx, iyy, ixy);
+}
+
+geom::Box2I GridInterpolatedPsf::doComputeBBox(geom::Point2D const& position,
+                                               afw::image::Color const& color) const {
+    if (!color.isIndeterminate()) {
+        return _psf->computeBBox(position, color);
+    }
+    Weights weights = _computeWeights(position);
+    geom::Box2I bbox;
+    for (int k = 0; k < 4; ++k) {
+        if (weights.weight[k] != 0.0) {
+            bbox.include(_kernelImages[weights.index[k]]->getBBox());
+        }
+    }
+    return bbox;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,82 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/sphgeom/HtmPixelization.h"
+#include "lsst/sphgeom/LonLat.h"
+#include "lsst/sphgeom/UnitVector3d.h"
+#include "lsst/meas/base/HtmUtilities.h"
+#include "lsst/meas/base/ParallelUtilities.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// Number of positions indexed by each parallel work item; large enough to amortize dispatch.
+std::size_t const CHUNK_SIZE = 4096;
+
+}  // namespace
+
+ndarray::Array<std::int64_t, 1, 1> computeHtmIndices(ndarray::Array<double const, 1> const& ra,
+                                                     ndarray::Array<double const, 1> const& dec, int level,
+                                                     int nThreads) {
+    std::size_t const size = ra.getSize<0>();
+    if (dec.getSize<0>() != size) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("ra and dec have different sizes (%d, %d)") % size %
+                           dec.getSize<0>())
+                                  .str());
+    }
+    if (level < 0 || level > sphgeom::HtmPixelization::MAX_LEVEL) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Invalid HTM level %d") % level).str());
+    }
+    sphgeom::HtmPixelization const pixelization(level);
+    ndarray::Array<std::int64_t, 1, 1> result = ndarray::allocate(size);
+    std::size_t const nChunks = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    parallelFor(nChunks, nThreads, [&](std::size_t chunk) {
+        std::size_t const end = std::min(size, (chunk + 1) * CHUNK_SIZE);
+        for (std::size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+            double const lon = ra[i];
+            double const lat = dec[i];
+            if (!std::isfinite(lon) || !std::isfinite(lat) || std::abs(lat) > 90.0) {
+                result[i] = 0;
+                continue;
+            }
+            result[i] = pixelization.index(sphgeom::UnitVector3d(sphgeom::LonLat::fromDegrees(lon, lat)));
+        }
+    });
+    return result;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -0,0 +1,86 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lsst/meas/base/ParallelUtilities.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+int resolveThreadCount(int nThreads) {
+    if (nThreads > 0) {
+        return nThreads;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void parallelFor(std::size_t n, int nThreads, std::function<void(std::size_t)> const& func) {
+    std::size_t const nWorkers = std::min(static_cast<std::size_t>(resolveThreadCount(nThreads)), n);
+    if (nWorkers <= 1) {
+        for (std::size_t i = 0; i < n; ++i) {
+            func(i);
+        }
+        return;
+    }
+    std::atomic<std::size_t> next(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto work = [&]() {
+        for (std::size_t i = next++; i < n && !failed; i = next++) {
+            try {
+                func(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(nWorkers - 1);
+    for (std::size_t k = 1; k < nWorkers; ++k) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
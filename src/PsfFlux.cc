@@ -22,15 +22,25 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
 
+#include "Eigen/Sparse"
+#include "Eigen/SparseCholesky"
+#include "boost/format.hpp"
 #include "ndarray/eigen.h"
 
 #include "lsst/afw/table/Source.h"
 #include "lsst/afw/detection/Psf.h"
 #include "lsst/log/Log.h"
 #include "lsst/afw/geom/SpanSet.h"
+#include "lsst/meas/base/ParallelUtilities.h"
 #include "lsst/meas/base/PsfFlux.h"
 
 namespace lsst {
@@ -48,11 +58,147 @@ FlagDefinition const PsfFluxAlgorithm::EDGE = flagDefinitions.add(
 
 FlagDefinitionList const& PsfFluxAlgorithm::getFlagDefinitions() { return flagDefinitions; }
 
-namespace {}  // namespace
+namespace {
+
+typedef afw::detection::Psf::Image PsfImage;
+typedef afw::detection::Psf::Pixel PsfPixel;
+
+// Floor division that rounds toward negative infinity for negative numerators too.
+int floorDivide(int numerator, int denominator) {
+    int quotient = numerator / denominator;
+    return (numerator % denominator != 0 && (numerator < 0) != (denominator < 0)) ? quotient - 1 : quotient;
+}
+
+afw::image::MaskPixel getBadBits(PsfFluxControl const& ctrl, afw::image::Mask<> const& mask) {
+    afw::image::MaskPixel badBits = 0x0;
+    for (auto const& plane : ctrl.badMaskPlanes) {
+        badBits |= mask.getPlaneBitMask(plane);
+    }
+    return badBits;
+}
+
+// A source participating in a joint fit: its Psf model and the pixels it is fit to.
+struct JointFitComponent {
+    std::shared_ptr<afw::table::SourceRecord> record;
+    std::shared_ptr<PsfImage> model;
+    std::shared_ptr<afw::geom::SpanSet const> spans;
+};
+
+// Dot product of two Psf models over the given pixels, optionally weighted by the variance.
+double dotModels(afw::geom::SpanSet const& spans, PsfImage const& a, PsfImage const& b,
+                 afw::image::Image<afw::image::VariancePixel> const* variance = nullptr) {
+    auto aArray = spans.flatten(a.getArray(), a.getXY0());
+    auto bArray = spans.flatten(b.getArray(), b.getXY0());
+    auto product = ndarray::asEigenArray(aArray) * ndarray::asEigenArray(bArray);
+    if (variance) {
+        auto varArray = spans.flatten(variance->getArray(), variance->getXY0());
+        return (product * ndarray::asEigenArray(varArray).cast<double>()).sum();
+    }
+    return product.sum();
+}
+
+}  // namespace
+
+/*
+ *  Cache of PSF images evaluated at quantized sub-pixel offsets from a reference pixel in each cell.
+ *
+ *  Entries are keyed by (cellX, cellY, phaseX, phaseY), where phase k corresponds to an offset of
+ *  k/subpixelPhases pixels (0 <= k <= subpixelPhases) from the cell's reference pixel.  The cache is
+ *  shared between copies of the algorithm, as measure() is const.  The mutex guards only the map;
+ *  each entry's image is computed once, outside the lock, so threads that need different entries
+ *  do not wait on each other's Psf evaluations.
+ */
+class PsfFluxAlgorithm::PhaseTable {
+public:
+    std::shared_ptr<PsfImage> computeImage(std::shared_ptr<afw::detection::Psf const> const& psf,
+                                           geom::Point2D const& position, Control const& ctrl) {
+        int const nPhases = ctrl.subpixelPhases;
+        geom::Point2I pixel(static_cast<int>(std::floor(position.getX())),
+                            static_cast<int>(std::floor(position.getY())));
+        int const cellX = floorDivide(pixel.getX(), ctrl.phaseCellSize);
+        int const cellY = floorDivide(pixel.getY(), ctrl.phaseCellSize);
+        geom::Point2I reference(cellX * ctrl.phaseCellSize + ctrl.phaseCellSize / 2,
+                                cellY * ctrl.phaseCellSize + ctrl.phaseCellSize / 2);
+        geom::Extent2I shift = pixel - reference;
+        double const fx = (position.getX() - pixel.getX()) * nPhases;
+        double const fy = (position.getY() - pixel.getY()) * nPhases;
+
+        if (!ctrl.interpolatePhases) {
+            auto table = _getEntry(psf, reference, cellX, cellY, std::lround(fx), std::lround(fy), nPhases);
+            // Deep copy, so that callers may modify the image without changing the table.
+            auto result = std::make_shared<PsfImage>(*table, true);
+            result->setXY0(table->getXY0() + shift);
+            return result;
+        }
+
+        int const kx = std::min(static_cast<int>(fx), nPhases - 1);
+        int const ky = std::min(static_cast<int>(fy), nPhases - 1);
+        double const tx = fx - kx;
+        double const ty = fy - ky;
+        std::array<std::shared_ptr<PsfImage const>, 4> entries = {
+                _getEntry(psf, reference, cellX, cellY, kx, ky, nPhases),
+                _getEntry(psf, reference, cellX, cellY, kx + 1, ky, nPhases),
+                _getEntry(psf, reference, cellX, cellY, kx, ky + 1, nPhases),
+                _getEntry(psf, reference, cellX, cellY, kx + 1, ky + 1, nPhases)};
+        std::array<double, 4> weights = {(1.0 - tx) * (1.0 - ty), tx * (1.0 - ty), (1.0 - tx) * ty, tx * ty};
+        geom::Box2I bbox;
+        for (auto const& entry : entries) {
+            bbox.include(entry->getBBox());
+        }
+        bbox.shift(shift);
+        auto result = std::make_shared<PsfImage>(bbox);
+        *result = 0.0;
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            if (weights[i] == 0.0) continue;
+            geom::Box2I entryBBox = entries[i]->getBBox();
+            entryBBox.shift(shift);
+            PsfImage view(*result, entryBBox, afw::image::PARENT, false);
+            view.scaledPlus(weights[i], *entries[i]);
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        std::once_flag computed;
+        std::shared_ptr<PsfImage const> image;
+    };
+
+    std::shared_ptr<PsfImage const> _getEntry(std::shared_ptr<afw::detection::Psf const> const& psf,
+                                              geom::Point2I const& reference, int cellX, int cellY,
+                                              int phaseX, int phaseY, int nPhases) {
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_psf.lock() != psf) {
+                // Threads still using entries for the old Psf keep them alive until they are done.
+                _images.clear();
+                _psf = psf;
+            }
+            auto& slot = _images[std::make_tuple(cellX, cellY, phaseX, phaseY)];
+            if (!slot) {
+                slot = std::make_shared<Entry>();
+            }
+            entry = slot;
+        }
+        // If computeImage throws, the flag is not set and the next caller retries.
+        std::call_once(entry->computed, [&] {
+            geom::Point2D position(reference.getX() + static_cast<double>(phaseX) / nPhases,
+                                   reference.getY() + static_cast<double>(phaseY) / nPhases);
+            entry->image = psf->computeImage(position);
+        });
+        return entry->image;
+    }
+
+    std::mutex _mutex;
+    std::weak_ptr<afw::detection::Psf const> _psf;
+    std::map<std::tuple<int, int, int, int>, std::shared_ptr<Entry>> _images;
+};
 
 PsfFluxAlgorithm::PsfFluxAlgorithm(Control const& ctrl, std::string const& name, afw::table::Schema& schema,
                                    std::string const& logName)
         : _ctrl(ctrl),
+          _phaseTable(std::make_shared<PhaseTable>()),
           _instFluxResultKey(FluxResultKey::addFields(
                   schema, name, "instFlux derived from linear least-squares fit of PSF model")),
           _areaKey(schema.addField<float>(name + "_area", "effective area of PSF", "pixel")),
@@ -62,6 +208,18 @@ PsfFluxAlgorithm::PsfFluxAlgorithm(Control const& ctrl, std::string const& name,
           _centroidExtractor(schema, name) {
     _logName = logName.size() ? logName : name;
     _flagHandler = FlagHandler::addFields(schema, name, getFlagDefinitions());
+    if (_ctrl.subpixelPhases < 0 || _ctrl.phaseCellSize <= 0) {
+        throw LSST_EXCEPT(FatalAlgorithmError,
+                          "PsfFlux subpixelPhases must be non-negative and phaseCellSize positive");
+    }
+}
+
+std::shared_ptr<afw::detection::Psf::Image> PsfFluxAlgorithm::computePsfImage(
+        std::shared_ptr<afw::detection::Psf const> const& psf, geom::Point2D const& position) const {
+    if (_ctrl.subpixelPhases == 0) {
+        return psf->computeImage(position);
+    }
+    return _phaseTable->computeImage(psf, position, _ctrl);
 }
 
 void PsfFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
@@ -72,10 +230,17 @@ void PsfFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
         throw LSST_EXCEPT(FatalAlgorithmError, "PsfFlux algorithm requires a Psf with every exposure");
     }
     geom::Point2D position = _centroidExtractor(measRecord, _flagHandler);
-    std::shared_ptr<afw::detection::Psf::Image> psfImage = psf->computeImage(position);
-    geom::Box2I fitBBox = psfImage->getBBox();
+    std::shared_ptr<afw::detection::Psf::Image> psfImage = computePsfImage(psf, position);
+    _fitPsfModel(measRecord, *psfImage, exposure, getBadBits(_ctrl, *exposure.getMaskedImage().getMask()));
+}
+
+void PsfFluxAlgorithm::_fitPsfModel(afw::table::SourceRecord& measRecord,
+                                    afw::detection::Psf::Image const& psfImage,
+                                    afw::image::Exposure<float> const& exposure,
+                                    afw::image::MaskPixel badBits) const {
+    geom::Box2I fitBBox = psfImage.getBBox();
     fitBBox.clip(exposure.getBBox());
-    if (fitBBox != psfImage->getBBox()) {
+    if (fitBBox != psfImage.getBBox()) {
         _flagHandler.setValue(measRecord, FAILURE.number,
                               true);  // if we had a suspect flag, we'd set that instead
         _flagHandler.setValue(measRecord, EDGE.number, true);
@@ -83,11 +248,6 @@ void PsfFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
     auto fitRegionSpans = std::make_shared<afw::geom::SpanSet>(fitBBox);
     afw::detection::Footprint fitRegion(fitRegionSpans);
     if (!_ctrl.badMaskPlanes.empty()) {
-        afw::image::MaskPixel badBits = 0x0;
-        for (std::vector<std::string>::const_iterator i = _ctrl.badMaskPlanes.begin();
-             i != _ctrl.badMaskPlanes.end(); ++i) {
-            badBits |= exposure.getMaskedImage().getMask()->getPlaneBitMask(*i);
-        }
         fitRegion.setSpans(fitRegion.getSpans()
                                    ->intersectNot(*exposure.getMaskedImage().getMask(), badBits)
                                    ->clippedTo(exposure.getMaskedImage().getMask()->getBBox()));
@@ -97,10 +257,9 @@ void PsfFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
         _flagHandler.setValue(measRecord, FAILURE.number, true);
         return;
     }
-    typedef afw::detection::Psf::Pixel PsfPixel;
     // SpanSet::flatten returns a new ndarray::Array, which must stay in scope
     // while we use an Eigen::Map view of it
-    auto modelNdArray = fitRegion.getSpans()->flatten(psfImage->getArray(), psfImage->getXY0());
+    auto modelNdArray = fitRegion.getSpans()->flatten(psfImage.getArray(), psfImage.getXY0());
     auto dataNdArray = fitRegion.getSpans()->flatten(exposure.getMaskedImage().getImage()->getArray(),
                                                      exposure.getXY0());
     auto varianceNdArray = fitRegion.getSpans()->flatten(exposure.getMaskedImage().getVariance()->getArray(),
@@ -126,6 +285,201 @@ void PsfFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
     measRecord.set(_chi2Key, chi2);
 }
 
+void PsfFluxAlgorithm::measureCatalog(afw::table::SourceCatalog const& measCat,
+                                      afw::image::Exposure<float> const& exposure,
+                                      ndarray::Array<double const, 1> const& x,
+                                      ndarray::Array<double const, 1> const& y, int nThreads) const {
+    std::size_t const nSources = measCat.size();
+    if (x.getSize<0>() != nSources || y.getSize<0>() != nSources) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError,
+                          (boost::format("Position arrays have sizes (%d, %d); catalog has %d records") %
+                           x.getSize<0>() % y.getSize<0>() % nSources)
+                                  .str());
+    }
+    std::shared_ptr<afw::detection::Psf const> psf = exposure.getPsf();
+    if (!psf) {
+        LOGL_ERROR(getLogName(), "PsfFlux: no psf attached to exposure");
+        throw LSST_EXCEPT(FatalAlgorithmError, "PsfFlux algorithm requires a Psf with every exposure");
+    }
+    afw::image::MaskPixel const badBits = getBadBits(_ctrl, *exposure.getMaskedImage().getMask());
+
+    // Order the sources by Psf cell, dropping (and flagging) those without a usable position.
+    std::vector<std::tuple<int, int, std::size_t>> order;
+    order.reserve(nSources);
+    for (std::size_t k = 0; k < nSources; ++k) {
+        if (!std::isfinite(x[k]) || !std::isfinite(y[k])) {
+            fail(*measCat.get(k));
+            continue;
+        }
+        order.emplace_back(floorDivide(static_cast<int>(std::floor(y[k])), _ctrl.phaseCellSize),
+                           floorDivide(static_cast<int>(std::floor(x[k])), _ctrl.phaseCellSize), k);
+    }
+    std::sort(order.begin(), order.end());
+
+    // Evaluate the Psf images for one batch of sources at a time (bounding the memory held by them),
+    // then fit that batch in parallel.
+    std::size_t const batchSize = 256 * static_cast<std::size_t>(resolveThreadCount(nThreads));
+    std::vector<std::shared_ptr<afw::detection::Psf::Image>> psfImages;
+    for (std::size_t begin = 0; begin < order.size(); begin += batchSize) {
+        std::size_t const end = std::min(begin + batchSize, order.size());
+        psfImages.clear();
+        for (std::size_t n = begin; n < end; ++n) {
+            std::size_t const k = std::get<2>(order[n]);
+            std::shared_ptr<afw::detection::Psf::Image> psfImage;
+            try {
+                psfImage = computePsfImage(psf, geom::Point2D(x[k], y[k]));
+            } catch (FatalAlgorithmError&) {
+                throw;
+            } catch (pex::exceptions::Exception&) {
+                // The Psf cannot be evaluated here (e.g. no CoaddPsf inputs); only this source fails.
+                fail(*measCat.get(k));
+            }
+            psfImages.push_back(psfImage);
+        }
+        parallelFor(end - begin, nThreads, [&](std::size_t n) {
+            if (!psfImages[n]) {
+                return;
+            }
+            afw::table::SourceRecord& measRecord = *measCat.get(std::get<2>(order[begin + n]));
+            try {
+                _fitPsfModel(measRecord, *psfImages[n], exposure, badBits);
+            } catch (MeasurementError& error) {
+                fail(measRecord, &error);
+            } catch (FatalAlgorithmError&) {
+                throw;
+            } catch (pex::exceptions::Exception&) {
+                fail(measRecord);
+            }
+        });
+    }
+}
+
+void PsfFluxAlgorithm::measureN(afw::table::SourceCatalog const& measCat,
+                                afw::image::Exposure<float> const& exposure) const {
+    if (!_ctrl.doMeasureN) {
+        for (std::size_t k = 0; k < measCat.size(); ++k) {
+            measure(*measCat.get(k), exposure);
+        }
+        return;
+    }
+    std::shared_ptr<afw::detection::Psf const> psf = exposure.getPsf();
+    if (!psf) {
+        LOGL_ERROR(getLogName(), "PsfFlux: no psf attached to exposure");
+        throw LSST_EXCEPT(FatalAlgorithmError, "PsfFlux algorithm requires a Psf with every exposure");
+    }
+    auto const& mask = *exposure.getMaskedImage().getMask();
+    auto const& image = *exposure.getMaskedImage().getImage();
+    auto const& variance = *exposure.getMaskedImage().getVariance();
+    afw::image::MaskPixel const badBits = getBadBits(_ctrl, mask);
+
+    // Set up the model and fit region for each source, flagging those that cannot be fit.
+    std::vector<JointFitComponent> components;
+    components.reserve(measCat.size());
+    geom::Box2I unionBBox;
+    for (std::size_t k = 0; k < measCat.size(); ++k) {
+        std::shared_ptr<afw::table::SourceRecord> record = measCat.get(k);
+        afw::table::SourceRecord& measRecord = *record;
+        geom::Point2D position;
+        try {
+            position = _centroidExtractor(measRecord, _flagHandler);
+        } catch (MeasurementError& error) {
+            fail(measRecord, &error);
+            continue;
+        }
+        std::shared_ptr<PsfImage> psfImage = computePsfImage(psf, position);
+        geom::Box2I fitBBox = psfImage->getBBox();
+        fitBBox.clip(exposure.getBBox());
+        if (fitBBox != psfImage->getBBox()) {
+            _flagHandler.setValue(measRecord, FAILURE.number, true);
+            _flagHandler.setValue(measRecord, EDGE.number, true);
+        }
+        std::shared_ptr<afw::geom::SpanSet const> spans = std::make_shared<afw::geom::SpanSet>(fitBBox);
+        if (badBits) {
+            spans = spans->intersectNot(mask, badBits)->clippedTo(mask.getBBox());
+        }
+        if (spans->getArea() == 0) {
+            _flagHandler.setValue(measRecord, NO_GOOD_PIXELS.number, true);
+            _flagHandler.setValue(measRecord, FAILURE.number, true);
+            continue;
+        }
+        unionBBox.include(spans->getBBox());
+        components.push_back(JointFitComponent{record, psfImage, spans});
+    }
+    int const n = components.size();
+    if (n == 0) {
+        return;
+    }
+
+    // Build the normal matrix (only overlapping pairs are nonzero), the data projections, and the
+    // variance-weighted model products needed to propagate the uncertainty.
+    std::vector<Eigen::Triplet<double>> triplets;
+    Eigen::MatrixXd varianceProducts = Eigen::MatrixXd::Zero(n, n);
+    Eigen::VectorXd projections(n);
+    for (int i = 0; i < n; ++i) {
+        auto const& ci = components[i];
+        auto modelArray = ci.spans->flatten(ci.model->getArray(), ci.model->getXY0());
+        auto dataArray = ci.spans->flatten(image.getArray(), exposure.getXY0());
+        projections[i] = (ndarray::asEigenArray(modelArray) * ndarray::asEigenArray(dataArray).cast<double>())
+                                 .sum();
+        triplets.emplace_back(i, i, dotModels(*ci.spans, *ci.model, *ci.model));
+        varianceProducts(i, i) = dotModels(*ci.spans, *ci.model, *ci.model, &variance);
+        for (int j = i + 1; j < n; ++j) {
+            auto const& cj = components[j];
+            if (!ci.spans->getBBox().overlaps(cj.spans->getBBox())) continue;
+            auto overlap = ci.spans->intersect(*cj.spans);
+            if (overlap->getArea() == 0) continue;
+            double const product = dotModels(*overlap, *ci.model, *cj.model);
+            triplets.emplace_back(i, j, product);
+            triplets.emplace_back(j, i, product);
+            varianceProducts(i, j) = varianceProducts(j, i) =
+                    dotModels(*overlap, *ci.model, *cj.model, &variance);
+        }
+    }
+    Eigen::SparseMatrix<double> normalMatrix(n, n);
+    normalMatrix.setFromTriplets(triplets.begin(), triplets.end());
+    Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> solver(normalMatrix);
+    if (solver.info() != Eigen::Success) {
+        throw LSST_EXCEPT(MeasurementError, "Singular normal matrix in joint PSF fit", FAILURE.number);
+    }
+    Eigen::VectorXd fluxes = solver.solve(projections);
+    // Cov = A^{-1} B A^{-1}, where A is the normal matrix and B the variance-weighted products.
+    Eigen::MatrixXd halfCovariance = solver.solve(varianceProducts);
+    Eigen::MatrixXd covariance = solver.solve(Eigen::MatrixXd(halfCovariance.transpose()));
+    if (!fluxes.allFinite() || !covariance.diagonal().allFinite()) {
+        throw LSST_EXCEPT(PixelValueError, "Invalid pixel value detected in image.");
+    }
+
+    // Sum of all fitted models, for the per-source residuals.
+    PsfImage modelSum(unionBBox);
+    modelSum = 0.0;
+    for (int i = 0; i < n; ++i) {
+        double const flux = fluxes[i];
+        components[i].spans->applyFunctor(
+                [flux](geom::Point2I const&, PsfPixel& out, PsfPixel const& in) { out += flux * in; },
+                modelSum, *components[i].model);
+    }
+
+    for (int i = 0; i < n; ++i) {
+        auto const& ci = components[i];
+        auto modelArray = ci.spans->flatten(ci.model->getArray(), ci.model->getXY0());
+        auto modelSumArray = ci.spans->flatten(modelSum.getArray(), modelSum.getXY0());
+        auto dataArray = ci.spans->flatten(image.getArray(), exposure.getXY0());
+        auto varianceArray = ci.spans->flatten(variance.getArray(), exposure.getXY0());
+        auto model = ndarray::asEigenArray(modelArray);
+        double const alpha = normalMatrix.coeff(i, i);
+        FluxResult result;
+        result.instFlux = fluxes[i];
+        result.instFluxErr = std::sqrt(covariance(i, i));
+        ci.record->set(_instFluxResultKey, result);
+        ci.record->set(_areaKey, model.sum() / alpha);
+        ci.record->set(_npixelsKey, ci.spans->getArea());
+        auto residuals =
+                ndarray::asEigenArray(dataArray).cast<PsfPixel>() - ndarray::asEigenArray(modelSumArray);
+        auto chi2 = (residuals.square() / ndarray::asEigenArray(varianceArray).cast<PsfPixel>()).sum();
+        ci.record->set(_chi2Key, chi2);
+    }
+}
+
 void PsfFluxAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
     _flagHandler.handleFailure(measRecord, error);
 }
@@ -21,6 +21,10 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 #include "lsst/afw/table/Source.h"
 #include "lsst/meas/base/ApertureFlux.h"
 #include "lsst/meas/base/ScaledApertureFlux.h"
@@ -43,9 +47,7 @@ ScaledApertureFluxAlgorithm::ScaledApertureFluxAlgorithm(Control const& ctrl, st
 void ScaledApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
                                           afw::image::Exposure<float> const& exposure) const {
     geom::Point2D const center = _centroidExtractor(measRecord, _flagHandler);
-    double const radius = exposure.getPsf()->computeShape(center).getDeterminantRadius();
-    double const fwhm = 2.0 * std::sqrt(2.0 * std::log(2)) * radius;
-    double const size = _ctrl.scale * fwhm;
+    double const size = _computeApertureRadius(*exposure.getPsf(), center);
     afw::geom::ellipses::Axes const axes(size, size);
 
     // ApertureFluxAlgorithm::computeSincFlux requires an ApertureFluxControl as an
@@ -53,8 +55,15 @@ void ScaledApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
     ApertureFluxControl apCtrl;
     apCtrl.shiftKernel = _ctrl.shiftKernel;
 
-    Result result = ApertureFluxAlgorithm::computeSincFlux(
-            exposure.getMaskedImage(), afw::geom::ellipses::Ellipse(axes, center), apCtrl);
+    Result result;
+    if (_ctrl.radiusStep > 0.0) {
+        result = ApertureFluxAlgorithm::computeSincFlux(
+                exposure.getMaskedImage(), afw::geom::ellipses::Ellipse(axes, center),
+                *SincCoeffs<float>::getInterpolated(size, _ctrl.radiusStep), apCtrl);
+    } else {
+        result = ApertureFluxAlgorithm::computeSincFlux(
+                exposure.getMaskedImage(), afw::geom::ellipses::Ellipse(axes, center), apCtrl);
+    }
     measRecord.set(_instFluxResultKey, result);
 
     for (std::size_t i = 0; i < ApertureFluxAlgorithm::getFlagDefinitions().size(); i++) {
@@ -65,6 +74,46 @@ void ScaledApertureFluxAlgorithm::measure(afw::table::SourceRecord& measRecord,
     }
 }
 
+void ScaledApertureFluxAlgorithm::cacheCoefficients(afw::image::Exposure<float> const& exposure) const {
+    std::shared_ptr<afw::detection::Psf const> psf = exposure.getPsf();
+    if (_ctrl.radiusStep <= 0.0 || !psf) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_cacheMutex);
+    // Owner comparison, so a new PSF allocated where an old one was is not mistaken for it.
+    if (!_cachedPsf.owner_before(psf) && !psf.owner_before(_cachedPsf)) {
+        return;
+    }
+    geom::Box2D const bbox(exposure.getBBox());
+    double rMin = std::numeric_limits<double>::infinity();
+    double rMax = 0.0;
+    for (int iy = 0; iy < 3; ++iy) {
+        for (int ix = 0; ix < 3; ++ix) {
+            geom::Point2D const position(bbox.getMinX() + 0.5 * ix * bbox.getWidth(),
+                                         bbox.getMinY() + 0.5 * iy * bbox.getHeight());
+            try {
+                double const radius = _computeApertureRadius(*psf, position);
+                rMin = std::min(rMin, radius);
+                rMax = std::max(rMax, radius);
+            } catch (pex::exceptions::Exception const&) {
+                // Not all PSFs can be evaluated everywhere (e.g. off the edge of a coadd's inputs);
+                // coefficients for any radii missed will be computed when first needed.
+            }
+        }
+    }
+    if (rMax > 0.0) {
+        SincCoeffs<float>::cacheInterpolated(rMin, rMax, _ctrl.radiusStep);
+    }
+    _cachedPsf = psf;
+}
+
+double ScaledApertureFluxAlgorithm::_computeApertureRadius(afw::detection::Psf const& psf,
+                                                   geom::Point2D const& position) const {
+    double const radius = psf.computeShape(position).getDeterminantRadius();
+    double const fwhm = 2.0 * std::sqrt(2.0 * std::log(2)) * radius;
+    return _ctrl.scale * fwhm;
+}
+
 void ScaledApertureFluxAlgorithm::fail(afw::table::SourceRecord& measRecord, MeasurementError* error) const {
     _flagHandler.handleFailure(measRecord, error);
 }
@@ -129,7 +129,7 @@ template <typename ImageT>  // general case
 struct ImageAdaptor {
     typedef ImageT Image;
 
-    static bool const hasVariance = false;
+    static constexpr bool hasVariance = false;
 
     Image const &getImage(ImageT const &image) const { return image; }
 
@@ -140,7 +140,7 @@ template <typename T>  // specialise to a MaskedImage
 struct ImageAdaptor<afw::image::MaskedImage<T> > {
     typedef typename afw::image::MaskedImage<T>::Image Image;
 
-    static bool const hasVariance = true;
+    static constexpr bool hasVariance = true;
 
     Image const &getImage(afw::image::MaskedImage<T> const &mimage) const { return *mimage.getImage(); }
 
@@ -190,36 +190,31 @@ geom::Box2I computeAdaptiveMomentsBBox(geom::Box2I const &bbox,      // full ima
 /*
  * Calculate weighted moments of an object up to 2nd order
  */
-template <typename ImageT>
-static void calcmom(ImageT const &image,                             // the image data
-                   float xcen, float ycen,                          // centre of object
-                   const geom::BoxI &bbox,                          // bounding box to consider
-                   float bkgd,                                      // data's background level
-                   bool interpflag,                                 // interpolate within pixels?
-                   double w11, double w12, double w22,              // weights
-                   double &psum) {                                    // sum w*I
-
-    float tmod, ymod;
-    float X, Y;  // sub-pixel interpolated [xy]
-    float weight;
-    float tmp;
-    double sum, sumx, sumy, sumxx, sumyy, sumxy, sums4;
 
-    if (w11 < 0 ||  w11 > 1e6 || fabs(w12) > 1E6 || w22 < 0 || w22 > 1e6) {
-        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Invalid weight parameter(s)");
-    }
+// Weighted sums accumulated by calcmom.
+struct MomentSums {
+    double sum = 0;                          // sum w*I
+    double sumx = 0, sumy = 0;               // sum [xy]*w*I
+    double sumxx = 0, sumxy = 0, sumyy = 0;  // sum [xy]^2*w*I
+    double sums4 = 0;                        // sum w*I*weight^2
+};
 
-    sum = sumx = sumy = sumxx = sumxy = sumyy = sums4 = 0;
+/*
+ * The pixel loop of calcmom, specialized at compile time on whether pixels are sub-sampled
+ * (Interpolate) and on whether the first and second moments are wanted as well as the weighted sum
+ * (Moments), so neither is branched on per pixel.  The arithmetic is that of the general loop, so the
+ * results are the same.
+ */
+template <bool Interpolate, bool Moments, typename ImageT>
+MomentSums accumulateMoments(ImageT const &image, float xcen, float ycen, geom::BoxI const &bbox,
+                             float bkgd, double w11, double w12, double w22) {
+    MomentSums sums;
 
     int const ix0 = bbox.getMinX();  // corners of the box being analyzed
     int const ix1 = bbox.getMaxX();
     int const iy0 = bbox.getMinY();  // corners of the box being analyzed
     int const iy1 = bbox.getMaxY();
 
-    if (ix0 < 0 || ix1 >= image.getWidth() || iy0 < 0 || iy1 >= image.getHeight()) {
-        throw LSST_EXCEPT(pex::exceptions::LengthError, "Invalid image dimensions");
-    }
-
     for (int i = iy0; i <= iy1; ++i) {
         typename ImageT::x_iterator ptr = image.x_at(ix0, i);
         float const y = i - ycen;
@@ -228,12 +223,12 @@ static void calcmom(ImageT const &image,                             // the imag
         float const yh = y + 0.375;
         for (int j = ix0; j <= ix1; ++j, ++ptr) {
             float x = j - xcen;
-            if (interpflag) {
+            if (Interpolate) {
                 float const xl = x - 0.375;
                 float const xh = x + 0.375;
 
                 float expon = xl * xl * w11 + yl * yl * w22 + 2.0 * xl * yl * w12;
-                tmp = xh * xh * w11 + yh * yh * w22 + 2.0 * xh * yh * w12;
+                float tmp = xh * xh * w11 + yh * yh * w22 + 2.0 * xh * yh * w12;
                 expon = (expon > tmp) ? expon : tmp;
                 tmp = xl * xl * w11 + yh * yh * w22 + 2.0 * xl * yh * w12;
                 expon = (expon > tmp) ? expon : tmp;
@@ -241,17 +236,25 @@ static void calcmom(ImageT const &image,                             // the imag
                 expon = (expon > tmp) ? expon : tmp;
 
                 if (expon <= 9.0) {
-                    tmod = *ptr - bkgd;
-                    for (Y = yl; Y <= yh; Y += 0.25) {
+                    float const tmod = *ptr - bkgd;
+                    for (float Y = yl; Y <= yh; Y += 0.25) {  // sub-pixel interpolated y
                         double const interpY2 = Y * Y;
-                        for (X = xl; X <= xh; X += 0.25) {
+                        for (float X = xl; X <= xh; X += 0.25) {  // sub-pixel interpolated x
                             double const interpX2 = X * X;
                             double const interpXy = X * Y;
                             expon = interpX2 * w11 + 2 * interpXy * w12 + interpY2 * w22;
-                            weight = std::exp(-0.5 * expon);
-
-                            ymod = tmod * weight;
-                            sum += ymod;
+                            float const weight = std::exp(-0.5 * expon);
+
+                            float const ymod = tmod * weight;
+                            sums.sum += ymod;
+                            if (Moments) {
+                                sums.sumx += ymod * (X + xcen);
+                                sums.sumy += ymod * (Y + ycen);
+                                sums.sumxx += interpX2 * ymod;
+                                sums.sumxy += interpXy * ymod;
+                                sums.sumyy += interpY2 * ymod;
+                                sums.sums4 += expon * expon * ymod;
+                            }
                         }
                     }
                 }
@@ -261,17 +264,53 @@ static void calcmom(ImageT const &image,                             // the imag
                 float expon = x2 * w11 + 2 * xy * w12 + y2 * w22;
 
                 if (expon <= 14.0) {
-                    weight = std::exp(-0.5 * expon);
-                    tmod = *ptr - bkgd;
-                    ymod = tmod * weight;
-                    sum += ymod;
+                    float const weight = std::exp(-0.5 * expon);
+                    float const tmod = *ptr - bkgd;
+                    float const ymod = tmod * weight;
+                    sums.sum += ymod;
+                    if (Moments) {
+                        sums.sumx += ymod * j;
+                        sums.sumy += ymod * i;
+                        sums.sumxx += x2 * ymod;
+                        sums.sumxy += xy * ymod;
+                        sums.sumyy += y2 * ymod;
+                        sums.sums4 += expon * expon * ymod;
+                    }
                 }
             }
         }
     }
+    return sums;
+}
 
-    psum = sum;
+// Check the inputs to calcmom, and run the pixel loop specialized for interpflag.
+template <bool Moments, typename ImageT>
+MomentSums computeMomentSums(ImageT const &image, float xcen, float ycen, geom::BoxI const &bbox,
+                             float bkgd, bool interpflag, double w11, double w12, double w22) {
+    if (w11 < 0 ||  w11 > 1e6 || fabs(w12) > 1E6 || w22 < 0 || w22 > 1e6) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Invalid weight parameter(s)");
+    }
+
+    if (bbox.getMinX() < 0 || bbox.getMaxX() >= image.getWidth() || bbox.getMinY() < 0 ||
+        bbox.getMaxY() >= image.getHeight()) {
+        throw LSST_EXCEPT(pex::exceptions::LengthError, "Invalid image dimensions");
+    }
 
+    if (interpflag) {
+        return accumulateMoments<true, Moments>(image, xcen, ycen, bbox, bkgd, w11, w12, w22);
+    }
+    return accumulateMoments<false, Moments>(image, xcen, ycen, bbox, bkgd, w11, w12, w22);
+}
+
+template <typename ImageT>
+static void calcmom(ImageT const &image,                             // the image data
+                   float xcen, float ycen,                          // centre of object
+                   const geom::BoxI &bbox,                          // bounding box to consider
+                   float bkgd,                                      // data's background level
+                   bool interpflag,                                 // interpolate within pixels?
+                   double w11, double w12, double w22,              // weights
+                   double &psum) {                                    // sum w*I
+    psum = computeMomentSums<false>(image, xcen, ycen, bbox, bkgd, interpflag, w11, w12, w22).sum;
 }
 
 template <typename ImageT>
@@ -287,89 +326,11 @@ static int calcmom(ImageT const &image,                             // the image
                    double &psumxx, double &psumxy, double &psumyy,  // sum [xy]^2*w*I (if !instFluxOnly)
                    double &psums4,  // sum w*I*weight^2 (if !instFluxOnly && !NULL)
                    bool negative = false) {
-    float tmod, ymod;
-    float X, Y;  // sub-pixel interpolated [xy]
-    float weight;
-    float tmp;
-    double sum, sumx, sumy, sumxx, sumyy, sumxy, sums4;
-
-    if (w11 < 0 ||  w11 > 1e6 || fabs(w12) > 1E6 || w22 < 0 || w22 > 1e6) {
-        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "Invalid weight parameter(s)");
-    }
-
-    sum = sumx = sumy = sumxx = sumxy = sumyy = sums4 = 0;
-
-    int const ix0 = bbox.getMinX();  // corners of the box being analyzed
-    int const ix1 = bbox.getMaxX();
-    int const iy0 = bbox.getMinY();  // corners of the box being analyzed
-    int const iy1 = bbox.getMaxY();
-
-    if (ix0 < 0 || ix1 >= image.getWidth() || iy0 < 0 || iy1 >= image.getHeight()) {
-        throw LSST_EXCEPT(pex::exceptions::LengthError, "Invalid image dimensions");
-    }
-
-    for (int i = iy0; i <= iy1; ++i) {
-        typename ImageT::x_iterator ptr = image.x_at(ix0, i);
-        float const y = i - ycen;
-        float const y2 = y * y;
-        float const yl = y - 0.375;
-        float const yh = y + 0.375;
-        for (int j = ix0; j <= ix1; ++j, ++ptr) {
-            float x = j - xcen;
-            if (interpflag) {
-                float const xl = x - 0.375;
-                float const xh = x + 0.375;
-
-                float expon = xl * xl * w11 + yl * yl * w22 + 2.0 * xl * yl * w12;
-                tmp = xh * xh * w11 + yh * yh * w22 + 2.0 * xh * yh * w12;
-                expon = (expon > tmp) ? expon : tmp;
-                tmp = xl * xl * w11 + yh * yh * w22 + 2.0 * xl * yh * w12;
-                expon = (expon > tmp) ? expon : tmp;
-                tmp = xh * xh * w11 + yl * yl * w22 + 2.0 * xh * yl * w12;
-                expon = (expon > tmp) ? expon : tmp;
-
-                if (expon <= 9.0) {
-                    tmod = *ptr - bkgd;
-                    for (Y = yl; Y <= yh; Y += 0.25) {
-                        double const interpY2 = Y * Y;
-                        for (X = xl; X <= xh; X += 0.25) {
-                            double const interpX2 = X * X;
-                            double const interpXy = X * Y;
-                            expon = interpX2 * w11 + 2 * interpXy * w12 + interpY2 * w22;
-                            weight = std::exp(-0.5 * expon);
-
-                            ymod = tmod * weight;
-                            sum += ymod;
-                            sumx += ymod * (X + xcen);
-                            sumy += ymod * (Y + ycen);
-                            sumxx += interpX2 * ymod;
-                            sumxy += interpXy * ymod;
-                            sumyy += interpY2 * ymod;
-                            sums4 += expon * expon * ymod;
-                        }
-                    }
-                }
-            } else {
-                float x2 = x * x;
-                float xy = x * y;
-                float expon = x2 * w11 + 2 * xy * w12 + y2 * w22;
-
-                if (expon <= 14.0) {
-                    weight = std::exp(-0.5 * expon);
-                    tmod = *ptr - bkgd;
-                    ymod = tmod * weight;
-                    sum += ymod;
-                    sumx += ymod * j;
-                    sumy += ymod * i;
-                    sumxx += x2 * ymod;
-                    sumxy += xy * ymod;
-                    sumyy += y2 * ymod;
-                    sums4 += expon * expon * ymod;
-                }
-            }
-        }
-    }
-
+    MomentSums const sums =
+            computeMomentSums<true>(image, xcen, ycen, bbox, bkgd, interpflag, w11, w12, w22);
+    double const sum = sums.sum;
+    double const sumxx = sums.sumxx;
+    double const sumyy = sums.sumyy;
 
     std::tuple<std::pair<bool, double>, double, double, double> const weights = getWeights(w11, w12, w22);
     double const detW = std::get<1>(weights) * std::get<3>(weights) - std::pow(std::get<2>(weights), 2);
@@ -378,13 +339,13 @@ static int calcmom(ImageT const &image,                             // the image
 
     psum = sum;
 
-    psumx = sumx;
-    psumy = sumy;
+    psumx = sums.sumx;
+    psumy = sums.sumy;
     psumxx = sumxx;
-    psumxy = sumxy;
+    psumxy = sums.sumxy;
     psumyy = sumyy;
 
-    psums4 = sums4;
+    psums4 = sums.sums4;
 
     if (negative) {
         return (sum < 0 && sumxx < 0 && sumyy < 0) ? 0 : -1;
@@ -600,7 +561,8 @@ bool getAdaptiveMoments(ImageT const &mimage, double bkgd, double xcen, double y
     shape->xy = sigma12W;
     shape->yy = sigma22W;
 
-    if (shape->xx + shape->yy != 0.0) {
+    // Without a variance plane there are no errors to compute; this is decided at compile time.
+    if (ImageAdaptor<ImageT>::hasVariance && shape->xx + shape->yy != 0.0) {
         int const ix = afw::image::positionToIndex(xcen);
         int const iy = afw::image::positionToIndex(ycen);
 
@@ -0,0 +1,173 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "boost/format.hpp"
+
+#include "lsst/pex/exceptions.h"
+#include "lsst/meas/base/SegmentStatistics.h"
+#include "lsst/meas/base/ParallelUtilities.h"
+
+namespace lsst {
+namespace meas {
+namespace base {
+
+namespace {
+
+// Number of segments processed by each parallel work item; segments are typically small.
+std::size_t const CHUNK_SIZE = 256;
+
+void checkOffsets(ndarray::Array<std::int64_t const, 1> const& offsets, std::size_t nValues) {
+    if (offsets.getSize<0>() == 0) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError, "offsets must not be empty");
+    }
+    std::int64_t previous = 0;
+    for (std::int64_t offset : offsets) {
+        if (offset < previous || offset > static_cast<std::int64_t>(nValues)) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Invalid segment offset %d for %d values") % offset % nValues)
+                                      .str());
+        }
+        previous = offset;
+    }
+}
+
+// Copy the non-NaN values of one segment into buffer.
+void gatherSegment(ndarray::Array<double const, 1> const& values, std::int64_t begin, std::int64_t end,
+                   std::vector<double>& buffer) {
+    buffer.clear();
+    for (std::int64_t j = begin; j < end; ++j) {
+        if (!std::isnan(values[j])) {
+            buffer.push_back(values[j]);
+        }
+    }
+}
+
+// Compute linearly-interpolated quantiles (in [0, 1], sorted ascending) of a non-empty buffer, which is
+// reordered.  Each selection only searches the part of the buffer above the previous one.
+template <typename OutputIterator>
+void selectQuantiles(std::vector<double>& buffer, std::vector<double> const& quantiles, OutputIterator out) {
+    std::size_t const n = buffer.size();
+    auto first = buffer.begin();
+    for (double q : quantiles) {
+        double const rank = q * (n - 1);
+        std::size_t const lower = std::min(static_cast<std::size_t>(std::floor(rank)), n - 1);
+        double const fraction = rank - lower;
+        auto const nth = buffer.begin() + lower;
+        if (first <= nth) {
+            std::nth_element(first, nth, buffer.end());
+        }
+        first = nth;
+        double result = *nth;
+        if (fraction > 0.0 && lower + 1 < n) {
+            double const upper = *std::min_element(nth + 1, buffer.end());
+            result += fraction * (upper - result);
+        }
+        *out++ = result;
+    }
+}
+
+}  // namespace
+
+ndarray::Array<double, 2, 2> computeSegmentPercentiles(ndarray::Array<double const, 1> const& values,
+                                                       ndarray::Array<std::int64_t const, 1> const& offsets,
+                                                       ndarray::Array<double const, 1> const& percentiles,
+                                                       int nThreads) {
+    checkOffsets(offsets, values.getSize<0>());
+    std::size_t const nPercentiles = percentiles.getSize<0>();
+    for (double p : percentiles) {
+        if (!(p >= 0.0 && p <= 100.0)) {
+            throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                              (boost::format("Percentile %g is not in [0, 100]") % p).str());
+        }
+    }
+    // Select in increasing order of percentile, writing results back in the requested order.
+    std::vector<std::size_t> order(nPercentiles);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&percentiles](std::size_t a, std::size_t b) { return percentiles[a] < percentiles[b]; });
+    std::vector<double> quantiles(nPercentiles);
+    for (std::size_t k = 0; k < nPercentiles; ++k) {
+        quantiles[k] = 0.01 * percentiles[order[k]];
+    }
+
+    std::size_t const nSegments = offsets.getSize<0>() - 1;
+    ndarray::Array<double, 2, 2> result = ndarray::allocate(nSegments, nPercentiles);
+    std::size_t const nChunks = (nSegments + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    parallelFor(nChunks, nThreads, [&](std::size_t chunk) {
+        std::vector<double> buffer;
+        std::vector<double> selected(nPercentiles);
+        std::size_t const end = std::min(nSegments, (chunk + 1) * CHUNK_SIZE);
+        for (std::size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+            gatherSegment(values, offsets[i], offsets[i + 1], buffer);
+            if (buffer.empty()) {
+                result[i].deep() = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            selectQuantiles(buffer, quantiles, selected.begin());
+            for (std::size_t k = 0; k < nPercentiles; ++k) {
+                result[i][order[k]] = selected[k];
+            }
+        }
+    });
+    return result;
+}
+
+ndarray::Array<double, 1, 1> computeSegmentMads(ndarray::Array<double const, 1> const& values,
+                                                ndarray::Array<std::int64_t const, 1> const& offsets,
+                                                int nThreads) {
+    checkOffsets(offsets, values.getSize<0>());
+    std::vector<double> const half = {0.5};
+    std::size_t const nSegments = offsets.getSize<0>() - 1;
+    ndarray::Array<double, 1, 1> result = ndarray::allocate(nSegments);
+    std::size_t const nChunks = (nSegments + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    parallelFor(nChunks, nThreads, [&](std::size_t chunk) {
+        std::vector<double> buffer;
+        std::size_t const end = std::min(nSegments, (chunk + 1) * CHUNK_SIZE);
+        for (std::size_t i = chunk * CHUNK_SIZE; i < end; ++i) {
+            gatherSegment(values, offsets[i], offsets[i + 1], buffer);
+            if (buffer.empty()) {
+                result[i] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            double median;
+            selectQuantiles(buffer, half, &median);
+            for (double& value : buffer) {
+                value = std::abs(value - median);
+            }
+            selectQuantiles(buffer, half, &result[i]);
+        }
+    });
+    return result;
+}
+
+}  // namespace base
+}  // namespace meas
+}  // namespace lsst
@@ -21,7 +21,11 @@
  * see <http://www.lsstcorp.org/LegalNotices/>.
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <complex>
+#include <limits>
 
 #include "boost/math/special_functions/bessel.hpp"
 #include "boost/shared_array.hpp"
@@ -494,23 +498,215 @@ void SincCoeffs<PixelT>::cache(float r1, float r2) {
                           (boost::format("Invalid r1,r2 = %f,%f") % r1 % r2).str());
     }
     double const innerFactor = r1 / r2;
-    afw::geom::ellipses::Axes axes(r2, r2, 0.0);
-    if (!getInstance()._lookup(axes, innerFactor)) {
-        std::shared_ptr<typename SincCoeffs<PixelT>::CoeffT> coeff = calculate(axes, innerFactor);
-        getInstance()._cache[r2][innerFactor] = coeff;
-    }
+    getInstance()._lookupOrCache(r2, innerFactor);
 }
 
 template <typename PixelT>
 std::shared_ptr<typename SincCoeffs<PixelT>::CoeffT const>
 SincCoeffs<PixelT>::get(afw::geom::ellipses::Axes const& axes, float const innerFactor) {
-    std::shared_ptr<CoeffT const> coeff = getInstance()._lookup(axes, innerFactor);
-    return coeff ? coeff : calculate(axes, innerFactor);
+    SincCoeffs& instance = getInstance();
+    {
+        std::lock_guard<std::mutex> lock(instance._mutex);
+        std::shared_ptr<CoeffT const> coeff = instance._lookup(axes, innerFactor);
+        if (coeff) {
+            return coeff;
+        }
+    }
+    double computeTime;
+    return instance._calculate(axes, innerFactor, computeTime);
+}
+
+template <typename PixelT>
+std::shared_ptr<typename SincCoeffs<PixelT>::CoeffT const>
+SincCoeffs<PixelT>::getInterpolated(float radius, float radiusStep) {
+    if (!(radius > 0.0) || !(radiusStep > 0.0)) {
+        throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
+                          (boost::format("Invalid radius,radiusStep = %f,%f") % radius % radiusStep).str());
+    }
+    SincCoeffs& instance = getInstance();
+    double const position = radius / radiusStep;
+    int const index = static_cast<int>(std::floor(position));
+    double const weight = position - index;  // weight of the coefficients for the larger radius
+    if (index > 0 && weight < std::numeric_limits<float>::epsilon()) {
+        return instance._lookupOrCache(index * radiusStep, 0.0);
+    }
+    std::shared_ptr<CoeffT const> upper = instance._lookupOrCache((index + 1) * radiusStep, 0.0);
+    // The coefficients for a zero radius are all zero.
+    std::shared_ptr<CoeffT const> lower;
+    if (index > 0) {
+        lower = instance._lookupOrCache(index * radiusStep, 0.0);
+    }
+
+    // The coefficient images may differ in size, as their widths are rounded up to powers of two.
+    geom::Box2I bbox = upper->getBBox();
+    if (lower) {
+        bbox.include(lower->getBBox());
+    }
+    auto coeff = std::make_shared<CoeffT>(bbox, 0.0);
+    CoeffT upperView(*coeff, upper->getBBox());
+    upperView.scaledPlus(weight, *upper);
+    if (lower) {
+        CoeffT lowerView(*coeff, lower->getBBox());
+        lowerView.scaledPlus(1.0 - weight, *lower);
+    }
+    return coeff;
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::cacheInterpolated(float rMin, float rMax, float radiusStep) {
+    if (rMin < 0.0 || rMax < rMin || !(radiusStep > 0.0)) {
+        throw LSST_EXCEPT(
+                pex::exceptions::InvalidParameterError,
+                (boost::format("Invalid rMin,rMax,radiusStep = %f,%f,%f") % rMin % rMax % radiusStep).str());
+    }
+    SincCoeffs& instance = getInstance();
+    int const end = static_cast<int>(std::ceil(rMax / radiusStep));
+    for (int index = std::max(1, static_cast<int>(std::floor(rMin / radiusStep))); index <= end; ++index) {
+        instance._lookupOrCache(index * radiusStep, 0.0);
+    }
+}
+
+template <typename PixelT>
+std::size_t SincCoeffs<PixelT>::getCacheBytes() {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    return instance._stats.bytes;
+}
+
+template <typename PixelT>
+typename SincCoeffs<PixelT>::CacheStatistics SincCoeffs<PixelT>::getCacheStatistics() {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    return instance._stats;
+}
+
+template <typename PixelT>
+std::vector<typename SincCoeffs<PixelT>::CacheEntry> SincCoeffs<PixelT>::getCacheEntries() {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    std::vector<CacheEntry> entries;
+    entries.reserve(instance._stats.entries);
+    for (auto const& byRadius : instance._cache) {
+        for (auto const& byInner : byRadius.second) {
+            Entry const& entry = byInner.second;
+            entries.push_back({byRadius.first, byInner.first,
+                               entry.coeff->getBBox().getArea() * sizeof(PixelT), entry.hits,
+                               entry.computeTime});
+        }
+    }
+    return entries;
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::resetCacheStatistics() {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    instance._stats.hits = 0;
+    instance._stats.misses = 0;
+    instance._stats.evictions = 0;
+    instance._stats.computeTime = 0.0;
+    for (auto& byRadius : instance._cache) {
+        for (auto& byInner : byRadius.second) {
+            byInner.second.hits = 0;
+            byInner.second.computeTime = 0.0;
+        }
+    }
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::setCacheCapacity(std::size_t capacity) {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    instance._capacity = capacity;
+    instance._evict();
+}
+
+template <typename PixelT>
+std::size_t SincCoeffs<PixelT>::getCacheCapacity() {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    return instance._capacity;
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::clearCache() {
+    SincCoeffs& instance = getInstance();
+    std::lock_guard<std::mutex> lock(instance._mutex);
+    instance._cache.clear();
+    instance._stats.entries = 0;
+    instance._stats.bytes = 0;
+}
+
+template <typename PixelT>
+void SincCoeffs<PixelT>::_evict() {
+    while (_capacity > 0 && _stats.bytes > _capacity && _stats.entries > 1) {
+        typename CoeffMapMap::iterator oldestRadius = _cache.end();
+        typename CoeffMap::iterator oldest;
+        for (auto iter1 = _cache.begin(); iter1 != _cache.end(); ++iter1) {
+            for (auto iter2 = iter1->second.begin(); iter2 != iter1->second.end(); ++iter2) {
+                if (oldestRadius == _cache.end() || iter2->second.lastUse < oldest->second.lastUse) {
+                    oldestRadius = iter1;
+                    oldest = iter2;
+                }
+            }
+        }
+        _stats.bytes -= oldest->second.coeff->getBBox().getArea() * sizeof(PixelT);
+        _stats.entries -= 1;
+        _stats.evictions += 1;
+        oldestRadius->second.erase(oldest);
+        if (oldestRadius->second.empty()) {
+            _cache.erase(oldestRadius);
+        }
+    }
+}
+
+template <typename PixelT>
+std::shared_ptr<typename SincCoeffs<PixelT>::CoeffT const>
+SincCoeffs<PixelT>::_lookupOrCache(float radius, double const innerFactor) {
+    afw::geom::ellipses::Axes axes(radius, radius, 0.0);
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::shared_ptr<CoeffT const> coeff = _lookup(axes, innerFactor);
+        if (coeff) {
+            return coeff;
+        }
+    }
+    // Calculate without holding the lock, so that other threads may use the cache meanwhile; if one of
+    // them caches the same aperture first, its coefficients are kept.
+    double computeTime;
+    std::shared_ptr<CoeffT> coeff = _calculate(axes, innerFactor, computeTime);
+    std::lock_guard<std::mutex> lock(_mutex);
+    Entry& entry = _cache[radius][innerFactor];
+    if (!entry.coeff) {
+        entry.coeff = coeff;
+        entry.hits = 0;
+        entry.computeTime = computeTime;
+        _stats.entries += 1;
+        _stats.bytes += coeff->getBBox().getArea() * sizeof(PixelT);
+    }
+    entry.lastUse = ++_clock;
+    // Eviction may remove the entry, but not the coefficients we return.
+    coeff = entry.coeff;
+    _evict();
+    return coeff;
+}
+
+template <typename PixelT>
+std::shared_ptr<typename SincCoeffs<PixelT>::CoeffT>
+SincCoeffs<PixelT>::_calculate(afw::geom::ellipses::Axes const& axes, double const innerFactor,
+                               double& computeTime) {
+    auto const start = std::chrono::steady_clock::now();
+    std::shared_ptr<CoeffT> coeff = calculate(axes, innerFactor);
+    computeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stats.misses += 1;
+    _stats.computeTime += computeTime;
+    return coeff;
 }
 
 template <typename PixelT>
 std::shared_ptr<typename SincCoeffs<PixelT>::CoeffT const>
-SincCoeffs<PixelT>::_lookup(afw::geom::ellipses::Axes const& axes, double const innerFactor) const {
+SincCoeffs<PixelT>::_lookup(afw::geom::ellipses::Axes const& axes, double const innerFactor) {
     if (innerFactor < 0.0 || innerFactor > 1.0) {
         throw LSST_EXCEPT(pex::exceptions::InvalidParameterError,
                           (boost::format("innerFactor = %f is not between 0 and 1") % innerFactor).str());
@@ -522,12 +718,19 @@ SincCoeffs<PixelT>::_lookup(afw::geom::ellipses::Axes const& axes, double const
     if (!FuzzyCompare<float>().isEqual(axes.getA(), axes.getB())) {
         return null;
     }
-    typename CoeffMapMap::const_iterator iter1 = _cache.find(axes.getA());
+    typename CoeffMapMap::iterator iter1 = _cache.find(axes.getA());
     if (iter1 == _cache.end()) {
         return null;
     }
-    typename CoeffMap::const_iterator iter2 = iter1->second.find(innerFactor);
-    return (iter2 == iter1->second.end()) ? null : iter2->second;
+    typename CoeffMap::iterator iter2 = iter1->second.find(innerFactor);
+    if (iter2 == iter1->second.end()) {
+        return null;
+    }
+    Entry& entry = iter2->second;
+    entry.hits += 1;
+    entry.lastUse = ++_clock;
+    _stats.hits += 1;
+    return entry.coeff;
 }
 
 template <typename PixelT>
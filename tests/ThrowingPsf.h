@@ -0,0 +1,99 @@
+// -*- LSST-C++ -*-
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef LSST_MEAS_BASE_ThrowingPsf_h_INCLUDED
+#define LSST_MEAS_BASE_ThrowingPsf_h_INCLUDED
+
+#include <memory>
+#include <utility>
+
+#include "lsst/geom/Box.h"
+#include "lsst/pex/exceptions.h"
+#include "lsst/afw/detection/Psf.h"
+
+namespace test {
+namespace foo {
+namespace bar {
+
+/**
+ *  @brief A Psf that delegates to another, but throws when evaluated inside a region
+ *
+ *  This stands in for Psfs (such as CoaddPsf) that cannot be evaluated everywhere, to test that
+ *  algorithms flag the affected sources rather than failing outright.
+ */
+class ThrowingPsf : public lsst::afw::detection::Psf {
+public:
+    ThrowingPsf(std::shared_ptr<lsst::afw::detection::Psf const> psf, lsst::geom::Box2D const& badRegion)
+            : _psf(std::move(psf)), _badRegion(badRegion) {}
+
+    std::shared_ptr<lsst::afw::detection::Psf> clone() const override {
+        return std::make_shared<ThrowingPsf>(_psf, _badRegion);
+    }
+
+    std::shared_ptr<lsst::afw::detection::Psf> resized(int width, int height) const override {
+        return std::make_shared<ThrowingPsf>(_psf->resized(width, height), _badRegion);
+    }
+
+    lsst::geom::Point2D getAveragePosition() const override { return _psf->getAveragePosition(); }
+
+private:
+    void _check(lsst::geom::Point2D const& position) const {
+        if (_badRegion.contains(position)) {
+            throw LSST_EXCEPT(lsst::pex::exceptions::InvalidParameterError,
+                              "Psf cannot be evaluated at this position");
+        }
+    }
+
+    std::shared_ptr<Image> doComputeKernelImage(lsst::geom::Point2D const& position,
+                                                lsst::afw::image::Color const& color) const override {
+        _check(position);
+        return _psf->computeKernelImage(position, color);
+    }
+
+    double doComputeApertureFlux(double radius, lsst::geom::Point2D const& position,
+                                 lsst::afw::image::Color const& color) const override {
+        _check(position);
+        return _psf->computeApertureFlux(radius, position, color);
+    }
+
+    lsst::afw::geom::ellipses::Quadrupole doComputeShape(
+            lsst::geom::Point2D const& position, lsst::afw::image::Color const& color) const override {
+        _check(position);
+        return _psf->computeShape(position, color);
+    }
+
+    lsst::geom::Box2I doComputeBBox(lsst::geom::Point2D const& position,
+                                    lsst::afw::image::Color const& color) const override {
+        return _psf->computeBBox(position, color);
+    }
+
+    std::shared_ptr<lsst::afw::detection::Psf const> _psf;
+    lsst::geom::Box2D _badRegion;
+};
+
+}  // namespace bar
+}  // namespace foo
+}  // namespace test
+
+#endif  // !LSST_MEAS_BASE_ThrowingPsf_h_INCLUDED
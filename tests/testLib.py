@@ -21,4 +21,5 @@
 
 from lsst.meas.base import SimpleAlgorithm
 from _sillyCentroid import *
+from _throwingPsf import *
 from sillyCentroid import *
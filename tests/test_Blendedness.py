@@ -74,6 +74,45 @@ class BlendednessTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
         self.assertGreater(catalog[1].get('base_Blendedness_abs'), 0)
         self.assertGreater(catalog[2].get('base_Blendedness_abs'), 0)
 
+    def testCatalogParentPixels(self):
+        """Test that measuring the parent pixels of a whole catalog at once
+        matches measuring each source in turn.
+        """
+        self.dataset.addSource(instFlux=1E5, centroid=lsst.geom.Point2D(80, 120))
+        task = self.makeSingleFrameMeasurementTask("base_Blendedness")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        algorithm = task.blendPlugin.cpp
+        for nThreads in (1, 2):
+            expected = catalog.copy(deep=True)
+            for record in expected:
+                algorithm.measureParentPixels(exposure.getMaskedImage(), record)
+            actual = catalog.copy(deep=True)
+            algorithm.measureCatalogParentPixels(exposure.getMaskedImage(), actual, nThreads=nThreads)
+            for suffix in ("old", "raw", "abs", "raw_parent_instFlux", "abs_parent_instFlux",
+                           "raw_parent_xx", "raw_parent_yy", "raw_parent_xy",
+                           "abs_parent_xx", "abs_parent_yy", "abs_parent_xy"):
+                name = "base_Blendedness_" + suffix
+                self.assertFloatsEqual(actual[name], expected[name])
+
+    def testBlendednessThreads(self):
+        """Test that the task measures the parent-image metrics on several
+        threads, with noise replacement enabled, as it does on one.
+        """
+        self.dataset.addSource(instFlux=1E5, centroid=lsst.geom.Point2D(80, 120))
+        results = []
+        for blendednessThreads in (1, 2):
+            config = self.makeSingleFrameMeasurementConfig("base_Blendedness")
+            config.blendednessThreads = blendednessThreads
+            config.validate()
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            results.append(catalog)
+        for suffix in ("raw", "abs", "raw_parent_instFlux", "abs_parent_instFlux"):
+            name = "base_Blendedness_" + suffix
+            self.assertFloatsEqual(results[1][name], results[0][name])
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -128,6 +128,36 @@ class ClassificationTestCase(lsst.meas.base.tests.AlgorithmTestCase, lsst.utils.
         abConfig.plugins["base_ClassificationExtendedness"].psfErrFactor = 1.
         self.assertTrue(runFlagTest(psfFluxErr=float("NaN")))
 
+    def testCatalog(self):
+        """Test that classifying a whole catalog gives the same values and
+        flags as classifying its records one at a time.
+        """
+        config = measBase.SingleFrameMeasurementConfig()
+        config.slots.psfFlux = "base_PsfFlux"
+        config.slots.modelFlux = "base_GaussianFlux"
+        abConfig = catCalc.CatalogCalculationConfig()
+        abConfig.plugins["base_ClassificationExtendedness"].modelErrFactor = 1.
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        abTask = catCalc.CatalogCalculationTask(schema=task.schema, config=abConfig)
+        plugin = abTask.plugins["base_ClassificationExtendedness"]
+        self.assertEqual(plugin.plugType, "multi")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=2)
+        task.run(catalog, exposure)
+        catalog[0].set("base_GaussianFlux_instFluxErr", float("NaN"))
+        catalog[1].set("base_PsfFlux_flag", True)
+        self.assertTrue(catalog.isContiguous())
+        expected = catalog.copy(deep=True)
+
+        plugin.calculate(catalog)
+        for record in expected:
+            plugin.calculate(record)
+        self.assertFloatsEqual(catalog["base_ClassificationExtendedness_value"],
+                               expected["base_ClassificationExtendedness_value"], ignoreNaNs=True)
+        self.assertEqual(list(catalog["base_ClassificationExtendedness_flag"]),
+                         list(expected["base_ClassificationExtendedness_flag"]))
+        self.assertTrue(catalog[0].get("base_ClassificationExtendedness_flag"))
+        self.assertTrue(catalog[1].get("base_ClassificationExtendedness_flag"))
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
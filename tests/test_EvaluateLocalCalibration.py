@@ -24,6 +24,7 @@ import numpy as np
 import unittest
 
 import lsst.geom
+import lsst.pex.config
 import lsst.utils.tests
 import lsst.meas.base.tests
 
@@ -109,6 +110,80 @@ class TestLocalWcs(lsst.meas.base.tests.AlgorithmTestCase,
                             - record.get(self.pluginName + "_CDMatrix_2_1")
                             * record.get(self.pluginName + "_CDMatrix_1_2"))))
 
+    def testMeasureCatalog(self):
+        """Test that measuring all sources at once gives the same results as
+        measuring them one at a time.
+        """
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(-10.3, -25.1))
+        self.dataset.addSource(70000.0, lsst.geom.Point2D(110.8, 120.4))
+        results = []
+        for doMeasureCatalog in (False, True):
+            config = self.makeSingleFrameMeasurementConfig(self.pluginName)
+            config.plugins.names.add("base_LocalPhotoCalib")
+            config.doReplaceWithNoise = False
+            config.doMeasureCatalog = doMeasureCatalog
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            results.append(catalog)
+        for suffix in ("_CDMatrix_1_1", "_CDMatrix_1_2", "_CDMatrix_2_1", "_CDMatrix_2_2"):
+            self.assertFloatsAlmostEqual(results[1][self.pluginName + suffix],
+                                         results[0][self.pluginName + suffix], rtol=1e-8)
+        self.assertFloatsEqual(results[1]["base_LocalPhotoCalib"], results[0]["base_LocalPhotoCalib"])
+        self.assertFloatsEqual(results[1]["base_LocalPhotoCalibErr"], results[0]["base_LocalPhotoCalibErr"])
+
+    def testMeasureCatalogForced(self):
+        """Test that measuring all sources at once in forced measurement
+        gives the same results as measuring them one at a time.
+        """
+        self.dataset.addSource(70000.0, lsst.geom.Point2D(110.8, 120.4))
+        measWcs = self.dataset.makePerturbedWcs(self.dataset.exposure.getWcs(), randomSeed=5)
+        measDataset = self.dataset.transform(measWcs)
+        refCat = self.dataset.catalog
+        refWcs = self.dataset.exposure.getWcs()
+        results = []
+        for doMeasureCatalog in (False, True):
+            config = self.makeForcedMeasurementConfig(self.pluginName)
+            config.doReplaceWithNoise = False
+            config.doMeasureCatalog = doMeasureCatalog
+            task = self.makeForcedMeasurementTask(config=config)
+            exposure, _ = measDataset.realize(10.0, measDataset.makeMinimalSchema(), randomSeed=5)
+            measCat = task.generateMeasCat(exposure, refCat, refWcs)
+            task.run(measCat, exposure, refCat, refWcs)
+            results.append(measCat)
+        for suffix in ("_CDMatrix_1_1", "_CDMatrix_1_2", "_CDMatrix_2_1", "_CDMatrix_2_2"):
+            self.assertFloatsAlmostEqual(results[1][self.pluginName + suffix],
+                                         results[0][self.pluginName + suffix], rtol=1e-8)
+
+    def testMeasureCatalogNoCentroid(self):
+        """Test that without a centroid slot, measuring all sources at once
+        flags every source, as measuring them one at a time does.
+        """
+        for doMeasureCatalog in (False, True):
+            config = self.makeSingleFrameMeasurementConfig(self.pluginName)
+            config.slots.centroid = None
+            config.doReplaceWithNoise = False
+            config.doMeasureCatalog = doMeasureCatalog
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            self.assertTrue(np.all(catalog[self.pluginName + "_flag"]))
+
+    def testMeasureCatalogValidation(self):
+        """Test that catalog-level measurement is rejected with noise
+        replacement, or before a per-source plugin.
+        """
+        config = self.makeSingleFrameMeasurementConfig(self.pluginName)
+        config.doMeasureCatalog = True
+        with self.assertRaises(lsst.pex.config.FieldValidationError):
+            config.validate()
+        config.doReplaceWithNoise = False
+        config.validate()
+        # base_PsfFlux has the same execution order as base_LocalWcs.
+        config.plugins.names.add("base_PsfFlux")
+        with self.assertRaises(lsst.pex.config.FieldValidationError):
+            self.makeSingleFrameMeasurementTask(config=config)
+
     def testWcsIsNone(self):
         with self.assertNoLogs(level=logging.WARNING) and self.assertLogs(level=logging.DEBUG):
             task = self.makeSingleFrameMeasurementTask(self.pluginName)
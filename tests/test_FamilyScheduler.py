@@ -0,0 +1,106 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.utils.tests
+
+import lsst.meas.base
+from lsst.meas.base.tests import AlgorithmTestCase
+
+
+class FamilySchedulerTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(140, 160))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(20.2, 30.7))
+        with self.dataset.addBlend() as family:
+            family.addChild(120000.0, lsst.geom.Point2D(70.3, 72.1))
+            family.addChild(80000.0, lsst.geom.Point2D(75.6, 69.4))
+            family.addChild(50000.0, lsst.geom.Point2D(68.1, 77.9))
+        self.dataset.addSource(60000.0, lsst.geom.Point2D(110.5, 130.2))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def testRun(self):
+        """Test that every family is run exactly once, largest-first when
+        ordering by cost, and with any exception propagated.
+        """
+        costs = np.array([1.0, 50.0, 3.0, 20.0, 2.0, 7.0, 0.5])
+        config = lsst.meas.base.FamilySchedulerConfig()
+        scheduler = lsst.meas.base.FamilyScheduler(config)
+        calls = []
+        actual = scheduler.run(calls.append, costs)
+        self.assertEqual(calls, list(range(len(costs))))
+        self.assertEqual(actual.shape, costs.shape)
+
+        config.orderByCost = True
+        calls = []
+        scheduler.run(calls.append, costs)
+        self.assertEqual(calls, list(np.argsort(-costs)))
+
+        def fail(i):
+            if i == 3:
+                raise RuntimeError("test failure")
+
+        with self.assertRaises(RuntimeError):
+            scheduler.run(fail, costs)
+
+    def testMeasurement(self):
+        """Test that measuring families in order of cost gives the same
+        results as measuring them in catalog order, and that cost summaries
+        are recorded.
+        """
+        results = []
+        for orderByCost in (False, True):
+            config = self.makeSingleFrameMeasurementConfig("base_PsfFlux")
+            config.scheduler.orderByCost = orderByCost
+            config.scheduler.doRecordCosts = True
+            task = self.makeSingleFrameMeasurementTask(config=config)
+            exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+            task.run(catalog, exposure)
+            results.append(catalog)
+            metadata = task.metadata
+            self.assertGreater(metadata[lsst.meas.base.FamilyScheduler.PREDICTED_TOTAL_KEY], 0.0)
+            total = metadata[lsst.meas.base.FamilyScheduler.ACTUAL_TOTAL_KEY]
+            self.assertGreaterEqual(total, metadata[lsst.meas.base.FamilyScheduler.ACTUAL_MAX_KEY])
+            self.assertIn(lsst.meas.base.FamilyScheduler.SCALE_KEY, metadata)
+            self.assertIn(lsst.meas.base.FamilyScheduler.CORRELATION_KEY, metadata)
+        self.assertFloatsEqual(results[1]["base_PsfFlux_instFlux"], results[0]["base_PsfFlux_instFlux"])
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -21,6 +21,7 @@
 
 import unittest
 
+import lsst.afw.table
 import lsst.geom
 import lsst.meas.base.tests
 import lsst.utils.tests
@@ -53,6 +54,22 @@ class FootprintAreaTestCase(lsst.meas.base.tests.AlgorithmTestCase,
         self.assertEqual(record.getFootprint().getArea(),
                          record.get("base_FootprintArea_value"))
 
+    def testComputeFootprintAreas(self):
+        """Test computing the footprint areas of a whole catalog in one call,
+        including for a non-contiguous catalog.
+        """
+        self.dataset.addSource(50000.0, lsst.geom.Point2D(90.3, 20.6))
+        schema = self.dataset.makeMinimalSchema()
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=0)
+        areas = lsst.meas.base.computeFootprintAreas(catalog)
+        self.assertEqual(list(areas), [record.getFootprint().getArea() for record in catalog])
+
+        reversedCatalog = lsst.afw.table.SourceCatalog(catalog.table)
+        for record in reversed(catalog):
+            reversedCatalog.append(record)
+        self.assertFalse(reversedCatalog.isContiguous())
+        self.assertEqual(list(lsst.meas.base.computeFootprintAreas(reversedCatalog)), list(areas[::-1]))
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -0,0 +1,158 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import numpy as np
+
+import lsst.geom
+import lsst.meas.base.tests
+import lsst.pex.exceptions
+import lsst.utils.tests
+from lsst.meas.base import FootprintIndex
+
+
+def makeBoxes(nBoxes, seed):
+    """Make random boxes, some of them empty.
+    """
+    rng = np.random.RandomState(seed)
+    boxes = []
+    for i in range(nBoxes):
+        x, y = rng.randint(0, 500, size=2)
+        width, height = rng.randint(-2, 30, size=2)
+        if width <= 0 or height <= 0:
+            boxes.append(lsst.geom.Box2I())
+        else:
+            boxes.append(lsst.geom.Box2I(lsst.geom.Point2I(x, y), lsst.geom.Extent2I(width, height)))
+    return boxes
+
+
+class FootprintIndexTestCase(lsst.utils.tests.TestCase):
+
+    def testQuery(self):
+        """Test that queries of random boxes agree with a brute-force search,
+        for several node capacities.
+        """
+        boxes = makeBoxes(500, seed=1)
+        regions = makeBoxes(50, seed=2)
+        regions.append(lsst.geom.Box2I(lsst.geom.Point2I(-10, -10), lsst.geom.Extent2I(600, 600)))
+        for nodeCapacity in (2, 5, FootprintIndex.DEFAULT_NODE_CAPACITY):
+            with self.subTest(nodeCapacity=nodeCapacity):
+                index = FootprintIndex(boxes, nodeCapacity=nodeCapacity)
+                self.assertEqual(len(index), sum(not box.isEmpty() for box in boxes))
+                self.assertEqual(index.getInputSize(), len(boxes))
+                self.assertGreater(index.getDepth(), 1)
+                for region in regions:
+                    expected = [i for i, box in enumerate(boxes) if box.overlaps(region)]
+                    self.assertEqual(list(index.query(region)), expected)
+                for i in range(0, len(boxes), 7):
+                    expected = [j for j, box in enumerate(boxes) if j != i and box.overlaps(boxes[i])]
+                    self.assertEqual(list(index.queryNeighbors(i)), expected)
+
+    def testBBox(self):
+        boxes = makeBoxes(100, seed=3)
+        index = FootprintIndex(boxes)
+        expected = lsst.geom.Box2I()
+        for i, box in enumerate(boxes):
+            expected.include(box)
+            self.assertEqual(index.getBBox(i), box)
+        self.assertEqual(index.getBBox(), expected)
+        with self.assertRaises(lsst.pex.exceptions.OutOfRangeError):
+            index.getBBox(len(boxes))
+
+    def testOverlapGroups(self):
+        """Test that overlapping boxes, directly or through others, are in the
+        same group, and that no others are.
+        """
+        boxes = makeBoxes(300, seed=4)
+        labels = FootprintIndex(boxes).computeOverlapGroups()
+        # Flood-fill the overlap graph by brute force.
+        expected = np.full(len(boxes), -1)
+        nGroups = 0
+        for i, box in enumerate(boxes):
+            if box.isEmpty() or expected[i] >= 0:
+                continue
+            expected[i] = nGroups
+            stack = [i]
+            while stack:
+                j = stack.pop()
+                for k, other in enumerate(boxes):
+                    if expected[k] < 0 and other.overlaps(boxes[j]):
+                        expected[k] = nGroups
+                        stack.append(k)
+            nGroups += 1
+        np.testing.assert_array_equal(labels, expected)
+
+    def testEmpty(self):
+        index = FootprintIndex([])
+        self.assertEqual(len(index), 0)
+        self.assertEqual(index.getDepth(), 0)
+        self.assertTrue(index.getBBox().isEmpty())
+        self.assertEqual(len(index.query(lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                                         lsst.geom.Extent2I(10, 10)))), 0)
+        self.assertEqual(len(index.computeOverlapGroups()), 0)
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            FootprintIndex([], nodeCapacity=1)
+
+    def testCatalog(self):
+        """Test indexing the Footprints of a catalog, including a record with
+        no Footprint.
+        """
+        bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(200, 200))
+        dataset = lsst.meas.base.tests.TestDataset(bbox)
+        dataset.addSource(100000.0, lsst.geom.Point2D(50.1, 49.8))
+        with dataset.addBlend() as family:
+            family.addChild(50000.0, lsst.geom.Point2D(140.3, 150.6))
+            family.addChild(60000.0, lsst.geom.Point2D(146.2, 152.1))
+        dataset.addSource(100000.0, lsst.geom.Point2D(150.0, 40.0))
+        exposure, catalog = dataset.realize(10.0, dataset.makeMinimalSchema(), randomSeed=0)
+        catalog[-1].setFootprint(None)
+
+        index = FootprintIndex(catalog)
+        self.assertEqual(index.getInputSize(), len(catalog))
+        self.assertEqual(len(index), len(catalog) - 1)
+        footprintBoxes = [record.getFootprint().getBBox() for record in catalog[:-1]]
+        for i, box in enumerate(footprintBoxes):
+            self.assertEqual(index.getBBox(i), box)
+            expected = [j for j, other in enumerate(footprintBoxes) if j != i and other.overlaps(box)]
+            self.assertEqual(list(index.queryNeighbors(i)), expected)
+        self.assertTrue(index.getBBox(len(catalog) - 1).isEmpty())
+        self.assertEqual(len(index.queryNeighbors(len(catalog) - 1)), 0)
+
+        # The blend's parent and children overlap each other but not the
+        # isolated source.
+        labels = index.computeOverlapGroups()
+        self.assertEqual(labels[0], 0)
+        self.assertEqual(list(labels[1:4]), [1, 1, 1])
+        self.assertEqual(labels[-1], -1)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
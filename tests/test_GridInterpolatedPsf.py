@@ -0,0 +1,168 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+import unittest
+
+import lsst.geom
+import lsst.afw.detection
+import lsst.afw.math
+import lsst.daf.base
+import lsst.pex.exceptions
+import lsst.utils.tests
+
+import lsst.meas.base
+from lsst.meas.base.tests import AlgorithmTestCase
+
+
+class GridInterpolatedPsfTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.center = lsst.geom.Point2D(50.1, 49.8)
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0),
+                                    lsst.geom.Extent2I(100, 120))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, self.center)
+        self.exactPsf = lsst.afw.detection.GaussianPsf(17, 17, 2.0)
+
+    def tearDown(self):
+        del self.center
+        del self.bbox
+        del self.dataset
+        del self.exactPsf
+
+    def testGrid(self):
+        """Test grid construction and interpolation of a constant PSF, which
+        should be reproduced to rounding error.
+        """
+        ctrl = lsst.meas.base.GridInterpolatedPsfControl()
+        ctrl.gridSpacing = 40
+        approxPsf = lsst.meas.base.GridInterpolatedPsf(self.exactPsf, self.bbox, ctrl)
+        self.assertEqual(approxPsf.getNx(), 4)
+        self.assertEqual(approxPsf.getNy(), 4)
+        self.assertEqual(approxPsf.getGridBBox(), self.bbox)
+        self.assertLess(approxPsf.getMaxKernelError(), 1E-12)
+        self.assertLess(approxPsf.getMaxShapeError(), 1E-12)
+        self.assertTrue(approxPsf.isAccurate())
+        for position in (self.center, lsst.geom.Point2D(0.0, 0.0), lsst.geom.Point2D(250.0, -30.0)):
+            exact = self.exactPsf.computeKernelImage(position)
+            approx = approxPsf.computeKernelImage(position)
+            self.assertEqual(approx.getBBox(), exact.getBBox())
+            self.assertFloatsAlmostEqual(approx.array, exact.array, atol=1E-14)
+            self.assertFloatsAlmostEqual(approxPsf.computeShape(position).getParameterVector(),
+                                         self.exactPsf.computeShape(position).getParameterVector(),
+                                         rtol=1E-12)
+            self.assertFloatsAlmostEqual(approxPsf.computeApertureFlux(3.0, position),
+                                         self.exactPsf.computeApertureFlux(3.0, position), rtol=1E-14)
+        # Clones should share the grid and error bounds.
+        clone = approxPsf.clone()
+        self.assertEqual(clone.getNx(), approxPsf.getNx())
+        self.assertEqual(clone.getMaxKernelError(), approxPsf.getMaxKernelError())
+
+    def makeVariablePsf(self):
+        """Return a Gaussian PSF whose widths grow linearly across the bbox.
+        """
+        spatialFunctions = [lsst.afw.math.PolynomialFunction2D(1) for _ in range(3)]
+        kernel = lsst.afw.math.AnalyticKernel(17, 17, lsst.afw.math.GaussianFunction2D(1.0, 1.0, 0.0),
+                                              spatialFunctions)
+        kernel.setSpatialParameters([[2.0, 0.005, 0.0], [2.0, 0.0, 0.005], [0.0, 0.0, 0.0]])
+        return lsst.afw.detection.KernelPsf(kernel)
+
+    def testSpatiallyVarying(self):
+        """Test that a fine grid reproduces a spatially varying PSF, and that
+        a grid too coarse to follow the variation is reported as inaccurate.
+        """
+        exactPsf = self.makeVariablePsf()
+        ctrl = lsst.meas.base.GridInterpolatedPsfControl()
+        ctrl.gridSpacing = 5
+        fine = lsst.meas.base.GridInterpolatedPsf(exactPsf, self.bbox, ctrl)
+        self.assertTrue(fine.isAccurate())
+        for position in (self.center, lsst.geom.Point2D(12.3, 97.6), lsst.geom.Point2D(88.8, 3.1)):
+            exact = exactPsf.computeKernelImage(position)
+            approx = fine.computeKernelImage(position)
+            self.assertEqual(approx.getBBox(), exact.getBBox())
+            self.assertFloatsAlmostEqual(approx.array, exact.array,
+                                         atol=ctrl.maxRelativeError*exact.array.max())
+        ctrl.gridSpacing = 200
+        coarse = lsst.meas.base.GridInterpolatedPsf(exactPsf, self.bbox, ctrl)
+        self.assertEqual(coarse.getNx(), 2)
+        self.assertEqual(coarse.getNy(), 2)
+        self.assertGreater(coarse.getMaxKernelError(), ctrl.maxRelativeError)
+        self.assertFalse(coarse.isAccurate())
+
+    def testInvalidControl(self):
+        """Test that invalid control parameters are rejected.
+        """
+        ctrl = lsst.meas.base.GridInterpolatedPsfControl()
+        ctrl.nCheckPoints = 0
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            lsst.meas.base.GridInterpolatedPsf(self.exactPsf, self.bbox, ctrl)
+        ctrl = lsst.meas.base.GridInterpolatedPsfControl()
+        ctrl.gridSpacing = 0
+        with self.assertRaises(lsst.pex.exceptions.InvalidParameterError):
+            lsst.meas.base.GridInterpolatedPsf(self.exactPsf, self.bbox, ctrl)
+
+    def testSingleFrameMeasurement(self):
+        """Test that the measurement task installs the approximation only
+        while measuring, and records its error bounds.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_PsfFlux")
+        config.doApproximatePsf = True
+        config.approximatePsf.gridSpacing = 50
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        exposure.setPsf(self.exactPsf)
+        catalog.getTable().setMetadata(lsst.daf.base.PropertyList())
+        task.run(catalog, exposure)
+        self.assertNotIsInstance(exposure.getPsf(), lsst.meas.base.GridInterpolatedPsf)
+        metadata = catalog.getMetadata()
+        self.assertTrue(metadata.getScalar(task.PSF_APPROX_USED))
+        self.assertLess(metadata.getScalar(task.PSF_APPROX_KERNEL_ERROR),
+                        config.approximatePsf.maxRelativeError)
+        record = catalog[0]
+        self.assertFalse(record.get("base_PsfFlux_flag"))
+        self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFlux"), record.get("truth_instFlux"),
+                                     atol=3*record.get("base_PsfFlux_instFluxErr"))
+
+    def testFallback(self):
+        """Test that the exact PSF is used if the error bound is not met.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_PsfFlux")
+        config.doApproximatePsf = True
+        config.approximatePsf.maxRelativeError = -1.0
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=1)
+        catalog.getTable().setMetadata(lsst.daf.base.PropertyList())
+        with task.approximatePsf(exposure, catalog.getMetadata()):
+            self.assertNotIsInstance(exposure.getPsf(), lsst.meas.base.GridInterpolatedPsf)
+        self.assertFalse(catalog.getMetadata().getScalar(task.PSF_APPROX_USED))
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -26,10 +26,12 @@ import numpy as np
 import lsst.geom
 import lsst.afw.image
 import lsst.afw.table
+import lsst.pex.exceptions
 import lsst.utils.tests
 
 from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
                                   SingleFramePluginTransformSetupHelper)
+import testLib
 
 
 def compute_chi2(exposure, centroid, instFlux, maskPlane=None):
@@ -211,6 +213,138 @@ class PsfFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
             # Should have the exact same number of pixels used every time.
             self.assertTrue(np.all(measuredNPixels == expectedNPixels))
 
+    def testSubpixelPhases(self):
+        """Test that tabulated sub-pixel PSF phases introduce only a small
+        flux bias relative to exact shifting, and reproduce the exact PSF
+        images at the tabulated phases.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        offsets = np.linspace(0.0, 1.0, 7, endpoint=False)
+        for i, dx in enumerate(offsets):
+            for j, dy in enumerate(offsets):
+                dataset.addSource(100000.0, lsst.geom.Point2D(10.0 + 12*i + dx, 10.0 + 12*j + dy))
+        exactAlgorithm, schema = self.makeAlgorithm()
+        algorithms = {}
+        for name, interpolate in (("nearest", False), ("blended", True)):
+            ctrl = lsst.meas.base.PsfFluxControl()
+            ctrl.subpixelPhases = 8
+            ctrl.interpolatePhases = interpolate
+            ctrl.phaseCellSize = 32
+            algorithms[name] = lsst.meas.base.PsfFluxAlgorithm(ctrl, f"test_{name}", schema)
+        exposure, catalog = dataset.realize(0.0, schema, randomSeed=0)
+        psf = exposure.getPsf()
+        for name, algorithm in algorithms.items():
+            for record in catalog:
+                exactAlgorithm.measure(record, exposure)
+                algorithm.measure(record, exposure)
+                self.assertFalse(record.get(f"test_{name}_flag"))
+                bias = record.get(f"test_{name}_instFlux")/record.get("base_PsfFlux_instFlux") - 1.0
+                self.assertLess(abs(bias), 1E-3)
+            # Positions that fall exactly on a tabulated phase should give
+            # the exact PSF image (for this spatially-constant PSF).
+            position = lsst.geom.Point2D(40.25, 61.625)
+            exact = psf.computeImage(position)
+            tabulated = algorithm.computePsfImage(psf, position)
+            self.assertEqual(tabulated.getBBox(), exact.getBBox())
+            self.assertFloatsAlmostEqual(tabulated.array, exact.array, atol=1E-14)
+            # Modifying a returned image must not change the table.
+            tabulated.array[:, :] = 0.0
+            tabulated = algorithm.computePsfImage(psf, position)
+            self.assertFloatsAlmostEqual(tabulated.array, exact.array, atol=1E-14)
+
+    def testMeasureCatalog(self):
+        """Test that the batched, multithreaded fit of a catalog matches
+        per-source measurement, and flags sources without positions.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        for i in range(6):
+            for j in range(6):
+                dataset.addSource(50000.0, lsst.geom.Point2D(8.0 + 16.3*i, 5.0 + 20.1*j))
+        algorithm, schema = self.makeAlgorithm()
+        batchAlgorithm = lsst.meas.base.PsfFluxAlgorithm(lsst.meas.base.PsfFluxControl(), "batch", schema)
+        exposure, catalog = dataset.realize(10.0, schema, randomSeed=5)
+        x = catalog["truth_x"].copy()
+        y = catalog["truth_y"].copy()
+        x[3] = np.nan
+        for record in catalog:
+            algorithm.measure(record, exposure)
+        for nThreads in (1, 3):
+            batchAlgorithm.measureCatalog(catalog, exposure, x, y, nThreads=nThreads)
+            for n, record in enumerate(catalog):
+                if n == 3:
+                    self.assertTrue(record.get("batch_flag"))
+                    continue
+                self.assertEqual(record.get("batch_flag"), record.get("base_PsfFlux_flag"))
+                self.assertEqual(record.get("batch_flag_edge"), record.get("base_PsfFlux_flag_edge"))
+                for field in ("instFlux", "instFluxErr", "area", "chi2", "npixels"):
+                    self.assertEqual(record.get(f"batch_{field}"), record.get(f"base_PsfFlux_{field}"))
+        with self.assertRaises(lsst.pex.exceptions.LengthError):
+            batchAlgorithm.measureCatalog(catalog, exposure, x[:-1], y[:-1])
+
+    def testMeasureCatalogPsfFailure(self):
+        """Test that a source at which the PSF cannot be evaluated is
+        flagged by the batched fit, without affecting the others.
+        """
+        dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        for i in range(4):
+            dataset.addSource(50000.0, lsst.geom.Point2D(20.0 + 20.3*i, 40.0 + 5.1*i))
+        algorithm, schema = self.makeAlgorithm()
+        batchAlgorithm = lsst.meas.base.PsfFluxAlgorithm(lsst.meas.base.PsfFluxControl(), "batch", schema)
+        exposure, catalog = dataset.realize(10.0, schema, randomSeed=5)
+        for record in catalog:
+            algorithm.measure(record, exposure)
+        badRegion = lsst.geom.Box2D(lsst.geom.Point2D(35.0, 40.0), lsst.geom.Point2D(45.0, 50.0))
+        exposure.setPsf(testLib.ThrowingPsf(exposure.getPsf(), badRegion))
+        batchAlgorithm.measureCatalog(catalog, exposure, catalog["truth_x"].copy(), catalog["truth_y"].copy())
+        for n, record in enumerate(catalog):
+            if n == 1:
+                self.assertTrue(record.get("batch_flag"))
+                self.assertTrue(np.isnan(record.get("batch_instFlux")))
+                continue
+            self.assertFalse(record.get("batch_flag"))
+            self.assertEqual(record.get("batch_instFlux"), record.get("base_PsfFlux_instFlux"))
+
+    def testMeasureN(self):
+        """Test that the joint fit of a blended family recovers the true
+        fluxes, and agrees with the independent fit for sources that are fit
+        on their own.
+
+        The task calls measureN with the whole family inserted into the
+        noise-replaced image, so noise replacement is left enabled.
+        """
+        with self.dataset.addBlend() as family:
+            family.addChild(instFlux=2E5, centroid=lsst.geom.Point2D(27, 73))
+            family.addChild(instFlux=1.5E5, centroid=lsst.geom.Point2D(30, 71))
+        config = self.makeSingleFrameMeasurementConfig("base_PsfFlux")
+        config.plugins["base_PsfFlux"].doMeasure = False
+        config.plugins["base_PsfFlux"].doMeasureN = True
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        # Results are RNG dependent; we choose a seed that is known to pass.
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=6)
+        task.run(catalog, exposure)
+        children = [record for record in catalog if record.getParent() != 0]
+        self.assertEqual(len(children), 2)
+        for record in children:
+            self.assertFalse(record.get("base_PsfFlux_flag"))
+            self.assertFloatsAlmostEqual(record.get("base_PsfFlux_instFlux"), record.get("truth_instFlux"),
+                                         atol=3*record.get("base_PsfFlux_instFluxErr"))
+        # Compare to independent fits on the same realization: parents are
+        # fit on their own either way, while the errors of the overlapping
+        # children should be inflated by their covariance.
+        independentConfig = self.makeSingleFrameMeasurementConfig("base_PsfFlux")
+        independentTask = self.makeSingleFrameMeasurementTask(config=independentConfig)
+        exposure, independent = self.dataset.realize(10.0, independentTask.schema, randomSeed=6)
+        independentTask.run(independent, exposure)
+        for joint, single in zip(catalog, independent):
+            if joint.getParent() == 0:
+                self.assertFloatsAlmostEqual(joint.get("base_PsfFlux_instFlux"),
+                                             single.get("base_PsfFlux_instFlux"), rtol=1E-6)
+                self.assertFloatsAlmostEqual(joint.get("base_PsfFlux_instFluxErr"),
+                                             single.get("base_PsfFlux_instFluxErr"), rtol=1E-6)
+            else:
+                self.assertGreater(joint.get("base_PsfFlux_instFluxErr"),
+                                   single.get("base_PsfFlux_instFluxErr"))
+
     def testSingleFramePlugin(self):
         task = self.makeSingleFrameMeasurementTask("base_PsfFlux")
         # Results are RNG dependent; we choose a seed that is known to pass.
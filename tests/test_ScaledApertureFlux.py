@@ -23,6 +23,7 @@ import unittest
 import math
 
 import lsst.geom
+import lsst.afw.geom.ellipses
 import lsst.afw.image
 import lsst.afw.table
 from lsst.meas.base.tests import (AlgorithmTestCase, FluxTransformTestCase,
@@ -79,6 +80,59 @@ class ScaledApertureFluxTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
         self.assertFalse(catalog[0].get("base_ScaledApertureFlux_flag_apertureTruncated"))
         self.assertFalse(catalog[0].get("base_ScaledApertureFlux_flag_sincCoeffsTruncated"))
 
+    def testInterpolatedCoefficients(self):
+        """Check that interpolating the coefficients between quantized radii
+        agrees with computing them exactly.
+        """
+        ctrl = lsst.meas.base.ScaledApertureFluxControl()
+        ctrl.radiusStep = 0.0
+        algorithm, schema = self.makeAlgorithm(ctrl)
+        exposure, catalog = self.dataset.realize(10.0, schema, randomSeed=3)
+        algorithm.measure(catalog[0], exposure)
+        exact = catalog[0].get("base_ScaledApertureFlux_instFlux")
+        exactErr = catalog[0].get("base_ScaledApertureFlux_instFluxErr")
+
+        for radiusStep in (0.05, 0.5):
+            ctrl.radiusStep = radiusStep
+            algorithm, _ = self.makeAlgorithm(ctrl)
+            algorithm.cacheCoefficients(exposure)
+            algorithm.measure(catalog[0], exposure)
+            self.assertFloatsAlmostEqual(catalog[0].get("base_ScaledApertureFlux_instFlux"), exact,
+                                         rtol=1E-3)
+            self.assertFloatsAlmostEqual(catalog[0].get("base_ScaledApertureFlux_instFluxErr"), exactErr,
+                                         rtol=1E-2)
+
+        # Interpolation is opt-in.
+        self.assertEqual(lsst.meas.base.ScaledApertureFluxControl().radiusStep, 0.0)
+
+        # Coefficients for a cached radius are exact.
+        radius = 4.0
+        self.assertFloatsEqual(
+            lsst.meas.base.SincCoeffsF.getInterpolated(radius, 0.5).array,
+            lsst.meas.base.SincCoeffsF.get(lsst.afw.geom.ellipses.Axes(radius, radius), 0.0).array
+        )
+
+    def testTaskCachesCoefficients(self):
+        """Check that the measurement task caches the coefficients for the
+        exposure before measuring with interpolated coefficients.
+        """
+        config = self.makeSingleFrameMeasurementConfig("base_ScaledApertureFlux")
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=4)
+        task.run(catalog, exposure)
+        exact = catalog[0].get("base_ScaledApertureFlux_instFlux")
+
+        config.plugins["base_ScaledApertureFlux"].radiusStep = 0.05
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=4)
+        lsst.meas.base.SincCoeffsF.clearCache()
+        task.run(catalog, exposure)
+        self.assertFalse(catalog[0].get("base_ScaledApertureFlux_flag"))
+        self.assertFloatsAlmostEqual(catalog[0].get("base_ScaledApertureFlux_instFlux"), exact, rtol=1E-3)
+        # The source's radius was cached before it was measured, so the
+        # coefficients it used were all found in the cache.
+        self.assertGreater(task.metadata["sincCoeffs.hits"], 0)
+
     def testApertureTruncated(self):
         """Check that a flag is set when the aperture overflows the image.
 
@@ -252,6 +252,70 @@ class SincCoeffTestCase(lsst.utils.tests.TestCase):
         coeff1, coeff2 = self.getCoeffCircle(self.radius2)
         self.assertCached(coeff1, coeff2)
 
+    def testCacheStatistics(self):
+        """Test that hits, misses and cached bytes are counted.
+        """
+        SincCoeffs = measBase.SincCoeffsD
+        SincCoeffs.clearCache()
+        SincCoeffs.resetCacheStatistics()
+        SincCoeffs.cache(0.0, self.radius2)
+        SincCoeffs.get(afwEll.Axes(self.radius2, self.radius2, 0.0), 0.0)
+        SincCoeffs.get(afwEll.Axes(self.radius2, self.radius2, 0.0), 0.0)
+        SincCoeffs.get(self.ellipse, self.inner)  # elliptical apertures are never cached
+        stats = SincCoeffs.getCacheStatistics()
+        self.assertEqual(stats.hits, 2)
+        self.assertEqual(stats.misses, 2)
+        self.assertEqual(stats.evictions, 0)
+        self.assertGreater(stats.computeTime, 0.0)
+        self.assertEqual(stats.entries, 1)
+        entry, = SincCoeffs.getCacheEntries()
+        self.assertAlmostEqual(entry.radius, self.radius2, places=5)
+        self.assertEqual(entry.innerFactor, 0.0)
+        self.assertEqual(entry.hits, 2)
+        self.assertEqual(entry.bytes, stats.bytes)
+        self.assertEqual(SincCoeffs.getCacheBytes(), stats.bytes)
+
+        SincCoeffs.resetCacheStatistics()
+        stats = SincCoeffs.getCacheStatistics()
+        self.assertEqual((stats.hits, stats.misses, stats.entries), (0, 0, 1))
+        SincCoeffs.clearCache()
+        self.assertEqual(SincCoeffs.getCacheStatistics().bytes, 0)
+        self.assertEqual(SincCoeffs.getCacheEntries(), [])
+
+    def testCacheCapacity(self):
+        """Test that the least recently used entries are evicted to keep the
+        cache within its capacity.
+        """
+        SincCoeffs = measBase.SincCoeffsD
+        SincCoeffs.clearCache()
+        SincCoeffs.resetCacheStatistics()
+        radii = (3.0, 3.25, 3.5)
+        try:
+            SincCoeffs.cache(0.0, radii[0])
+            entryBytes = SincCoeffs.getCacheBytes()
+            # All three radii have coefficient images of the same size.
+            SincCoeffs.setCacheCapacity(2*entryBytes)
+            self.assertEqual(SincCoeffs.getCacheCapacity(), 2*entryBytes)
+            SincCoeffs.cache(0.0, radii[1])
+            # Use the first entry so that the second is the least recent.
+            SincCoeffs.get(afwEll.Axes(radii[0], radii[0], 0.0), 0.0)
+            SincCoeffs.cache(0.0, radii[2])
+            stats = SincCoeffs.getCacheStatistics()
+            self.assertEqual(stats.evictions, 1)
+            self.assertEqual(stats.entries, 2)
+            self.assertLessEqual(stats.bytes, 2*entryBytes)
+            self.assertFloatsAlmostEqual(np.array([entry.radius for entry in SincCoeffs.getCacheEntries()]),
+                                         np.array([radii[0], radii[2]]))
+
+            # Lowering the capacity evicts immediately, but keeps the most
+            # recently used entry.
+            SincCoeffs.setCacheCapacity(1)
+            entry, = SincCoeffs.getCacheEntries()
+            self.assertEqual(entry.radius, radii[2])
+        finally:
+            SincCoeffs.setCacheCapacity(0)
+            SincCoeffs.clearCache()
+
 
 class TestMemory(lsst.utils.tests.MemoryTestCase):
     pass
@@ -201,6 +201,43 @@ class TestDiaCalcluation(unittest.TestCase):
                                        0.7071067811865476)
                 self.assertAlmostEqual(diaObject["gChiFlux"], 0.5)
 
+    def testRunColumnar(self):
+        """Test that the columnar API returns the same updated DiaObjects as
+        the run method, for DataFrame and numpy structured array inputs.
+        """
+        expected = self.diaObjCalTask.run(self.diaObjects.copy(),
+                                          self.diaSources.copy(),
+                                          self.updatedDiaObjectIds,
+                                          ["g", "r"]).updatedDiaObjects
+        sortedDiaSources = self.diaSources.sort_values(["diaObjectId", "band"], ignore_index=True)
+        inputs = [(self.diaObjects, sortedDiaSources),
+                  (self.diaObjects.to_records(index=False), sortedDiaSources.to_records(index=False))]
+        for diaObjects, diaSources in inputs:
+            # Update objects in a different order from the catalog.
+            updatedDiaObjectIds = self.updatedDiaObjectIds[::-1]
+            results = self.diaObjCalTask.runColumnar(diaObjects,
+                                                     diaSources,
+                                                     updatedDiaObjectIds,
+                                                     ["g", "r"])
+            updatedDiaObjects = pd.DataFrame(results.updatedDiaObjects)
+            self.assertEqual(type(results.updatedDiaObjects), type(diaObjects))
+            np.testing.assert_array_equal(updatedDiaObjects["diaObjectId"], updatedDiaObjectIds)
+            updatedDiaObjects = updatedDiaObjects.set_index("diaObjectId", drop=False)
+            for column in ["gMeanFlux", "gStdFlux", "gChiFlux", "rMeanFlux", "rStdFlux", "rChiFlux"]:
+                np.testing.assert_array_equal(updatedDiaObjects.loc[self.updatedDiaObjectIds, column],
+                                              expected.loc[self.updatedDiaObjectIds, column])
+
+        with self.assertRaises(ValueError):
+            self.diaObjCalTask.runColumnar(self.diaObjects,
+                                           self.diaSources,
+                                           self.updatedDiaObjectIds,
+                                           ["g"])
+        with self.assertRaises(KeyError):
+            self.diaObjCalTask.runColumnar(self.diaObjects,
+                                           sortedDiaSources,
+                                           np.array([100], dtype=np.int64),
+                                           ["g"])
+
     def testRunUnindexed(self):
         """Test inputing un-indexed catalogs.
         """
@@ -25,6 +25,9 @@ import pandas as pd
 from scipy.stats import skew
 import unittest
 
+import lsst.geom as geom
+import lsst.sphgeom as sphgeom
+
 from lsst.meas.base import (
     MeanDiaPosition, MeanDiaPositionConfig,
     HTMIndexDiaPosition, HTMIndexDiaPositionConfig,
@@ -149,6 +152,35 @@ def make_diaObject_table(objId, plugin, default_value=None, band=None):
     return pd.DataFrame(diaObjects)
 
 
+def make_many_object_sources(band, nObjects=40, seed=1234):
+    """Make interleaved DiaSources for many DiaObjects, with varying numbers
+    of sources (some with no finite fluxes) for testing segmented
+    calculations.
+
+    Returns
+    -------
+    diaObjects : `pandas.DataFrame`
+        DiaObjects with only a ``diaObjectId`` column.
+    diaSources : `pandas.DataFrame`
+        DiaSources with ``psfFlux`` and ``psfFluxErr`` columns.
+    """
+    rng = np.random.default_rng(seed)
+    nSources = rng.integers(1, 30, size=nObjects)
+    objIds = np.repeat(np.arange(nObjects), nSources)
+    objIds = objIds[rng.permutation(len(objIds))]
+    fluxes = rng.normal(10., 3., size=len(objIds))
+    fluxes[rng.random(len(objIds)) < 0.1] = np.nan
+    fluxes[objIds == 0] = np.nan
+    diaObjects = pd.DataFrame({"diaObjectId": np.arange(nObjects)})
+    diaSources = pd.DataFrame(
+        data={"diaObjectId": objIds,
+              "band": len(objIds) * [band],
+              "diaSourceId": np.arange(len(objIds), dtype=int),
+              "psfFlux": fluxes,
+              "psfFluxErr": np.ones(len(objIds))})
+    return diaObjects, diaSources
+
+
 class TestMeanPosition(unittest.TestCase):
 
     def testCalculate(self):
@@ -265,6 +297,36 @@ class TestHTMIndexPosition(unittest.TestCase):
         self.assertEqual(diaObjects.at[objId, "pixelId"],
                          17450571968473)
 
+    def testCalculateMulti(self):
+        """Test that HTM indices computed for many DiaObjects at once, with
+        several threads, match those computed one at a time.
+        """
+        rng = np.random.default_rng(12345)
+        nObjects = 10000
+        diaObjects = pd.DataFrame({"diaObjectId": np.arange(nObjects),
+                                   "ra": rng.uniform(0.0, 360.0, nObjects),
+                                   "dec": np.degrees(np.arcsin(rng.uniform(-1.0, 1.0, nObjects)))})
+        diaObjects.loc[5, "ra"] = np.nan
+        diaSources = pd.DataFrame(
+            data={"diaObjectId": np.arange(nObjects),
+                  "band": nObjects * ["g"],
+                  "diaSourceId": np.arange(nObjects)})
+        config = HTMIndexDiaPositionConfig()
+        config.numThreads = 3
+        plug = HTMIndexDiaPosition(config, "ap_HTMIndex", None)
+        run_multi_plugin(diaObjectCat=diaObjects,
+                         diaSourceCat=diaSources,
+                         band="g",
+                         plugin=plug)
+
+        pixelator = sphgeom.HtmPixelization(config.htmLevel)
+        for objId in range(0, nObjects, 97):
+            expected = pixelator.index(
+                geom.SpherePoint(diaObjects.at[objId, "ra"], diaObjects.at[objId, "dec"],
+                                 geom.degrees).getVector())
+            self.assertEqual(diaObjects.at[objId, "pixelId"], expected)
+        self.assertEqual(diaObjects.at[5, "pixelId"], 0)
+
 
 class TestNDiaSourcesDiaPlugin(unittest.TestCase):
 
@@ -438,6 +500,27 @@ class TestPercentileDiaPsfFlux(unittest.TestCase):
                 diaObjects.at[objId, "r_psfFluxPercentile{:02d}".format(pTile)],
                 testVal)
 
+    def testCalculateManyObjects(self):
+        """Test percentiles computed for many objects at once, with a
+        non-default set of percentiles.
+        """
+        config = PercentileDiaPsfFluxConfig()
+        config.percentiles = [95, 0, 33, 50, 100]
+        config.numThreads = 2
+        plug = PercentileDiaPsfFlux(config, "ap_percentileFlux", None)
+        diaObjects, diaSources = make_many_object_sources("u")
+        fluxes = diaSources["psfFlux"].to_numpy()
+        objIds = diaSources["diaObjectId"].to_numpy()
+        run_multi_plugin(diaObjects, diaSources, "u", plug)
+        for objId in diaObjects["diaObjectId"]:
+            objFluxes = fluxes[objIds == objId]
+            for pTile in config.percentiles:
+                value = diaObjects.at[objId, "u_psfFluxPercentile{:02d}".format(pTile)]
+                if np.all(np.isnan(objFluxes)):
+                    self.assertTrue(np.isnan(value))
+                else:
+                    self.assertAlmostEqual(value, np.nanpercentile(objFluxes, pTile))
+
 
 class TestSigmaDiaPsfFlux(unittest.TestCase):
 
@@ -578,6 +661,24 @@ class TestMadDiaPsfFlux(unittest.TestCase):
                                median_absolute_deviation(fluxes,
                                                          ignore_nan=True))
 
+    def testCalculateManyObjects(self):
+        """Test median absolute deviations computed for many objects at once.
+        """
+        config = MadDiaPsfFluxConfig()
+        config.numThreads = 2
+        plug = MadDiaPsfFlux(config, "ap_madFlux", None)
+        diaObjects, diaSources = make_many_object_sources("u")
+        fluxes = diaSources["psfFlux"].to_numpy()
+        objIds = diaSources["diaObjectId"].to_numpy()
+        run_multi_plugin(diaObjects, diaSources, "u", plug)
+        for objId in diaObjects["diaObjectId"]:
+            objFluxes = fluxes[objIds == objId]
+            value = diaObjects.at[objId, "u_psfFluxMAD"]
+            if np.all(np.isnan(objFluxes)):
+                self.assertTrue(np.isnan(value))
+            else:
+                self.assertAlmostEqual(value, median_absolute_deviation(objFluxes, ignore_nan=True))
+
 
 class TestSkewDiaPsfFlux(unittest.TestCase):
 
@@ -800,6 +901,52 @@ class TestLinearFitDiaPsfFlux(unittest.TestCase):
         self.assertAlmostEqual(diaObjects.loc[objId, "r_psfFluxLinearIntercept"],
                                -1.)
 
+    def testCalculateManyObjects(self):
+        """Test linear fits and maximum slopes for many objects at once, with
+        the light curves shared between the plugins.
+        """
+        diaObjects, diaSources = make_many_object_sources("u")
+        rng = np.random.default_rng(5678)
+        objIds = diaSources["diaObjectId"].to_numpy()
+        times = 60000. + rng.uniform(0., 100., size=len(objIds))
+        times[rng.random(len(objIds)) < 0.05] = np.nan
+        fluxes = diaSources["psfFlux"].to_numpy() + 0.05*(times - 60000.)
+        errors = rng.uniform(0.5, 2., size=len(objIds))
+        errors[rng.random(len(objIds)) < 0.05] = np.nan
+        diaSources["midpointMjdTai"] = times
+        diaSources["psfFlux"] = fluxes
+        diaSources["psfFluxErr"] = errors
+        diaObjects.set_index("diaObjectId", inplace=True, drop=False)
+        diaSources.set_index(["diaObjectId", "band", "diaSourceId"], inplace=True, drop=False)
+        filterDiaSources = diaSources.loc[(slice(None), "u"), :].groupby(level=0)
+
+        cache = {}
+        linearFit = LinearFitDiaPsfFlux(LinearFitDiaPsfFluxConfig(), "ap_LinearFit", None)
+        maxSlope = MaxSlopeDiaPsfFlux(MaxSlopeDiaPsfFluxConfig(), "ap_maxSlopeFlux", None)
+        for plug in (linearFit, maxSlope):
+            self.assertTrue(plug.needsTimeSeries)
+            plug.calculate(diaObjects=diaObjects, diaSources=diaSources.groupby(level=0),
+                           filterDiaSources=filterDiaSources, band="u", timeSeriesCache=cache)
+        self.assertEqual(len(cache), 1)
+
+        for objId in diaObjects["diaObjectId"]:
+            select = (objIds == objId) & ~np.isnan(times) & ~np.isnan(fluxes)
+            fitSelect = select & ~np.isnan(errors)
+            if fitSelect.sum() < 2:
+                self.assertTrue(np.isnan(diaObjects.at[objId, "u_psfFluxLinearSlope"]))
+            else:
+                slope, intercept = np.polyfit(times[fitSelect], fluxes[fitSelect], 1,
+                                              w=1/errors[fitSelect])
+                self.assertAlmostEqual(diaObjects.at[objId, "u_psfFluxLinearSlope"], slope, places=6)
+                self.assertAlmostEqual(diaObjects.at[objId, "u_psfFluxLinearIntercept"] / intercept, 1.,
+                                       places=6)
+            if select.sum() < 2:
+                self.assertTrue(np.isnan(diaObjects.at[objId, "u_psfFluxMaxSlope"]))
+            else:
+                order = np.argsort(times[select])
+                expected = (np.diff(fluxes[select][order]) / np.diff(times[select][order])).max()
+                self.assertAlmostEqual(diaObjects.at[objId, "u_psfFluxMaxSlope"], expected)
+
 
 class TestStetsonJDiaPsfFlux(unittest.TestCase):
 
@@ -861,6 +1008,48 @@ class TestStetsonJDiaPsfFlux(unittest.TestCase):
         self.assertAlmostEqual(diaObjects.at[objId, "r_psfFluxStetsonJ"],
                                -0.5412797916187173)
 
+    def testCalculateManyObjects(self):
+        """Test that the stetsonJ statistic computed for many objects at once
+        matches the per-object calculation, to rounding.
+        """
+        rng = np.random.default_rng(1234)
+        nObjects = 50
+        nSources = rng.integers(1, 15, size=nObjects)
+        objIds = np.repeat(np.arange(nObjects), nSources)
+        # Interleave the sources of different objects.
+        order = rng.permutation(len(objIds))
+        objIds = objIds[order]
+        fluxes = rng.normal(10., 2., size=len(objIds))
+        fluxes[rng.random(len(objIds)) < 0.05] = 100.
+        errors = rng.uniform(0.5, 2., size=len(objIds))
+        fluxes[rng.random(len(objIds)) < 0.05] = np.nan
+        errors[rng.random(len(objIds)) < 0.05] = np.nan
+        diaObjects = pd.DataFrame(
+            {"diaObjectId": np.arange(nObjects),
+             "u_psfFluxMean": [np.nanmean(fluxes[objIds == objId]) for objId in range(nObjects)]})
+        diaSources = pd.DataFrame(
+            data={"diaObjectId": objIds,
+                  "band": len(objIds) * ["u"],
+                  "diaSourceId": np.arange(len(objIds), dtype=int),
+                  "psfFlux": fluxes,
+                  "psfFluxErr": errors})
+
+        plug = StetsonJDiaPsfFlux(StetsonJDiaPsfFluxConfig(),
+                                  "ap_StetsonJ",
+                                  None)
+        run_multi_plugin(diaObjects, diaSources, "u", plug)
+        for objId in range(nObjects):
+            good = (objIds == objId) & ~np.isnan(fluxes) & ~np.isnan(errors)
+            if good.sum() < 2:
+                self.assertTrue(np.isnan(diaObjects.at[objId, "u_psfFluxStetsonJ"]))
+            else:
+                expected = plug._stetson_J(fluxes[good], errors[good],
+                                           diaObjects.at[objId, "u_psfFluxMean"])
+                # The sums are accumulated in a different order, which may
+                # also change when the iterative mean stops.
+                self.assertAlmostEqual(diaObjects.at[objId, "u_psfFluxStetsonJ"], expected,
+                                       delta=1e-6*max(abs(expected), 1.0))
+
 
 class TestWeightedMeanDiaTotFlux(unittest.TestCase):
 
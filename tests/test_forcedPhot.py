@@ -26,6 +26,7 @@ run without errors, but do not check anything about their algorithmic quality.
 """
 
 
+import concurrent.futures
 import dataclasses
 import unittest
 
@@ -34,11 +35,13 @@ import numpy as np
 import pandas as pd
 
 import lsst.afw.image
+import lsst.afw.math
 from lsst.afw.geom import SkyWcs
 from lsst.afw.math import ChebyshevBoundedField
 from lsst.afw.table import SourceCatalog
 from lsst.daf.butler import DataCoordinate, DatasetRef, DimensionUniverse
 from lsst.meas.base import ForcedPhotCcdTask, ForcedPhotCcdFromDataFrameTask
+from lsst.meas.base.forcedPhotCcd import _ReadAheadHandle
 from lsst.pipe.base import InMemoryDatasetHandle, PipelineGraph, Struct
 import lsst.meas.base.tests
 import lsst.utils.tests
@@ -67,8 +70,12 @@ class _MockQuantumContext:
     quantum: _MockQuantum
     outputs: dict
 
-    def get(self, inputs: _MockRefsStruct) -> object:
-        return inputs._datasets
+    def get(self, inputs: _MockRefsStruct | list) -> object:
+        if isinstance(inputs, _MockRefsStruct):
+            return inputs._datasets
+        # Deferred-load connections are given handles in place of refs, which
+        # are returned as-is.
+        return inputs
 
     def put(self, datasets: Struct, outputs: _MockRefsStruct) -> None:
         outputs._datasets = datasets.__dict__.copy()
@@ -146,6 +153,90 @@ class ForcedPhotCcdTaskTestCase(ForcedPhotometryTests, lsst.utils.tests.TestCase
         self.assertFloatsNotEqual(measCat["base_TransformedCentroid_x"], self.refCat['truth_x'])
         self.assertFloatsNotEqual(measCat["base_TransformedCentroid_y"], self.refCat['truth_y'])
 
+    def testRunBatchPsfFlux(self):
+        """Test that batched PSF photometry matches per-source measurement."""
+        results = {}
+        for batch in (False, True):
+            config = ForcedPhotCcdTask.ConfigClass()
+            # Batch mode measures the image with all sources present.
+            config.measurement.doReplaceWithNoise = False
+            if batch:
+                config.configureBatchPsfFlux(nThreads=2)
+            config.validate()
+            task = ForcedPhotCcdTask(refSchema=self.refCat.schema, config=config)
+            measCat = task.measurement.generateMeasCat(self.exposure, self.refCat, self.exposure.wcs)
+            task.run(measCat, self.exposure, self.refCat, self.offsetWcs)
+            results[batch] = measCat
+        for field in ("instFlux", "instFluxErr", "area", "chi2", "npixels"):
+            self.assertFloatsEqual(results[True][f"base_PsfFlux_{field}"],
+                                   results[False][f"base_PsfFlux_{field}"])
+        np.testing.assert_array_equal(results[True]["base_PsfFlux_flag"], results[False]["base_PsfFlux_flag"])
+
+        config = ForcedPhotCcdTask.ConfigClass()
+        config.configureBatchPsfFlux()
+        config.measurement.doReplaceWithNoise = True
+        with self.assertRaises(ValueError):
+            config.validate()
+
+    def testTransformReferences(self):
+        """Test that transforming reference positions and shapes for all
+        sources at once matches transforming them one at a time.
+        """
+        results = {}
+        for doTransformReferences in (False, True):
+            config = ForcedPhotCcdTask.ConfigClass()
+            config.measurement.plugins.names |= {"base_TransformedShape"}
+            config.measurement.doTransformReferences = doTransformReferences
+            task = ForcedPhotCcdTask(refSchema=self.refCat.schema, config=config)
+            measCat = task.measurement.generateMeasCat(self.exposure, self.refCat, self.exposure.wcs)
+            task.run(measCat, self.exposure, self.refCat, self.offsetWcs)
+            results[doTransformReferences] = measCat
+        for field in ("base_TransformedCentroid_x", "base_TransformedCentroid_y"):
+            self.assertFloatsAlmostEqual(results[True][field], results[False][field], rtol=1e-10)
+        for field in ("base_TransformedShape_xx", "base_TransformedShape_yy", "base_TransformedShape_xy"):
+            self.assertFloatsAlmostEqual(results[True][field], results[False][field], rtol=1e-6, atol=1e-8)
+        self.assertFloatsAlmostEqual(results[True]["base_PsfFlux_instFlux"],
+                                     results[False]["base_PsfFlux_instFlux"], rtol=1e-8)
+
+    def testApplySkyCorr(self):
+        """Test that applying the sky correction in tiles gives the same
+        result as subtracting the full background image, and that only tiles
+        near the given regions are corrected in lazy mode.
+        """
+        bbox = self.exposure.getBBox()
+        ramp = lsst.afw.image.ImageF(bbox)
+        y, x = np.mgrid[bbox.getMinY():bbox.getMaxY() + 1, bbox.getMinX():bbox.getMaxX() + 1]
+        ramp.array[:, :] = 5.0 + 0.1*x - 0.05*y + 1E-3*x*y
+        skyCorr = lsst.afw.math.BackgroundList()
+        for nBins in (4, 3):
+            background = lsst.afw.math.makeBackground(ramp, lsst.afw.math.BackgroundControl(nBins, nBins))
+            skyCorr.append((background, lsst.afw.math.Interpolate.AKIMA_SPLINE,
+                            lsst.afw.math.REDUCE_INTERP_ORDER, lsst.afw.math.ApproximateControl.UNKNOWN,
+                            0, 0, False))
+
+        results = {}
+        for mode in ("full", "tiled"):
+            config = ForcedPhotCcdTask.ConfigClass()
+            config.skyCorrMode = mode
+            config.skyCorrTileSize = 32
+            task = ForcedPhotCcdTask(refSchema=self.refCat.schema, config=config)
+            exposure = self.exposure.clone()
+            task.prepareCalibratedExposure(exposure, skyCorr=skyCorr)
+            results[mode] = exposure.image.array
+        self.assertFloatsAlmostEqual(results["tiled"], results["full"], rtol=1E-6, atol=1E-5)
+
+        config.skyCorrLazyMargin = 0
+        task = ForcedPhotCcdTask(refSchema=self.refCat.schema, config=config)
+        exposure = self.exposure.clone()
+        region = lsst.geom.Box2I(lsst.geom.Point2I(40, 10), lsst.geom.Extent2I(5, 5))
+        task.applySkyCorr(exposure, skyCorr, regions=[region])
+        # Only the tile [32, 63] x [0, 31] is corrected.
+        self.assertFloatsAlmostEqual(exposure.image.array[0:32, 32:64], results["full"][0:32, 32:64],
+                                     rtol=1E-6, atol=1E-5)
+        self.assertFloatsEqual(exposure.image.array[32:, :], self.exposure.image.array[32:, :])
+        self.assertFloatsEqual(exposure.image.array[:, :32], self.exposure.image.array[:, :32])
+        self.assertFloatsEqual(exposure.image.array[:, 64:], self.exposure.image.array[:, 64:])
+
     def testRunQuantum(self):
         """Test ForcedPhotCcdTask.runQuantum."""
         config = ForcedPhotCcdTask.ConfigClass()
@@ -156,6 +247,51 @@ class ForcedPhotCcdTaskTestCase(ForcedPhotometryTests, lsst.utils.tests.TestCase
             "base_TransformedCentroid"
         )
 
+    def testRunQuantumPipelined(self):
+        """Test ForcedPhotCcdTask.runQuantum with reference catalogs read on
+        background threads.
+        """
+        config = ForcedPhotCcdTask.ConfigClass()
+        config.doPipelineInputs = True
+        self.checkRunQuantum(
+            config,
+            lambda _: SourceCatalog(self.refCat.schema),
+            InMemoryDatasetHandle(self.refCat),
+            "base_TransformedCentroid",
+        )
+
+    def testReadAheadHandleParameters(self):
+        """Test that a reference catalog being read ahead cannot be given
+        new read parameters.
+        """
+        future = concurrent.futures.Future()
+        future.set_result(self.refCat)
+        handle = _ReadAheadHandle(future, self.quantum_context.quantum.dataId)
+        self.assertIs(handle.get(), self.refCat)
+        with self.assertRaises(ValueError):
+            handle.get(parameters={"columns": ["coord_ra"]})
+
+    def testRunQuantumPipelinedArrowAstropy(self):
+        """Test ForcedPhotCcdTask.runQuantum with ArrowAstropy reference
+        catalogs read, with column parameters, on background threads.
+        """
+        config = ForcedPhotCcdTask.ConfigClass()
+        config.configureParquetRefCat()
+        config.doPipelineInputs = True
+        ref_cat = astropy.table.Table(
+            {
+                "diaObjectId": self.refCat["id"],
+                "ra": self.refCat["coord_ra"]*180/np.pi,
+                "dec": self.refCat["coord_dec"]*180/np.pi
+            }
+        )
+        self.checkRunQuantum(
+            config,
+            get_init_input=None,
+            ref_cat_input=InMemoryDatasetHandle(ref_cat, storageClass="ArrowAstropy"),
+            centroid_name="base_TransformedCentroidFromCoord"
+        )
+
     def testRunQuantumArrowAstropy(self):
         """Test ForcedPhotCcdTask.runQuantum, with input reconfigured to
         ArrowAstropy.
@@ -253,7 +389,8 @@ class ForcedPhotCcdTaskTestCase(ForcedPhotometryTests, lsst.utils.tests.TestCase
                     exposure_dataset_type,
                     self.quantum_context.quantum.dataId.subset(exposure_dataset_type.dimensions),
                     run="arbitrary",
-                )
+                ),
+                "refCat": [ref_cat_input],
             }
         )
         output_refs = _MockRefsStruct({}, {})
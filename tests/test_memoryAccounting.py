@@ -0,0 +1,107 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import unittest
+
+import lsst.afw.detection
+import lsst.afw.geom.ellipses
+import lsst.geom
+import lsst.utils.tests
+
+import lsst.meas.base
+from lsst.meas.base.tests import AlgorithmTestCase
+
+
+class MemoryAccountingTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 120))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(20.2, 30.7))
+        with self.dataset.addBlend() as family:
+            family.addChild(120000.0, lsst.geom.Point2D(60.3, 72.1))
+            family.addChild(80000.0, lsst.geom.Point2D(65.6, 69.4))
+
+    def tearDown(self):
+        del self.bbox
+        del self.dataset
+
+    def testFootprintBytes(self):
+        """Test the sizes reported for plain and heavy footprints.
+        """
+        exposure, catalog = self.dataset.realize(10.0, self.dataset.makeMinimalSchema(), randomSeed=0)
+        footprint = catalog[0].getFootprint()
+        plain = lsst.afw.detection.Footprint(footprint.getSpans(), footprint.getBBox())
+        self.assertEqual(lsst.meas.base.getFootprintBytes(plain), 12*len(plain.getSpans()))
+        heavy = lsst.afw.detection.makeHeavyFootprint(plain, exposure.maskedImage)
+        area = plain.getArea()
+        self.assertEqual(lsst.meas.base.getFootprintBytes(heavy),
+                         12*len(plain.getSpans()) + area*(4 + exposure.mask.array.itemsize + 4))
+        self.assertEqual(lsst.meas.base.getFootprintBytes(None), 0)
+
+    def testSincCoeffsBytes(self):
+        """Test that cached aperture coefficients are counted.
+        """
+        before = lsst.meas.base.getSincCoeffsBytes()
+        radius = 7.25
+        lsst.meas.base.SincCoeffsF.cache(0.0, radius)
+        coeffs = lsst.meas.base.SincCoeffsF.get(lsst.afw.geom.ellipses.Axes(radius, radius), 0.0)
+        self.assertGreaterEqual(lsst.meas.base.getSincCoeffsBytes(), before)
+        self.assertGreaterEqual(lsst.meas.base.getSincCoeffsBytes(), coeffs.array.nbytes)
+
+    def testMeasurement(self):
+        """Test that memory usage is recorded in the task metadata only when
+        requested.
+        """
+        task = self.makeSingleFrameMeasurementTask("base_PsfFlux")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        self.assertNotIn("memory", task.metadata)
+
+        config = self.makeSingleFrameMeasurementConfig("base_PsfFlux")
+        config.doRecordMemory = True
+        task = self.makeSingleFrameMeasurementTask(config=config)
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        task.run(catalog, exposure)
+        footprints = task.getFootprintsFromCatalog(catalog)
+        self.assertEqual(task.metadata["memory.footprints.footprintsBytes"],
+                         lsst.meas.base.getFootprintDictBytes(footprints))
+        self.assertGreater(task.metadata["memory.noiseReplacer.heaviesBytes"], 0)
+        self.assertGreater(task.metadata["memory.noiseReplacer.noiseBytes"], 0)
+        self.assertGreaterEqual(task.metadata["memory.plugins.sincCoeffsBytes"], 0)
+        for stage in ("footprints", "noiseReplacer", "plugins"):
+            self.assertGreater(task.metadata[f"memory.{stage}.maxResidentBytes"], 0)
+        self.assertGreaterEqual(task.metadata["memory.plugins.maxResidentBytes"],
+                                task.metadata["memory.footprints.maxResidentBytes"])
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,141 @@
+# This file is part of meas_base.
+#
+# Developed for the LSST Data Management System.
+# This product includes software developed by the LSST Project
+# (https://www.lsst.org).
+# See the COPYRIGHT file at the top-level directory of this distribution
+# for details of code ownership.
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+
+import json
+import os
+import tempfile
+import unittest
+
+import lsst.geom
+import lsst.utils.tests
+
+import lsst.meas.base
+from lsst.meas.base.tests import AlgorithmTestCase
+
+
+class TracingTestCase(AlgorithmTestCase, lsst.utils.tests.TestCase):
+
+    def setUp(self):
+        self.bbox = lsst.geom.Box2I(lsst.geom.Point2I(0, 0), lsst.geom.Extent2I(100, 120))
+        self.dataset = lsst.meas.base.tests.TestDataset(self.bbox)
+        self.dataset.addSource(100000.0, lsst.geom.Point2D(20.2, 30.7))
+        with self.dataset.addBlend() as family:
+            family.addChild(120000.0, lsst.geom.Point2D(60.3, 72.1))
+            family.addChild(80000.0, lsst.geom.Point2D(65.6, 69.4))
+
+    def tearDown(self):
+        lsst.meas.base.disableTracing()
+        del self.bbox
+        del self.dataset
+
+    def testDisabled(self):
+        """Test that nothing is recorded unless tracing is enabled.
+        """
+        self.assertFalse(lsst.meas.base.isTracing())
+        first = lsst.meas.base.traceSpan("a")
+        self.assertIs(lsst.meas.base.traceSpan("b", "other", x=1), first)
+        with first:
+            pass
+
+    def testLazyArgs(self):
+        """Test that callable arguments are only called while tracing.
+        """
+        calls = []
+
+        def count():
+            calls.append(None)
+            return len(calls)
+
+        with lsst.meas.base.traceSpan("a", n=count):
+            pass
+        self.assertEqual(calls, [])
+        recorder = lsst.meas.base.enableTracing()
+        with lsst.meas.base.traceSpan("a", n=count, m=2):
+            pass
+        event, = recorder.toDict()["traceEvents"]
+        self.assertEqual(event["args"], {"n": 1, "m": 2})
+
+    def testMaxEvents(self):
+        """Test that events beyond the cap are counted but not kept.
+        """
+        recorder = lsst.meas.base.enableTracing(maxEvents=3)
+        for i in range(5):
+            with lsst.meas.base.traceSpan("a", i=i):
+                pass
+        self.assertEqual(len(recorder), 3)
+        self.assertEqual(recorder.nDropped, 2)
+        trace = recorder.toDict()
+        self.assertEqual([event["args"]["i"] for event in trace["traceEvents"]], [0, 1, 2])
+        self.assertEqual(trace["otherData"], {"droppedEvents": 2})
+
+    def testMeasurement(self):
+        """Test that a single-frame measurement run records plugin, family,
+        and noise replacement events, and that the trace file is valid JSON.
+        """
+        task = self.makeSingleFrameMeasurementTask("base_PsfFlux")
+        exposure, catalog = self.dataset.realize(10.0, task.schema, randomSeed=0)
+        with tempfile.TemporaryDirectory() as tempdir:
+            path = os.path.join(tempdir, "trace.json")
+            lsst.meas.base.enableTracing(path)
+            self.assertTrue(lsst.meas.base.isTracing())
+            task.run(catalog, exposure)
+            recorder = lsst.meas.base.disableTracing()
+            self.assertFalse(lsst.meas.base.isTracing())
+            with open(path) as stream:
+                trace = json.load(stream)
+        events = trace["traceEvents"]
+        self.assertEqual(len(events), len(recorder))
+        names = {event["name"] for event in events}
+        self.assertIn("SingleFrameMeasurementTask.run", names)
+        self.assertIn("NoiseReplacer setup", names)
+        self.assertIn("families", names)
+        self.assertIn("base_PsfFlux", names)
+        for event in events:
+            self.assertEqual(event["ph"], "X")
+            self.assertGreaterEqual(event["dur"], 0.0)
+        # One family span per top-level source, one plugin span per record.
+        families = [event for event in events if event["name"] == "family"]
+        self.assertEqual(len(families), len(catalog.getChildren(0)))
+        self.assertEqual({event["args"]["parent"] for event in families},
+                         {record.getId() for record in catalog.getChildren(0)})
+        self.assertEqual(sum(event["name"] == "base_PsfFlux" for event in events), len(catalog))
+        # Every span after noise replacer setup lies within the span of the
+        # whole run.
+        run, = [event for event in events if event["name"] == "SingleFrameMeasurementTask.run"]
+        for event in events:
+            if event["name"] == "NoiseReplacer setup":
+                continue
+            self.assertGreaterEqual(event["ts"], run["ts"])
+            self.assertLessEqual(event["ts"] + event["dur"], run["ts"] + run["dur"] + 1E-3)
+
+
+class TestMemory(lsst.utils.tests.MemoryTestCase):
+    pass
+
+
+def setup_module(module):
+    lsst.utils.tests.init()
+
+
+if __name__ == "__main__":
+    lsst.utils.tests.init()
+    unittest.main()
@@ -0,0 +1,45 @@
+/*
+ * This file is part of meas_base.
+ *
+ * Developed for the LSST Data Management System.
+ * This product includes software developed by the LSST Project
+ * (https://www.lsst.org).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <pybind11/pybind11.h>
+
+#include "ThrowingPsf.h"
+
+namespace py = pybind11;
+using namespace pybind11::literals;
+
+namespace test {
+namespace foo {
+namespace bar {
+
+PYBIND11_MODULE(_throwingPsf, mod) {
+    py::module::import("lsst.afw.detection");
+
+    py::class_<ThrowingPsf, std::shared_ptr<ThrowingPsf>, lsst::afw::detection::Psf>(mod, "ThrowingPsf")
+            .def(py::init<std::shared_ptr<lsst::afw::detection::Psf const>, lsst::geom::Box2D const&>(),
+                 "psf"_a, "badRegion"_a);
+}
+
+}  // namespace bar
+}  // namespace foo
+}  // namespace test